@@ -7,14 +7,15 @@
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <string_view>
 
 namespace magl {
 namespace {
 
 std::optional<executer::Expression> expression;
+std::optional<executer::Expression> closure_expression;
 
-void Setup(const ::benchmark::State & /*state*/) {
-  expression.emplace(parser::Parse(R"EOF(
+constexpr std::string_view kCode = R"EOF(
     {"result": Map(
         lambda x: {
                 "value1": VarMapAt(x, "v1"),
@@ -33,7 +34,13 @@ void Setup(const ::benchmark::State & /*state*/) {
             {"v1": "abacaba", "v2": "abacaba", "v3": "abacaba", "v4": "abacaba"}
         ]
     )}
-    )EOF"));
+    )EOF";
+
+void Setup(const ::benchmark::State & /*state*/) {
+  expression.emplace(parser::Parse(kCode));
+  closure_expression.emplace(
+      parser::Parse(kCode),
+      executer::ExpressionOptions{.backend = executer::Backend::kClosure});
 }
 
 void Teardown(const ::benchmark::State & /*state*/) {}
@@ -50,5 +57,20 @@ void BenchmarkMaglMap(::benchmark::State &state) {
 
 BENCHMARK(BenchmarkMaglMap)->Setup(Setup)->Teardown(Teardown)->MinWarmUpTime(1);
 
+void BenchmarkMaglMapClosure(::benchmark::State &state) {
+  executer::Expression *ex = &*closure_expression;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = ex->Evaluate({});
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkMaglMapClosure)
+    ->Setup(Setup)
+    ->Teardown(Teardown)
+    ->MinWarmUpTime(1);
+
 } // namespace
 } // namespace magl
@@ -7,16 +7,26 @@
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <string_view>
 
 namespace magl::benchmark1 {
 namespace {
 
 std::optional<executer::Expression> expression;
+std::optional<executer::Expression> closure_expression;
+std::optional<executer::Expression> tiered_expression;
+
+constexpr std::string_view kCode =
+    "(((1 + 2) + (3 + 4)) + ((5 + 6) + (7 + 8))) "
+    "+ (((9 + 10) + (11 + 12)) + ((13 + 14) + (15 + 16)))";
 
 void Setup(const ::benchmark::State & /*state*/) {
-  expression.emplace(
-      parser::Parse("(((1 + 2) + (3 + 4)) + ((5 + 6) + (7 + 8))) "
-                    "+ (((9 + 10) + (11 + 12)) + ((13 + 14) + (15 + 16)))"));
+  expression.emplace(parser::Parse(kCode));
+  closure_expression.emplace(
+      parser::Parse(kCode),
+      executer::ExpressionOptions{.backend = executer::Backend::kClosure});
+  tiered_expression.emplace(parser::Parse(kCode),
+                            executer::ExpressionOptions{.tier_up_after = 1000});
 }
 
 void Teardown(const ::benchmark::State & /*state*/) {}
@@ -36,6 +46,36 @@ BENCHMARK(BenchmarkMaglArithmetics)
     ->Teardown(Teardown)
     ->MinWarmUpTime(1);
 
+void BenchmarkMaglArithmeticsClosure(::benchmark::State &state) {
+  executer::Expression *ex = &*closure_expression;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = ex->Evaluate({});
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkMaglArithmeticsClosure)
+    ->Setup(Setup)
+    ->Teardown(Teardown)
+    ->MinWarmUpTime(1);
+
+void BenchmarkMaglArithmeticsTiered(::benchmark::State &state) {
+  executer::Expression *ex = &*tiered_expression;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = ex->Evaluate({});
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkMaglArithmeticsTiered)
+    ->Setup(Setup)
+    ->Teardown(Teardown)
+    ->MinWarmUpTime(1);
+
 } // namespace
 } // namespace magl::benchmark1
 
@@ -43,13 +83,19 @@ namespace magl::benchmark2 {
 namespace {
 
 std::optional<executer::Expression> expression;
+std::optional<executer::Expression> closure_expression;
+
+constexpr std::string_view kCode =
+    "(((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne())) + "
+    "((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne()))) "
+    "+ (((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne())) + "
+    "((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne())))";
 
 void Setup(const ::benchmark::State & /*state*/) {
-  expression.emplace(parser::Parse(
-      "(((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne())) + "
-      "((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne()))) "
-      "+ (((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne())) + "
-      "((GetAnyOne() + GetAnyOne()) + (GetAnyOne() + GetAnyOne())))"));
+  expression.emplace(parser::Parse(kCode));
+  closure_expression.emplace(
+      parser::Parse(kCode),
+      executer::ExpressionOptions{.backend = executer::Backend::kClosure});
 }
 
 void Teardown(const ::benchmark::State & /*state*/) {}
@@ -69,5 +115,20 @@ BENCHMARK(BenchmarkMaglArithmeticsNoInference)
     ->Teardown(Teardown)
     ->MinWarmUpTime(1);
 
+void BenchmarkMaglArithmeticsNoInferenceClosure(::benchmark::State &state) {
+  executer::Expression *ex = &*closure_expression;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = ex->Evaluate({});
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkMaglArithmeticsNoInferenceClosure)
+    ->Setup(Setup)
+    ->Teardown(Teardown)
+    ->MinWarmUpTime(1);
+
 } // namespace
 } // namespace magl::benchmark2
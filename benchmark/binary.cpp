@@ -0,0 +1,173 @@
+#include <benchmark/benchmark.h>
+
+// MAGL
+#include <binary/encoder.hpp>
+#include <binary/mapped.hpp>
+#include <binary/view.hpp>
+#include <executer/expression.hpp>
+#include <json/reader.hpp>
+#include <json/writer.hpp>
+
+#include <cstdio>
+#include <format>
+#include <string>
+
+namespace magl::benchmark3 {
+namespace {
+
+value::Value MakeValue() {
+  std::string result = "[";
+  for (size_t i = 0; i < 1000; ++i) {
+    if (i > 0) {
+      result += ",";
+    }
+    result += std::format(
+        R"({{"id": {}, "name": "user {}", "score": {}.5, )"
+        R"("history": [{}, {}, {}, {}, {}, {}, {}, {}]}})",
+        i, i, i, i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7);
+  }
+  result += "]";
+  return json::Parse(result);
+}
+
+void BenchmarkBinaryEncode(::benchmark::State &state) {
+  const value::Value v = MakeValue();
+  std::string buffer;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      buffer.clear();
+      binary::Encode(v, &buffer);
+      ::benchmark::DoNotOptimize(buffer);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkBinaryEncode)->MinWarmUpTime(1);
+
+void BenchmarkJsonSerializeForComparison(::benchmark::State &state) {
+  const value::Value v = MakeValue();
+  std::string buffer;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      buffer.clear();
+      json::Writer{&buffer}.Write(v);
+      ::benchmark::DoNotOptimize(buffer);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkJsonSerializeForComparison)->MinWarmUpTime(1);
+
+void BenchmarkBinaryDecode(::benchmark::State &state) {
+  const std::string encoded = binary::Encode(MakeValue());
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = binary::Decode(encoded);
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+BENCHMARK(BenchmarkBinaryDecode)->MinWarmUpTime(1);
+
+void BenchmarkJsonParseForComparison(::benchmark::State &state) {
+  const std::string document = json::Serialize(MakeValue());
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = json::Parse(document);
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BenchmarkJsonParseForComparison)->MinWarmUpTime(1);
+
+// Reads one field of each item without decoding the rest
+void BenchmarkBinaryView(::benchmark::State &state) {
+  const std::string encoded = binary::Encode(MakeValue());
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      int64_t sum = 0;
+      for (const binary::ValueView item : binary::View(encoded).GetArray()) {
+        sum += item.GetObject().Find("id")->GetInteger();
+      }
+      ::benchmark::DoNotOptimize(sum);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkBinaryView)->MinWarmUpTime(1);
+
+// Reference table of 100k products looked up by an expression
+constexpr size_t kProducts = 100000;
+constexpr std::string_view kLookup =
+    R"(VarMapAt(VarMapAt(products, sku), "price") * 2)";
+
+value::Value MakeProducts() {
+  value::ObjectValue result;
+  for (size_t i = 0; i < kProducts; ++i) {
+    result.emplace(std::format("sku-{}", i),
+                   value::ObjectValue{
+                       {"price", value::IntegerValue(i)},
+                       {"name", value::StringValue{std::format("p{}", i)}},
+                   });
+  }
+  return result;
+}
+
+const parser::terms::InputSchema kProductsInputs = {
+    {.name = "products",
+     .type = functions::DictType{functions::SchemaType{{
+         {"price", functions::IntegerType{}},
+         {"name", functions::StringType{}},
+     }}}},
+    {.name = "sku", .type = functions::StringType{}},
+};
+
+void BenchmarkHeapTableLookup(::benchmark::State &state) {
+  const value::Value products = MakeProducts();
+  executer::Expression expression{kLookup, {.inputs = kProductsInputs}};
+  engine::RunStandalone([&] {
+    size_t i = 0;
+    for (auto _ : state) {
+      const value::Value sku =
+          value::StringValue{std::format("sku-{}", i++ % kProducts)};
+      const value::Value *inputs[] = {&products, &sku};
+      auto result = expression.Evaluate({.inputs = inputs});
+      ::benchmark::DoNotOptimize(result);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkHeapTableLookup)->MinWarmUpTime(1);
+
+void BenchmarkMappedTableLookup(::benchmark::State &state) {
+  const std::string path = "benchmark-mapped-products";
+  binary::EncodeToFile(MakeProducts(), path);
+  const binary::MappedValue products{path};
+  executer::Expression expression{
+      kLookup,
+      {
+          .inputs = kProductsInputs,
+          .mapped_inputs = {{.name = "products",
+                             .object = products.View().GetObject()}},
+      }};
+  engine::RunStandalone([&] {
+    size_t i = 0;
+    for (auto _ : state) {
+      const value::Value sku =
+          value::StringValue{std::format("sku-{}", i++ % kProducts)};
+      const value::Value *inputs[] = {nullptr, &sku};
+      auto result = expression.Evaluate({.inputs = inputs});
+      ::benchmark::DoNotOptimize(result);
+    }
+  });
+  std::remove(path.c_str());
+}
+
+BENCHMARK(BenchmarkMappedTableLookup)->MinWarmUpTime(1);
+
+} // namespace
+} // namespace magl::benchmark3
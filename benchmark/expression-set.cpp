@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+// MAGL
+#include <executer/expression.hpp>
+
+#include <format>
+#include <string>
+#include <vector>
+
+namespace magl::benchmark3 {
+namespace {
+
+const parser::terms::InputSchema kInputs = {
+    {.name = "doc",
+     .type = functions::SchemaType{{
+         {"age", functions::IntegerType{}},
+         {"tier", functions::IntegerType{}},
+         {"events", functions::ListType{functions::IntegerType{}}},
+     }}},
+};
+
+// 200 rules that normalize the same events and score the same user
+std::vector<std::string> MakeRules() {
+  std::vector<std::string> result;
+  for (size_t i = 0; i < 200; ++i) {
+    if (i % 2 == 0) {
+      result.push_back(std::format(
+          "Map(lambda x: x * {}, Map(lambda e: e * 3 + 1, "
+          "VarMapAt(doc, \"events\")))",
+          i));
+    } else {
+      result.push_back(std::format(
+          "(VarMapAt(doc, \"age\") * VarMapAt(doc, \"tier\") + 7) * {}", i));
+    }
+  }
+  return result;
+}
+
+value::Value MakeDocument() {
+  value::ArrayValue events;
+  for (int64_t i = 0; i < 100; ++i) {
+    events.push_back(value::IntegerValue{i});
+  }
+  return value::ObjectValue{
+      {"age", value::IntegerValue{30}},
+      {"tier", value::IntegerValue{2}},
+      {"events", std::move(events)},
+  };
+}
+
+void BenchmarkSeparateExpressions(::benchmark::State &state) {
+  std::vector<executer::Expression> expressions;
+  for (const std::string &rule : MakeRules()) {
+    expressions.emplace_back(std::string_view{rule},
+                             executer::ExpressionOptions{.inputs = kInputs});
+  }
+  const value::Value document = MakeDocument();
+  const value::Value *inputs[] = {&document};
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      for (executer::Expression &expression : expressions) {
+        auto value = expression.Evaluate({.inputs = inputs});
+        ::benchmark::DoNotOptimize(value);
+      }
+    }
+  });
+}
+
+BENCHMARK(BenchmarkSeparateExpressions)->MinWarmUpTime(1);
+
+void BenchmarkExpressionSet(::benchmark::State &state) {
+  const std::vector<std::string> rules = MakeRules();
+  const std::vector<std::string_view> sources(rules.begin(), rules.end());
+  executer::ExpressionSet set{sources,
+                              executer::ExpressionOptions{.inputs = kInputs}};
+  const value::Value document = MakeDocument();
+  const value::Value *inputs[] = {&document};
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto values = set.Evaluate({.inputs = inputs});
+      ::benchmark::DoNotOptimize(values);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkExpressionSet)->MinWarmUpTime(1);
+
+} // namespace
+} // namespace magl::benchmark3
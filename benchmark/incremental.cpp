@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+
+// MAGL
+#include <executer/expression.hpp>
+
+#include <string_view>
+
+namespace magl::benchmark3 {
+namespace {
+
+const parser::terms::InputSchema kInputs = {
+    {.name = "doc",
+     .type = functions::SchemaType{{
+         {"scale", functions::IntegerType{}},
+         {"items", functions::ListType{functions::IntegerType{}}},
+     }}},
+};
+
+// The inner Map reads only "items", the outer one reads "scale" too
+constexpr std::string_view kSource = R"EOF(
+    Map(lambda x: x * VarMapAt(doc, "scale") + 1,
+        Map(lambda y: y * 3 + 7, VarMapAt(doc, "items")))
+)EOF";
+
+value::Value MakeDocument(int64_t scale) {
+  value::ArrayValue items;
+  for (int64_t i = 0; i < 10000; ++i) {
+    items.push_back(value::IntegerValue{i});
+  }
+  return value::ObjectValue{
+      {"scale", value::IntegerValue{scale}},
+      {"items", std::move(items)},
+  };
+}
+
+void BenchmarkFullEvaluation(::benchmark::State &state) {
+  executer::Expression expression{kSource,
+                                  executer::ExpressionOptions{.inputs = kInputs}};
+  const value::Value documents[] = {MakeDocument(1), MakeDocument(2)};
+  size_t i = 0;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      const value::Value *inputs[] = {&documents[i++ % 2]};
+      auto value = expression.Evaluate({.inputs = inputs});
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkFullEvaluation)->MinWarmUpTime(1);
+
+void BenchmarkIncrementalEvaluation(::benchmark::State &state) {
+  executer::Expression expression{
+      kSource,
+      executer::ExpressionOptions{.inputs = kInputs, .incremental = true}};
+  const value::Value documents[] = {MakeDocument(1), MakeDocument(2)};
+  const executer::InputPath scale{.input = 0, .path = {"scale"}};
+  size_t i = 0;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      const value::Value *inputs[] = {&documents[i++ % 2]};
+      // Only "scale" differs between the documents
+      auto value = expression.Evaluate({.inputs = inputs}, {{scale}});
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkIncrementalEvaluation)->MinWarmUpTime(1);
+
+} // namespace
+} // namespace magl::benchmark3
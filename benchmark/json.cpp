@@ -0,0 +1,198 @@
+#include <benchmark/benchmark.h>
+
+// MAGL
+#include <executer/expression.hpp>
+#include <json/reader.hpp>
+#include <json/writer.hpp>
+#include <parser/parser.hpp>
+
+#include <format>
+#include <string>
+
+namespace magl::benchmark3 {
+namespace {
+
+std::string MakeDocument() {
+  std::string result = "[";
+  for (size_t i = 0; i < 1000; ++i) {
+    if (i > 0) {
+      result += ",";
+    }
+    result += std::format(
+        R"({{"id": {}, "name": "user \"{}\"", "score": {}.5, "active": true, )"
+        R"("tags": ["a", "b", "c"], "address": {{"city": "Moscow", "zip": {}}}}})",
+        i, i, i, 100000 + i);
+  }
+  result += "]";
+  return result;
+}
+
+const functions::Type kType = functions::ListType{functions::SchemaType{{
+    {"id", functions::IntegerType{}},
+    {"score", functions::DoubleType{}},
+    {"name", functions::StringType{}},
+}}};
+
+void BenchmarkJsonParse(::benchmark::State &state) {
+  const std::string document = MakeDocument();
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = json::Parse(document);
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BenchmarkJsonParse)->MinWarmUpTime(1);
+
+void BenchmarkJsonParseTyped(::benchmark::State &state) {
+  const std::string document = MakeDocument();
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = json::Parse(document, kType);
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BenchmarkJsonParseTyped)->MinWarmUpTime(1);
+
+void BenchmarkJsonStructurals(::benchmark::State &state) {
+  const std::string document = MakeDocument();
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto structurals = json::FindStructurals(document);
+      ::benchmark::DoNotOptimize(structurals);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BenchmarkJsonStructurals)->MinWarmUpTime(1);
+
+// About 20 KB, a rule reads 6 fields of it
+std::string MakeRecord() {
+  std::string result = R"({"user": {"id": 42, "name": "magl", "age": 30, )"
+                       R"("country": "RU", "tier": 2}, "events": [)";
+  for (size_t i = 0; i < 200; ++i) {
+    if (i > 0) {
+      result += ",";
+    }
+    result += std::format(
+        R"({{"ts": {}, "kind": "click", "target": "button-{}", "x": {}.25}})",
+        1700000000 + i, i, i);
+  }
+  result += R"(], "limits": {"daily": 1000, "monthly": 20000}, "score": 0.5})";
+  return result;
+}
+
+const functions::Type kRecordType = functions::SchemaType{{
+    {"user", functions::SchemaType{{
+                 {"id", functions::IntegerType{}},
+                 {"name", functions::StringType{}},
+                 {"age", functions::IntegerType{}},
+                 {"country", functions::StringType{}},
+                 {"tier", functions::IntegerType{}},
+             }}},
+    {"events", functions::ListType{functions::AnyType{}}},
+    {"limits", functions::DictType{functions::IntegerType{}}},
+    {"score", functions::DoubleType{}},
+}};
+
+constexpr std::string_view kRule = R"EOF(
+    let user = VarMapAt(record, "user") in
+    let limits = VarMapAt(record, "limits") in
+    VarMapAt(user, "age") * VarMapAt(user, "tier") + VarMapAt(user, "id") +
+    VarMapAt(limits, "daily") + VarMapAt(limits, "monthly")
+)EOF";
+
+void BenchmarkJsonParseRecord(::benchmark::State &state) {
+  const std::string document = MakeRecord();
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = json::Parse(document, kRecordType);
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BenchmarkJsonParseRecord)->MinWarmUpTime(1);
+
+void BenchmarkJsonParseRecordProjected(::benchmark::State &state) {
+  const std::string document = MakeRecord();
+  const executer::Expression rule{
+      kRule, executer::ExpressionOptions{
+                 .inputs = {{.name = "record", .type = kRecordType}},
+             }};
+  const json::Projection projection{rule.GetFieldPaths(0)};
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      auto value = json::Parse(document, kRecordType, projection);
+      ::benchmark::DoNotOptimize(value);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BenchmarkJsonParseRecordProjected)->MinWarmUpTime(1);
+
+void BenchmarkJsonWrite(::benchmark::State &state) {
+  const value::Value value = json::Parse(MakeDocument());
+  std::string buffer;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      buffer.clear();
+      json::Writer writer{&buffer};
+      writer.Write(value);
+      ::benchmark::DoNotOptimize(buffer);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+BENCHMARK(BenchmarkJsonWrite)->MinWarmUpTime(1);
+
+std::string MakeMapSource() {
+  std::string result = "Map(lambda x: GetVar(x) * 3 + 1, [";
+  for (size_t i = 0; i < 10000; ++i) {
+    result += std::format("{}{}", i > 0 ? ", " : "", i);
+  }
+  result += "])";
+  return result;
+}
+
+void BenchmarkEvaluateThenWrite(::benchmark::State &state) {
+  executer::Expression expression{parser::Parse(MakeMapSource())};
+  std::string buffer;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      buffer.clear();
+      json::Writer writer{&buffer};
+      writer.Write(expression.Evaluate({}));
+      ::benchmark::DoNotOptimize(buffer);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkEvaluateThenWrite)->MinWarmUpTime(1);
+
+void BenchmarkEvaluateTo(::benchmark::State &state) {
+  executer::Expression expression{parser::Parse(MakeMapSource())};
+  std::string buffer;
+  engine::RunStandalone([&] {
+    for (auto _ : state) {
+      buffer.clear();
+      json::Writer writer{&buffer};
+      expression.EvaluateTo({}, &writer);
+      ::benchmark::DoNotOptimize(buffer);
+    }
+  });
+}
+
+BENCHMARK(BenchmarkEvaluateTo)->MinWarmUpTime(1);
+
+} // namespace
+} // namespace magl::benchmark3
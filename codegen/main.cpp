@@ -0,0 +1,99 @@
+// Compiles a MAGL-T expression to C++ ahead of time.
+//
+// Usage: magl-codegen [-i name=type]... <input> <output.cpp> [function_name]
+//
+// Each -i declares an input of the expression in order, the type is described
+// in JSON as for magl-transform -t, e.g. -i 'record={"*": "Any"}'. Placeholders
+// of the expression follow the declared inputs.
+//
+// The generated translation unit registers itself in the registry of
+// precompiled expressions, so Expression(source) picks it up when it is
+// linked in and is built with the same declared inputs. Since nothing
+// references the generated function, link it with GLOBAL_SRCS (or
+// whole-archive) to keep the registration.
+
+#include <codegen/generator.hpp>
+
+#include <functions/utils/type-description.hpp>
+#include <json/reader.hpp>
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+void PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program
+            << " [-i name=type]... <input> <output.cpp> [function_name]"
+            << std::endl;
+}
+
+magl::parser::terms::InputVariable ParseInput(std::string_view argument) {
+  const size_t separator = argument.find('=');
+  if (separator == std::string_view::npos || separator == 0) {
+    throw std::invalid_argument("An input is described by name=type");
+  }
+  return {
+      .name = std::string{argument.substr(0, separator)},
+      .type = magl::functions::utils::ParseTypeDescription(
+          magl::json::Parse(argument.substr(separator + 1))),
+  };
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  magl::codegen::GeneratorOptions options;
+
+  int i = 1;
+  try {
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+      const std::string_view flag = argv[i];
+      if (flag == "-i") {
+        options.inputs.push_back(ParseInput(argv[i + 1]));
+      } else {
+        throw std::invalid_argument("Unknown flag " + std::string(flag));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    PrintUsage(argv[0]);
+    return 2;
+  }
+  if (argc - i < 2 || argc - i > 3) {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+
+  std::ifstream input{argv[i]};
+  if (!input) {
+    std::cerr << "Can not open " << argv[i] << std::endl;
+    return 1;
+  }
+  std::stringstream source;
+  source << input.rdbuf();
+
+  if (argc - i == 3) {
+    options.function_name = argv[i + 2];
+  }
+
+  std::string code;
+  try {
+    code = magl::codegen::GenerateCpp(source.str(), options);
+  } catch (const std::exception& e) {
+    std::cerr << argv[i] << ": " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::ofstream output{argv[i + 1]};
+  output << code;
+  if (!output) {
+    std::cerr << "Can not write " << argv[i + 1] << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,189 @@
+#include <binary/encoder.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <binary/format.hpp>
+
+namespace magl::binary {
+
+namespace {
+
+using impl::Tag;
+
+void AppendTag(Tag tag, std::string* to) {
+  to->push_back(static_cast<char>(tag));
+}
+
+template <typename T>
+bool HoldsOnly(const value::ArrayValue& v) {
+  return std::all_of(v.begin(), v.end(), [](const value::Value& item) {
+    return boost::get<T>(&item) != nullptr;
+  });
+}
+
+/// Returns the narrowest size of an integer that holds all the items
+uint8_t GetPackedIntegerSize(const value::ArrayValue& v) {
+  const auto [min, max] = std::minmax_element(
+      v.begin(), v.end(), [](const value::Value& lhs, const value::Value& rhs) {
+        return boost::get<value::IntegerValue>(lhs) <
+               boost::get<value::IntegerValue>(rhs);
+      });
+  const auto fits = [&]<typename T>() {
+    return boost::get<value::IntegerValue>(*min) >=
+               std::numeric_limits<T>::min() &&
+           boost::get<value::IntegerValue>(*max) <=
+               std::numeric_limits<T>::max();
+  };
+  if (fits.operator()<int8_t>()) {
+    return 1;
+  }
+  if (fits.operator()<int16_t>()) {
+    return 2;
+  }
+  if (fits.operator()<int32_t>()) {
+    return 4;
+  }
+  return 8;
+}
+
+/// Appends the items of `v` truncated to `item_size` bytes
+template <typename T>
+void AppendPackedItems(const value::ArrayValue& v, size_t item_size,
+                       std::string* to) {
+  const size_t begin = to->size();
+  to->resize(begin + v.size() * item_size);
+  char* out = to->data() + begin;
+  for (const value::Value& item : v) {
+    // NB: The low bytes go first on a little-endian host
+    std::memcpy(out, &boost::get<T>(item), item_size);
+    out += item_size;
+  }
+}
+
+/// Writes the items of a container with `append_items` after a placeholder of
+/// the byte length, which is patched then
+template <typename F>
+void AppendContainer(Tag tag, size_t count, std::string* to,
+                     F append_items) {
+  AppendTag(tag, to);
+  const size_t size_offset = to->size();
+  to->resize(size_offset + impl::kContainerSizeBytes);
+  impl::AppendVarint(count, to);
+  append_items();
+  const size_t size = to->size() - size_offset - impl::kContainerSizeBytes;
+  if (size > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("A container is too large to be encoded.");
+  }
+  const auto size32 = static_cast<uint32_t>(size);
+  std::memcpy(to->data() + size_offset, &size32, sizeof(size32));
+}
+
+void AppendItem(std::string_view key, const value::Value& item,
+                std::string* to) {
+  impl::AppendVarint(key.size(), to);
+  to->append(key);
+  Encode(item, to);
+}
+
+/// Appends the items of an object and a hash index of their offsets
+void AppendIndexedItems(const value::ObjectValue& v, std::string* to) {
+  // At most half of the slots are taken
+  const size_t slots_count = std::bit_ceil(2 * v.size());
+  std::vector<uint32_t> slots(slots_count, impl::kEmptySlot);
+  const size_t items_begin = to->size();
+  for (const auto& [key, item] : v) {
+    const size_t offset = to->size() - items_begin;
+    if (offset >= impl::kEmptySlot) {
+      throw std::length_error("A container is too large to be encoded.");
+    }
+    size_t slot = impl::HashKey(key) & (slots_count - 1);
+    while (slots[slot] != impl::kEmptySlot) {
+      slot = (slot + 1) & (slots_count - 1);
+    }
+    slots[slot] = static_cast<uint32_t>(offset);
+    AppendItem(key, item, to);
+  }
+  if (slots_count > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("A container is too large to be encoded.");
+  }
+  const auto slots_count32 = static_cast<uint32_t>(slots_count);
+  to->append(reinterpret_cast<const char*>(slots.data()),
+             slots.size() * sizeof(uint32_t));
+  to->append(reinterpret_cast<const char*>(&slots_count32),
+             sizeof(slots_count32));
+}
+
+}  // namespace
+
+void Encode(const value::Value& v, std::string* to) {
+  boost::apply_visitor(
+      [to](const auto& alternative) {
+        using V = std::decay_t<decltype(alternative)>;
+        if constexpr (std::is_same_v<V, value::IntegerValue>) {
+          AppendTag(Tag::kInteger, to);
+          impl::AppendVarint(impl::ZigZag(alternative), to);
+        } else if constexpr (std::is_same_v<V, value::FloatValue>) {
+          AppendTag(Tag::kFloat, to);
+          to->append(reinterpret_cast<const char*>(&alternative),
+                     sizeof(alternative));
+        } else if constexpr (std::is_same_v<V, value::BoolValue>) {
+          AppendTag(alternative ? Tag::kTrue : Tag::kFalse, to);
+        } else if constexpr (std::is_same_v<V, value::StringValue>) {
+          AppendTag(Tag::kString, to);
+          impl::AppendVarint(alternative.size(), to);
+          to->append(alternative);
+        } else if constexpr (std::is_same_v<V, value::NullValue>) {
+          AppendTag(Tag::kNull, to);
+        } else if constexpr (std::is_same_v<V, value::LambdaValue>) {
+          throw std::invalid_argument("Lambdas can not be encoded.");
+        } else if constexpr (std::is_same_v<V, value::ArrayValue>) {
+          if (!alternative.empty() &&
+              HoldsOnly<value::IntegerValue>(alternative)) {
+            const uint8_t item_size = GetPackedIntegerSize(alternative);
+            AppendTag(Tag::kIntegerArray, to);
+            impl::AppendVarint(alternative.size(), to);
+            to->push_back(static_cast<char>(item_size));
+            AppendPackedItems<value::IntegerValue>(alternative, item_size, to);
+          } else if (!alternative.empty() &&
+                     HoldsOnly<value::FloatValue>(alternative)) {
+            AppendTag(Tag::kFloatArray, to);
+            impl::AppendVarint(alternative.size(), to);
+            AppendPackedItems<value::FloatValue>(
+                alternative, sizeof(value::FloatValue), to);
+          } else {
+            AppendContainer(Tag::kArray, alternative.size(), to, [&] {
+              for (const value::Value& item : alternative) {
+                Encode(item, to);
+              }
+            });
+          }
+        } else {
+          static_assert(std::is_same_v<V, value::ObjectValue>);
+          if (alternative.size() >= impl::kIndexedObjectMinSize) {
+            AppendContainer(Tag::kIndexedObject, alternative.size(), to,
+                            [&] { AppendIndexedItems(alternative, to); });
+            return;
+          }
+          AppendContainer(Tag::kObject, alternative.size(), to, [&] {
+            for (const auto& [key, item] : alternative) {
+              AppendItem(key, item, to);
+            }
+          });
+        }
+      },
+      v);
+}
+
+std::string Encode(const value::Value& v) {
+  std::string result;
+  Encode(v, &result);
+  return result;
+}
+
+}  // namespace magl::binary
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+#include <value/value.hpp>
+
+namespace magl::binary {
+
+// Compact binary encoding of values for passing them between processes and
+// spilling them to disk, see format.hpp. Lists of only integers or only floats
+// are packed, so they are written and read with a copy of their items.
+
+/// Appends the encoding of `v` to `to`. Throws std::invalid_argument for
+/// lambdas and std::length_error for containers over 4 GiB
+void Encode(const value::Value& v, std::string* to);
+
+/// Returns the encoding of `v`
+std::string Encode(const value::Value& v);
+
+}  // namespace magl::binary
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace magl::binary::impl {
+
+// A value is a tag byte followed by its payload. Numbers are little-endian,
+// lengths and counts are LEB128 varints:
+// - kNull, kFalse, kTrue: no payload,
+// - kInteger: zigzag varint,
+// - kFloat: 8 bytes,
+// - kString: varint byte length, bytes,
+// - kArray: u32 byte length of the rest, varint count, items,
+// - kObject: u32 byte length of the rest, varint count, then for each item
+//   varint key length, key bytes, value,
+// - kIndexedObject: kObject followed by a hash index of the keys: u32 offset
+//   of an item in the items (or kEmptySlot) per slot, the u32 count of slots.
+//   Slots are a power of two, collisions are probed linearly. Objects of
+//   kIndexedObjectMinSize items or more are indexed,
+// - kIntegerArray: varint count, item size (1, 2, 4 or 8), the items
+//   truncated to the narrowest size that holds all of them,
+// - kFloatArray: varint count, 8 bytes per item.
+// Lists whose items are all integers or all floats are packed, so an item is
+// found by its index.
+// Containers start with their byte length so that a view skips them without
+// reading their items.
+enum class Tag : uint8_t {
+  kNull = 0,
+  kFalse = 1,
+  kTrue = 2,
+  kInteger = 3,
+  kFloat = 4,
+  kString = 5,
+  kArray = 6,
+  kObject = 7,
+  kIntegerArray = 8,
+  kFloatArray = 9,
+  kIndexedObject = 10,
+};
+
+static_assert(std::endian::native == std::endian::little,
+              "Packed arrays are copied as is, a big-endian host would have to "
+              "swap the bytes");
+
+constexpr size_t kMaxVarintSize = 10;
+constexpr size_t kContainerSizeBytes = 4;
+constexpr size_t kIndexedObjectMinSize = 16;
+constexpr uint32_t kEmptySlot = 0xFFFFFFFF;
+
+/// FNV-1a, which unlike std::hash is the same in every process that reads the
+/// index
+inline uint64_t HashKey(std::string_view key) {
+  uint64_t result = 0xcbf29ce484222325;
+  for (const char c : key) {
+    result = (result ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+  }
+  return result;
+}
+
+inline uint64_t ZigZag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t UnZigZag(uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline void AppendVarint(uint64_t v, std::string* to) {
+  while (v >= 0x80) {
+    to->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  to->push_back(static_cast<char>(v));
+}
+
+}  // namespace magl::binary::impl
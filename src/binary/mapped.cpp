@@ -0,0 +1,75 @@
+#include <binary/mapped.hpp>
+
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <binary/encoder.hpp>
+
+namespace magl::binary {
+
+namespace {
+
+[[noreturn]] void ThrowSystemError(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace
+
+MappedValue::MappedValue(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    ThrowSystemError("Can not open " + path);
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    const int error = errno;
+    close(fd);
+    errno = error;
+    ThrowSystemError("Can not stat " + path);
+  }
+  const size_t size = static_cast<size_t>(status.st_size);
+  if (size == 0) {
+    close(fd);
+    throw DecodingError("Malformed binary value: " + path + " is empty");
+  }
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  const int error = errno;
+  // NB: The mapping stays valid after the descriptor is closed
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    errno = error;
+    ThrowSystemError("Can not map " + path);
+  }
+  // Lookups in a table jump around the file
+  madvise(mapped, size, MADV_RANDOM);
+  data_ = {static_cast<const char*>(mapped), size};
+  try {
+    root_ = binary::View(data_);
+  } catch (...) {
+    munmap(mapped, size);
+    throw;
+  }
+}
+
+MappedValue::~MappedValue() {
+  munmap(const_cast<char*>(data_.data()), data_.size());
+}
+
+void EncodeToFile(const value::Value& v, const std::string& path) {
+  const std::string encoded = Encode(v);
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  file.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+  file.close();
+  if (!file) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Can not write " + path);
+  }
+}
+
+}  // namespace magl::binary
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <binary/view.hpp>
+
+namespace magl::binary {
+
+/// Read-only value encoded in a file (see encoder.hpp) that is mapped into
+/// memory instead of being read. Pages are loaded as the value is visited and
+/// are shared by the processes that map the same file, so a large reference
+/// table costs neither startup time nor private memory in each of them.
+/// Views of the value must not outlive it
+class MappedValue {
+ public:
+  /// Throws std::system_error if the file can not be mapped and
+  /// DecodingError if it does not hold a value
+  explicit MappedValue(const std::string& path);
+
+  MappedValue(const MappedValue&) = delete;
+  MappedValue& operator=(const MappedValue&) = delete;
+
+  ~MappedValue();
+
+  const ValueView& View() const { return root_; }
+  std::string_view GetData() const { return data_; }
+
+ private:
+  std::string_view data_;
+  ValueView root_;
+};
+
+/// Writes the encoding of `v` to the file at `path` for MappedValue. Throws
+/// std::system_error if writing fails
+void EncodeToFile(const value::Value& v, const std::string& path);
+
+}  // namespace magl::binary
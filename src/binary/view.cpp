@@ -0,0 +1,429 @@
+#include <binary/view.hpp>
+
+#include <bit>
+#include <cstring>
+#include <format>
+#include <type_traits>
+
+namespace magl::binary {
+
+namespace {
+
+// Deeper values are rejected instead of overflowing the stack
+constexpr size_t kMaxDepth = 1024;
+
+/// Reads a packed integer of `size` bytes
+value::IntegerValue ReadPackedInteger(const char* data, size_t size) {
+  switch (size) {
+    case 1:
+      return static_cast<int8_t>(*data);
+    case 2: {
+      int16_t result;
+      std::memcpy(&result, data, sizeof(result));
+      return result;
+    }
+    case 4: {
+      int32_t result;
+      std::memcpy(&result, data, sizeof(result));
+      return result;
+    }
+    default: {
+      int64_t result;
+      std::memcpy(&result, data, sizeof(result));
+      return result;
+    }
+  }
+}
+
+template <typename T>
+void AppendPacked(std::string_view data, size_t size,
+                  value::ArrayValue* to) {
+  for (size_t i = 0; i < size; ++i) {
+    T item;
+    std::memcpy(&item, data.data() + i * sizeof(T), sizeof(T));
+    if constexpr (std::is_floating_point_v<T>) {
+      to->emplace_back(value::FloatValue{item});
+    } else {
+      to->emplace_back(value::IntegerValue{item});
+    }
+  }
+}
+
+}  // namespace
+
+namespace impl {
+
+/// Reads encoded values from a buffer
+class Cursor {
+ public:
+  explicit Cursor(std::string_view data, size_t offset = 0)
+      : data_(data), offset_(offset) {
+    if (offset_ > data_.size()) {
+      Fail("an offset is out of the buffer");
+    }
+  }
+
+  size_t GetOffset() const { return offset_; }
+  bool AtEnd() const { return offset_ == data_.size(); }
+
+  ValueView ReadValue() {
+    ValueView result;
+    const auto tag = static_cast<Tag>(ReadByte());
+    switch (tag) {
+      case Tag::kNull:
+        result.kind_ = ValueView::Kind::kNull;
+        break;
+      case Tag::kFalse:
+      case Tag::kTrue:
+        result.kind_ = ValueView::Kind::kBool;
+        result.integer_ = tag == Tag::kTrue;
+        break;
+      case Tag::kInteger:
+        result.kind_ = ValueView::Kind::kInteger;
+        result.integer_ = UnZigZag(ReadVarint());
+        break;
+      case Tag::kFloat:
+        result.kind_ = ValueView::Kind::kFloat;
+        std::memcpy(&result.float_, ReadBytes(sizeof(result.float_)).data(),
+                    sizeof(result.float_));
+        break;
+      case Tag::kString:
+        result.kind_ = ValueView::Kind::kString;
+        result.data_ = ReadBytes(ReadVarint());
+        break;
+      case Tag::kArray:
+      case Tag::kObject:
+      case Tag::kIndexedObject: {
+        uint32_t size;
+        std::memcpy(&size, ReadBytes(sizeof(size)).data(), sizeof(size));
+        Cursor items{ReadBytes(size)};
+        result.kind_ = tag == Tag::kArray ? ValueView::Kind::kArray
+                                          : ValueView::Kind::kObject;
+        result.tag_ = tag;
+        result.size_ = items.ReadVarint();
+        result.data_ = items.data_.substr(items.offset_);
+        if (tag == Tag::kIndexedObject) {
+          SplitIndex(&result);
+        }
+        // An item takes at least one byte, a key and a value at least two
+        if (result.size_ > result.data_.size()) {
+          Fail("the count of items does not fit in the container");
+        }
+        break;
+      }
+      case Tag::kIntegerArray:
+      case Tag::kFloatArray: {
+        result.kind_ = ValueView::Kind::kArray;
+        result.tag_ = tag;
+        result.size_ = ReadVarint();
+        result.item_size_ = tag == Tag::kIntegerArray
+                                ? ReadByte()
+                                : sizeof(value::FloatValue);
+        if (result.item_size_ != 1 && result.item_size_ != 2 &&
+            result.item_size_ != 4 && result.item_size_ != 8) {
+          Fail(std::format("invalid size of packed items {}",
+                           result.item_size_));
+        }
+        if (result.size_ > (data_.size() - offset_) / result.item_size_) {
+          Fail("the packed items do not fit in the buffer");
+        }
+        result.data_ = ReadBytes(result.size_ * result.item_size_);
+        break;
+      }
+      default:
+        Fail(std::format("unknown tag {}", static_cast<int>(tag)));
+    }
+    return result;
+  }
+
+  /// Reads an item of an array with the tag `array_tag`
+  ValueView ReadItem(Tag array_tag, size_t item_size) {
+    if (array_tag == Tag::kArray) {
+      return ReadValue();
+    }
+    ValueView result;
+    const std::string_view bytes = ReadBytes(item_size);
+    if (array_tag == Tag::kIntegerArray) {
+      result.kind_ = ValueView::Kind::kInteger;
+      result.integer_ = ReadPackedInteger(bytes.data(), item_size);
+    } else {
+      result.kind_ = ValueView::Kind::kFloat;
+      std::memcpy(&result.float_, bytes.data(), sizeof(result.float_));
+    }
+    return result;
+  }
+
+  std::string_view ReadKey() { return ReadBytes(ReadVarint()); }
+
+  static value::Value Materialize(const ValueView& v, size_t depth) {
+    if (depth > kMaxDepth) {
+      throw DecodingError("Malformed binary value: too deep");
+    }
+    switch (v.kind_) {
+      case ValueView::Kind::kNull:
+        return value::NullValue{};
+      case ValueView::Kind::kBool:
+        return value::BoolValue{v.integer_ != 0};
+      case ValueView::Kind::kInteger:
+        return v.integer_;
+      case ValueView::Kind::kFloat:
+        return v.float_;
+      case ValueView::Kind::kString:
+        return value::StringValue{v.data_};
+      case ValueView::Kind::kArray:
+        return MaterializeArray(v, depth);
+      case ValueView::Kind::kObject:
+        return MaterializeObject(v, depth);
+    }
+    __builtin_unreachable();
+  }
+
+ private:
+  /// Separates the hash index from the items of an indexed object
+  void SplitIndex(ValueView* v) const {
+    std::string_view& data = v->data_;
+    uint32_t slots_count;
+    if (data.size() < sizeof(slots_count)) {
+      Fail("an indexed object has no index");
+    }
+    std::memcpy(&slots_count, data.data() + data.size() - sizeof(slots_count),
+                sizeof(slots_count));
+    data.remove_suffix(sizeof(slots_count));
+    if (!std::has_single_bit(slots_count) ||
+        slots_count > data.size() / sizeof(uint32_t)) {
+      Fail("invalid count of slots of an index");
+    }
+    const size_t index_size = slots_count * sizeof(uint32_t);
+    v->index_ = data.substr(data.size() - index_size);
+    data.remove_suffix(index_size);
+  }
+
+  static value::Value MaterializeArray(const ValueView& v, size_t depth) {
+    value::ArrayValue result;
+    result.reserve(v.size_);
+    // NB: Packed items are copied without building a view for each of them
+    if (v.tag_ == Tag::kFloatArray) {
+      AppendPacked<value::FloatValue>(v.data_, v.size_, &result);
+      return result;
+    }
+    if (v.tag_ == Tag::kIntegerArray) {
+      switch (v.item_size_) {
+        case 1:
+          AppendPacked<int8_t>(v.data_, v.size_, &result);
+          break;
+        case 2:
+          AppendPacked<int16_t>(v.data_, v.size_, &result);
+          break;
+        case 4:
+          AppendPacked<int32_t>(v.data_, v.size_, &result);
+          break;
+        default:
+          AppendPacked<int64_t>(v.data_, v.size_, &result);
+      }
+      return result;
+    }
+    Cursor items{v.data_};
+    for (size_t i = 0; i < v.size_; ++i) {
+      result.push_back(Materialize(items.ReadValue(), depth + 1));
+    }
+    if (!items.AtEnd()) {
+      items.Fail("bytes after the last item of an array");
+    }
+    return result;
+  }
+
+  static value::Value MaterializeObject(const ValueView& v, size_t depth) {
+    value::ObjectValue result;
+    result.reserve(v.size_);
+    Cursor items{v.data_};
+    for (size_t i = 0; i < v.size_; ++i) {
+      const std::string_view key = items.ReadKey();
+      result.emplace(key, Materialize(items.ReadValue(), depth + 1));
+    }
+    if (!items.AtEnd()) {
+      items.Fail("bytes after the last item of an object");
+    }
+    return result;
+  }
+
+  uint8_t ReadByte() {
+    if (offset_ == data_.size()) {
+      Fail("unexpected end");
+    }
+    return static_cast<uint8_t>(data_[offset_++]);
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t result = 0;
+    for (size_t shift = 0; shift < 7 * kMaxVarintSize; shift += 7) {
+      const uint8_t byte = ReadByte();
+      if (shift == 7 * (kMaxVarintSize - 1) && byte > 1) {
+        Fail("a varint overflows 64 bits");
+      }
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return result;
+      }
+    }
+    Fail("a varint is too long");
+  }
+
+  std::string_view ReadBytes(uint64_t size) {
+    if (size > data_.size() - offset_) {
+      Fail("unexpected end");
+    }
+    const std::string_view result = data_.substr(offset_, size);
+    offset_ += size;
+    return result;
+  }
+
+  [[noreturn]] void Fail(std::string_view what) const {
+    throw DecodingError(std::format("Malformed binary value: {}", what));
+  }
+
+ private:
+  std::string_view data_;
+  size_t offset_ = 0;
+};
+
+}  // namespace impl
+
+namespace {
+
+void CheckKind(ValueView::Kind actual, ValueView::Kind expected,
+               std::string_view name) {
+  if (actual != expected) {
+    throw std::invalid_argument(std::format("The value is not {}.", name));
+  }
+}
+
+}  // namespace
+
+value::BoolValue ValueView::GetBool() const {
+  CheckKind(kind_, Kind::kBool, "a bool");
+  return integer_ != 0;
+}
+
+value::IntegerValue ValueView::GetInteger() const {
+  CheckKind(kind_, Kind::kInteger, "an integer");
+  return integer_;
+}
+
+value::FloatValue ValueView::GetFloat() const {
+  CheckKind(kind_, Kind::kFloat, "a float");
+  return float_;
+}
+
+std::string_view ValueView::GetString() const {
+  CheckKind(kind_, Kind::kString, "a string");
+  return data_;
+}
+
+ArrayView ValueView::GetArray() const {
+  CheckKind(kind_, Kind::kArray, "an array");
+  return ArrayView{data_, size_, tag_, item_size_};
+}
+
+ObjectView ValueView::GetObject() const {
+  CheckKind(kind_, Kind::kObject, "an object");
+  return ObjectView{data_, size_, index_};
+}
+
+value::Value ValueView::Materialize() const {
+  return impl::Cursor::Materialize(*this, 0);
+}
+
+ValueView View(std::string_view data) {
+  impl::Cursor cursor{data};
+  const ValueView result = cursor.ReadValue();
+  if (!cursor.AtEnd()) {
+    throw DecodingError("Malformed binary value: bytes after the value");
+  }
+  return result;
+}
+
+value::Value Decode(std::string_view data) { return View(data).Materialize(); }
+
+ValueView ArrayView::At(size_t index) const {
+  if (index >= size_) {
+    throw std::out_of_range(
+        std::format("Index {} is out of an array of {}", index, size_));
+  }
+  if (IsPacked()) {
+    impl::Cursor cursor{items_, index * item_size_};
+    return cursor.ReadItem(tag_, item_size_);
+  }
+  // Containers are skipped by their byte length
+  impl::Cursor cursor{items_};
+  for (size_t i = 0; i < index; ++i) {
+    cursor.ReadValue();
+  }
+  return cursor.ReadValue();
+}
+
+ArrayView::Iterator::Iterator(const ArrayView* array, size_t index)
+    : array_(array), index_(index) {
+  if (index_ < array_->size_) {
+    impl::Cursor cursor{array_->items_};
+    current_ = cursor.ReadItem(array_->tag_, array_->item_size_);
+    next_offset_ = cursor.GetOffset();
+  }
+}
+
+ArrayView::Iterator& ArrayView::Iterator::operator++() {
+  if (++index_ < array_->size_) {
+    impl::Cursor cursor{array_->items_, next_offset_};
+    current_ = cursor.ReadItem(array_->tag_, array_->item_size_);
+    next_offset_ = cursor.GetOffset();
+  }
+  return *this;
+}
+
+ObjectView::Iterator::Iterator(const ObjectView* object, size_t index)
+    : object_(object), index_(index) {
+  if (index_ < object_->size_) {
+    impl::Cursor cursor{object_->items_};
+    current_.first = cursor.ReadKey();
+    current_.second = cursor.ReadValue();
+    next_offset_ = cursor.GetOffset();
+  }
+}
+
+ObjectView::Iterator& ObjectView::Iterator::operator++() {
+  if (++index_ < object_->size_) {
+    impl::Cursor cursor{object_->items_, next_offset_};
+    current_.first = cursor.ReadKey();
+    current_.second = cursor.ReadValue();
+    next_offset_ = cursor.GetOffset();
+  }
+  return *this;
+}
+
+std::optional<ValueView> ObjectView::Find(std::string_view key) const {
+  if (IsIndexed()) {
+    const size_t slots_count = index_.size() / sizeof(uint32_t);
+    size_t slot = impl::HashKey(key) & (slots_count - 1);
+    for (size_t probe = 0; probe < slots_count; ++probe) {
+      uint32_t offset;
+      std::memcpy(&offset, index_.data() + slot * sizeof(offset),
+                  sizeof(offset));
+      if (offset == impl::kEmptySlot) {
+        break;
+      }
+      impl::Cursor cursor{items_, offset};
+      if (cursor.ReadKey() == key) {
+        return cursor.ReadValue();
+      }
+      slot = (slot + 1) & (slots_count - 1);
+    }
+    return std::nullopt;
+  }
+  for (const auto& [item_key, item] : *this) {
+    if (item_key == key) {
+      return item;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace magl::binary
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <binary/format.hpp>
+#include <value/value.hpp>
+
+namespace magl::binary {
+
+namespace impl {
+class Cursor;
+}  // namespace impl
+
+struct DecodingError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+class ArrayView;
+class ObjectView;
+
+/// Read-only view of an encoded value (see encoder.hpp) that borrows the
+/// encoded buffer: strings are views of its bytes, and the items of containers
+/// are decoded as they are visited. The buffer must outlive the views.
+/// Malformed encodings throw DecodingError when the broken part is visited
+class ValueView {
+ public:
+  enum class Kind {
+    kNull,
+    kBool,
+    kInteger,
+    kFloat,
+    kString,
+    kArray,
+    kObject,
+  };
+
+  ValueView() = default;
+
+  Kind GetKind() const { return kind_; }
+  bool IsNull() const { return kind_ == Kind::kNull; }
+
+  // Throw std::invalid_argument if the value is of another kind
+  value::BoolValue GetBool() const;
+  value::IntegerValue GetInteger() const;
+  value::FloatValue GetFloat() const;
+  std::string_view GetString() const;
+  ArrayView GetArray() const;
+  ObjectView GetObject() const;
+
+  /// Decodes the value and everything it contains
+  value::Value Materialize() const;
+
+ private:
+  friend class impl::Cursor;
+
+  Kind kind_ = Kind::kNull;
+  // kArray, kIntegerArray or kFloatArray for arrays
+  impl::Tag tag_ = impl::Tag::kNull;
+  // Size of the items of a packed array
+  uint8_t item_size_ = 0;
+  // Slots of the hash index of an indexed object
+  std::string_view index_;
+  value::IntegerValue integer_ = 0;
+  value::FloatValue float_ = 0;
+  // Bytes of a string or items of a container
+  std::string_view data_;
+  size_t size_ = 0;
+};
+
+/// Views the value that takes the whole `data`. Throws DecodingError if `data`
+/// does not start with a value or has bytes after it
+ValueView View(std::string_view data);
+
+/// Decodes the value that takes the whole `data` into owned values. Throws
+/// DecodingError if `data` is malformed
+value::Value Decode(std::string_view data);
+
+class ArrayView {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ValueView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const ValueView*;
+    using reference = const ValueView&;
+
+    Iterator() = default;
+
+    reference operator*() const { return current_; }
+    pointer operator->() const { return &current_; }
+    Iterator& operator++();
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    friend class ArrayView;
+
+    // Either the begin (0) or the end (size) of the array
+    Iterator(const ArrayView* array, size_t index);
+
+    const ArrayView* array_ = nullptr;
+    size_t index_ = 0;
+    // Offset of the item after the current one in the items of the array
+    size_t next_offset_ = 0;
+    ValueView current_;
+  };
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /// Whether the items are all integers or all floats, which makes At O(1)
+  bool IsPacked() const { return tag_ != impl::Tag::kArray; }
+
+  /// Returns the item at `index`: O(1) for packed arrays, O(index) otherwise.
+  /// Throws std::out_of_range
+  ValueView At(size_t index) const;
+
+  Iterator begin() const { return Iterator{this, 0}; }
+  Iterator end() const { return Iterator{this, size_}; }
+
+ private:
+  friend class ValueView;
+  friend class impl::Cursor;
+
+  ArrayView(std::string_view items, size_t size, impl::Tag tag,
+            uint8_t item_size)
+      : items_(items), size_(size), tag_(tag), item_size_(item_size) {}
+
+  std::string_view items_;
+  size_t size_ = 0;
+  impl::Tag tag_ = impl::Tag::kArray;
+  uint8_t item_size_ = 0;
+};
+
+class ObjectView {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<std::string_view, ValueView>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    Iterator() = default;
+
+    reference operator*() const { return current_; }
+    pointer operator->() const { return &current_; }
+    Iterator& operator++();
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    friend class ObjectView;
+
+    // Either the begin (0) or the end (size) of the object
+    Iterator(const ObjectView* object, size_t index);
+
+    const ObjectView* object_ = nullptr;
+    size_t index_ = 0;
+    size_t next_offset_ = 0;
+    value_type current_;
+  };
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /// Returns the value of `key` if it is present. Large objects are looked up
+  /// by their hash index, keys of the others are compared one by one
+  std::optional<ValueView> Find(std::string_view key) const;
+
+  /// Whether the object has a hash index, see format.hpp
+  bool IsIndexed() const { return !index_.empty(); }
+
+  Iterator begin() const { return Iterator{this, 0}; }
+  Iterator end() const { return Iterator{this, size_}; }
+
+ private:
+  friend class ValueView;
+
+  ObjectView(std::string_view items, size_t size, std::string_view index)
+      : items_(items), size_(size), index_(index) {}
+
+  std::string_view items_;
+  size_t size_ = 0;
+  std::string_view index_;
+};
+
+}  // namespace magl::binary
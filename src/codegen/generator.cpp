@@ -0,0 +1,405 @@
+#include <codegen/generator.hpp>
+
+#include <cmath>
+#include <format>
+#include <limits>
+#include <vector>
+
+#include <executer/precompiled.hpp>
+#include <functions/function-factory.hpp>
+#include <parser/parser.hpp>
+#include <parser/utils/overloaded.hpp>
+
+namespace magl::codegen {
+
+namespace {
+
+using parser::terms::ApplicationTerm;
+using parser::terms::FunctionTerm;
+using parser::terms::LambdaTerm;
+using parser::terms::LetTerm;
+using parser::terms::Term;
+using parser::terms::ValueTerm;
+using parser::terms::VariableTerm;
+
+const std::string kValue = "::magl::value::Value";
+
+[[noreturn]] void ThrowUnsupported(std::string_view what) {
+  throw functions::UnsupportedType(
+      std::format("Code generator does not support {}.", what));
+}
+
+/// Returns a C++ type that represents values of `type`
+std::string GetCppType(const functions::Type& type) {
+  return boost::apply_visitor(
+      parser::utils::overloaded{
+          [](const functions::IntegerType&) -> std::string {
+            return "::magl::value::IntegerValue";
+          },
+          [](const functions::DoubleType&) -> std::string {
+            return "::magl::value::FloatValue";
+          },
+          [](const functions::BoolType&) -> std::string {
+            return "::magl::value::BoolValue";
+          },
+          [](const functions::StringType&) -> std::string {
+            return "::magl::value::StringValue";
+          },
+          [](const functions::NullType&) -> std::string {
+            return "::magl::value::NullValue";
+          },
+          [](const functions::AnyType&) -> std::string { return kValue; },
+          [](const functions::ListType&) -> std::string {
+            return "::magl::value::ArrayValue";
+          },
+          [](const functions::DictType&) -> std::string {
+            return "::magl::value::ObjectValue";
+          },
+          [](const functions::SchemaType&) -> std::string {
+            return "::magl::value::ObjectValue";
+          },
+          [](const functions::FunctionType&) -> std::string {
+            ThrowUnsupported("function values");
+          },
+          [](const functions::TypeVariable&) -> std::string {
+            ThrowUnsupported("unresolved types");
+          },
+      },
+      type);
+}
+
+/// Returns a C++ string literal
+std::string EmitStringLiteral(std::string_view s) {
+  std::string result = "std::string_view(\"";
+  for (const char c : s) {
+    const auto byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+      result.push_back(c);
+    } else if (byte >= 0x20 && byte < 0x7f && c != '?') {
+      result.push_back(c);
+    } else {
+      // NB: Octal escapes take at most 3 digits and can not swallow the next
+      // character unlike hex escapes
+      result += std::format("\\{:03o}", byte);
+    }
+  }
+  result += std::format("\", {})", s.size());
+  return result;
+}
+
+std::string EmitDouble(double v) {
+  if (std::isnan(v)) {
+    return "std::numeric_limits<double>::quiet_NaN()";
+  }
+  if (std::isinf(v)) {
+    return v > 0 ? "std::numeric_limits<double>::infinity()"
+                 : "-std::numeric_limits<double>::infinity()";
+  }
+  // Shortest representation that round-trips
+  return std::format("{}", v);
+}
+
+class CodeGenerator {
+ public:
+  /// Returns a C++ expression of type GetCppType(type of t)
+  std::string Emit(const Term& t);
+
+  /// Returns a C++ expression of type value::Value
+  std::string EmitAsValue(const Term& t) {
+    return std::format("{}({})", kValue, Emit(t));
+  }
+
+  /// Definitions of constants used by emitted expressions
+  const std::vector<std::string>& GetDefinitions() const {
+    return definitions_;
+  }
+
+ private:
+  /// Returns a C++ expression of the natural type of the value
+  std::string EmitLiteral(const value::Value& v);
+
+  /// Evaluates `definition` into `variable` and then evaluates `body`
+  std::string EmitBinding(const VariableTerm& variable, const Term& definition,
+                          const Term& body, const functions::Type& type);
+
+  std::string EmitApplication(const ApplicationTerm& t);
+
+  std::string EmitFunction(const FunctionTerm& function,
+                           const std::vector<Term>& args,
+                           const functions::Type& type);
+
+  /// Defines a constant and returns its name
+  std::string Define(std::string_view cpp_type, std::string_view value);
+
+ private:
+  std::vector<std::string> definitions_;
+};
+
+std::string CodeGenerator::Define(std::string_view cpp_type,
+                                  std::string_view value) {
+  std::string name = std::format("kConst{}", definitions_.size());
+  // NB: Not a list-initialization: ArrayValue{ArrayValue{}} is a list of one
+  // item since Value is constructible from ArrayValue
+  definitions_.push_back(
+      std::format("const {} {} = {};", cpp_type, name, value));
+  return name;
+}
+
+std::string CodeGenerator::EmitLiteral(const value::Value& v) {
+  return boost::apply_visitor(
+      parser::utils::overloaded{
+          [](const value::IntegerValue& v) -> std::string {
+            if (v == std::numeric_limits<value::IntegerValue>::min()) {
+              return "std::numeric_limits<::magl::value::IntegerValue>::min()";
+            }
+            return std::format("::magl::value::IntegerValue{{{}}}", v);
+          },
+          [](const value::FloatValue& v) -> std::string {
+            return std::format("::magl::value::FloatValue({})", EmitDouble(v));
+          },
+          [](const value::BoolValue& v) -> std::string {
+            return v ? "true" : "false";
+          },
+          [this](const value::StringValue& v) -> std::string {
+            return Define("::magl::value::StringValue",
+                          std::format("::magl::value::StringValue({})",
+                                      EmitStringLiteral(v)));
+          },
+          [](const value::NullValue&) -> std::string {
+            return "::magl::value::NullValue{}";
+          },
+          [](const value::LambdaValue&) -> std::string {
+            ThrowUnsupported("function values");
+          },
+          [this](const value::ArrayValue& v) -> std::string {
+            std::string items;
+            for (const value::Value& item : v) {
+              items += std::format("{}({}), ", kValue, EmitLiteral(item));
+            }
+            return Define("::magl::value::ArrayValue",
+                          std::format("::magl::value::ArrayValue{{{}}}", items));
+          },
+          [this](const value::ObjectValue& v) -> std::string {
+            std::string items;
+            for (const auto& [key, item] : v) {
+              items += std::format("{{::magl::value::StringValue({}), {}({})}}, ",
+                                   EmitStringLiteral(key), kValue,
+                                   EmitLiteral(item));
+            }
+            return Define(
+                "::magl::value::ObjectValue",
+                std::format("::magl::value::ObjectValue{{{}}}", items));
+          },
+      },
+      v);
+}
+
+std::string CodeGenerator::Emit(const Term& t) {
+  if (const auto* value = boost::get<ValueTerm>(&t)) {
+    if (boost::get<functions::AnyType>(&value->type)) {
+      return std::format("{}({})", kValue, EmitLiteral(value->value));
+    }
+    return EmitLiteral(value->value);
+  }
+
+  if (const auto* variable = boost::get<VariableTerm>(&t)) {
+    return std::format("v{}", variable->uid);
+  }
+
+  if (const auto* let = boost::get<LetTerm>(&t)) {
+    return EmitBinding(let->variable, let->definition, let->body, let->type);
+  }
+
+  if (const auto* application = boost::get<ApplicationTerm>(&t)) {
+    return EmitApplication(*application);
+  }
+
+  ThrowUnsupported("function values");
+}
+
+std::string CodeGenerator::EmitBinding(const VariableTerm& variable,
+                                       const Term& definition,
+                                       const Term& body,
+                                       const functions::Type& type) {
+  // NB: A reference binds to an item of a container without a copy and
+  // extends the lifetime of a temporary otherwise
+  return std::format("[&]() -> {} {{ const {}& v{} = {}; return {}; }}()",
+                     GetCppType(type), GetCppType(variable.type), variable.uid,
+                     Emit(definition), Emit(body));
+}
+
+std::string CodeGenerator::EmitApplication(const ApplicationTerm& t) {
+  if (const auto* lambda = boost::get<LambdaTerm>(&t.executable)) {
+    if (t.arguments.size() != 1) {
+      ThrowUnsupported("lambda application with multiple arguments");
+    }
+    return EmitBinding(lambda->argument, t.arguments.front(), lambda->body,
+                       t.type);
+  }
+
+  if (const auto* function = boost::get<FunctionTerm>(&t.executable)) {
+    return EmitFunction(*function, t.arguments, t.type);
+  }
+
+  ThrowUnsupported("application of a computed function");
+}
+
+std::string CodeGenerator::EmitFunction(const FunctionTerm& function,
+                                        const std::vector<Term>& args,
+                                        const functions::Type& type) {
+  const std::string& name = function.name;
+  const bool is_number = boost::get<functions::IntegerType>(&type) ||
+                         boost::get<functions::DoubleType>(&type);
+
+  if ((name == "Add" || name == "Multiply") && is_number) {
+    return std::format("({} {} {})", Emit(args.at(0)),
+                       name == "Add" ? '+' : '*', Emit(args.at(1)));
+  }
+
+  if ((name == "Add" || name == "Multiply") &&
+      boost::get<functions::AnyType>(&type)) {
+    return std::format("::magl::functions::library::{}Any({}, {})", name,
+                       Emit(args.at(0)), Emit(args.at(1)));
+  }
+
+  if (name == "And" || name == "Or") {
+    return std::format("({} {} {})", Emit(args.at(0)),
+                       name == "And" ? "&&" : "||", Emit(args.at(1)));
+  }
+
+  if (name == "If") {
+    return std::format("({} ? {}({}) : {}({}))", Emit(args.at(0)),
+                       GetCppType(type), Emit(args.at(1)), GetCppType(type),
+                       Emit(args.at(2)));
+  }
+
+  if (name == "VarMapAt") {
+    std::string key;
+    if (const auto* constant = boost::get<ValueTerm>(&args.at(1))) {
+      // Hashed once during static initialization
+      key = Define("::magl::value::PrehashedKey",
+                   std::format("::magl::value::MakePrehashedKey({})",
+                               EmitStringLiteral(boost::get<value::StringValue>(
+                                   constant->value))));
+    } else {
+      key = Emit(args.at(1));
+    }
+    return std::format("::magl::codegen::runtime::At<{}>({}, {})",
+                       GetCppType(type), Emit(args.at(0)), key);
+  }
+
+  if (name == "GetVar") {
+    return std::format("{}({})", GetCppType(type), Emit(args.at(0)));
+  }
+
+  if (name == "Insert") {
+    return std::format("::magl::codegen::runtime::Insert({}, {}, {})",
+                       Emit(args.at(0)), Emit(args.at(1)),
+                       EmitAsValue(args.at(2)));
+  }
+
+  if (name == "Append") {
+    return std::format("::magl::codegen::runtime::Append({}, {})",
+                       Emit(args.at(0)), EmitAsValue(args.at(1)));
+  }
+
+  if (name == "Map") {
+    const auto* lambda = boost::get<LambdaTerm>(&args.at(0));
+    if (!lambda) {
+      ThrowUnsupported("Map of a computed function");
+    }
+    const std::string x_type = GetCppType(lambda->argument.type);
+    return std::format(
+        "::magl::codegen::runtime::Map<{}>({}, [&](const {}& v{}) -> {} {{ "
+        "return {}; }})",
+        x_type, Emit(args.at(1)), x_type, lambda->argument.uid, kValue,
+        EmitAsValue(lambda->body));
+  }
+
+  if (name == "GetAnyOne") {
+    return std::format("{}(::magl::value::IntegerValue{{1}})", kValue);
+  }
+
+  ThrowUnsupported(std::format("f={}, t={}", name, ToString(function.type)));
+}
+
+}  // namespace
+
+std::string GenerateCpp(std::string_view source,
+                        const GeneratorOptions& options) {
+  // Placeholders are read from the context after the declared inputs
+  parser::terms::InputSchema inputs = options.inputs;
+  const parser::terms::SemanticGraph graph =
+      parser::Parse(source, options.inputs, &inputs);
+
+  CodeGenerator generator;
+  const std::string body = generator.EmitAsValue(graph);
+
+  std::string result;
+  result += "// Generated by magl-codegen, do not edit.\n";
+  result += "//\n";
+  result += std::format("// Source hash: {:#018x}\n",
+                        executer::HashSource(source));
+  result += "\n";
+  result += "#include <codegen/runtime.hpp>\n";
+  result += "#include <executer/context.hpp>\n";
+  result += "#include <executer/precompiled.hpp>\n";
+  result += "\n";
+  result += "#include <array>\n";
+  result += "#include <limits>\n";
+  result += "#include <string_view>\n";
+  result += "\n";
+  result += "namespace {\n";
+  result += "\n";
+  result += std::format("constexpr std::string_view kSource = {};\n",
+                        EmitStringLiteral(source));
+  // Declared inputs, the function is only used with the same ones
+  result += std::format(
+      "constexpr std::array<::magl::executer::PrecompiledInput, {}> kInputs = "
+      "{{{{\n",
+      options.inputs.size());
+  for (const parser::terms::InputVariable& input : options.inputs) {
+    result += std::format("    {{{}, {}}},\n", EmitStringLiteral(input.name),
+                          EmitStringLiteral(functions::ToString(input.type)));
+  }
+  result += "}};\n";
+  for (const std::string& definition : generator.GetDefinitions()) {
+    result += definition;
+    result += "\n";
+  }
+  result += "\n";
+  result += "}  // namespace\n";
+  result += "\n";
+  result += std::format("namespace {} {{\n", options.namespace_name);
+  result += "\n";
+  result += std::format(
+      "::magl::value::Value {}(\n"
+      "    const ::magl::executer::EvaluationContext& {}) {{\n",
+      options.function_name,
+      inputs.empty() ? "/*context*/" : "context");
+  // Input i is the variable with uid i
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const std::string cpp_type = GetCppType(inputs[i].type);
+    result += std::format(
+        "  const {}& v{} = ::magl::executer::GetInput<{}>(context, {});\n",
+        cpp_type, i, cpp_type, i);
+  }
+  result += std::format("  return {};\n", body);
+  result += "}\n";
+  result += "\n";
+  result += std::format("}}  // namespace {}\n", options.namespace_name);
+  result += "\n";
+  result += "namespace {\n";
+  result += "\n";
+  result += std::format(
+      "[[maybe_unused]] const bool kRegistered =\n"
+      "    ::magl::executer::RegisterPrecompiled(kSource, &{}::{}, "
+      "kInputs);\n",
+      options.namespace_name, options.function_name);
+  result += "\n";
+  result += "}  // namespace\n";
+  return result;
+}
+
+}  // namespace magl::codegen
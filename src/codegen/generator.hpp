@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <parser/terms/input-schema.hpp>
+
+namespace magl::codegen {
+
+struct GeneratorOptions {
+  /// Name of the emitted function
+  std::string function_name = "Evaluate";
+  /// Namespace of the emitted function
+  std::string namespace_name = "magl_generated";
+  /// Inputs of the expression, read from the context by the emitted function.
+  /// Placeholders of the source follow them
+  parser::terms::InputSchema inputs{};
+};
+
+/// Emits a self-contained C++ translation unit with a function
+///   magl::value::Value <namespace_name>::<function_name>(
+///       const magl::executer::EvaluationContext&)
+/// that evaluates `source` and is specialized on its inferred types. The
+/// function registers itself in the registry of precompiled expressions (see
+/// executer/precompiled.hpp) under `source` and the declared inputs.
+///
+/// Throws functions::UnsupportedType if the expression uses something that is
+/// not supported by the generator, and parser errors if it is ill-formed.
+std::string GenerateCpp(std::string_view source,
+                        const GeneratorOptions& options = {});
+
+}  // namespace magl::codegen
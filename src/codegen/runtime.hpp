@@ -0,0 +1,52 @@
+#pragma once
+
+// Helpers used by C++ code emitted by codegen::GenerateCpp
+
+#include <executer/budget.hpp>
+#include <functions/library/add.hpp>
+#include <functions/library/ducttape-var-map-at.hpp>
+#include <functions/library/multiply.hpp>
+#include <value/value.hpp>
+
+#include <type_traits>
+
+namespace magl::codegen::runtime {
+
+template <typename T>
+const T& Get(const value::Value& v) {
+  if constexpr (std::is_same_v<T, value::Value>) {
+    return v;
+  } else {
+    return boost::get<T>(v);
+  }
+}
+
+template <typename T, typename K>
+const T& At(const value::ObjectValue& object, const K& key) {
+  return functions::library::impl::GetItem<T>(object, key);
+}
+
+inline value::ObjectValue Insert(value::ObjectValue object, std::string key,
+                                 value::Value item) {
+  object.emplace(std::move(key), std::move(item));
+  return object;
+}
+
+inline value::ArrayValue Append(value::ArrayValue list, value::Value item) {
+  list.push_back(std::move(item));
+  return list;
+}
+
+/// Applies f to items of type X
+template <typename X, typename F>
+value::ArrayValue Map(const value::ArrayValue& items, F f) {
+  value::ArrayValue result;
+  result.reserve(items.size());
+  for (const value::Value& item : items) {
+    executer::CountStep();
+    result.push_back(f(Get<X>(item)));
+  }
+  return result;
+}
+
+}  // namespace magl::codegen::runtime
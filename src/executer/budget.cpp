@@ -0,0 +1,67 @@
+#include <executer/budget.hpp>
+
+#include <algorithm>
+
+namespace magl::executer {
+
+namespace {
+
+const char* GetMessage(BudgetLimit limit) {
+  switch (limit) {
+    case BudgetLimit::kSteps:
+      return "Evaluation exceeded its budget of steps.";
+    case BudgetLimit::kAllocatedBytes:
+      return "Evaluation exceeded its budget of allocated bytes.";
+    case BudgetLimit::kDeadline:
+      return "Evaluation exceeded its deadline.";
+  }
+  return "Evaluation exceeded its budget.";
+}
+
+}  // namespace
+
+BudgetExceeded::BudgetExceeded(BudgetLimit limit)
+    : std::runtime_error(GetMessage(limit)), limit_(limit) {}
+
+BudgetTracker::BudgetTracker(const EvaluationBudget& budget)
+    : budget_(budget) {
+  if (budget_.allocation_counter) {
+    start_allocated_ = budget_.allocation_counter();
+  }
+}
+
+void BudgetTracker::Check() {
+  if (budget_.max_steps > 0 && steps_ > budget_.max_steps) {
+    throw BudgetExceeded(BudgetLimit::kSteps);
+  }
+  if (budget_.max_allocated_bytes > 0 && budget_.allocation_counter &&
+      budget_.allocation_counter() - start_allocated_ >
+          budget_.max_allocated_bytes) {
+    throw BudgetExceeded(BudgetLimit::kAllocatedBytes);
+  }
+  if (budget_.deadline &&
+      std::chrono::steady_clock::now() > *budget_.deadline) {
+    throw BudgetExceeded(BudgetLimit::kDeadline);
+  }
+
+  next_check_ = steps_ + kCheckInterval;
+  if (budget_.max_steps > 0) {
+    // The step over the limit is checked as it comes
+    next_check_ = std::min(next_check_, budget_.max_steps + 1);
+  }
+}
+
+ScopedBudget::ScopedBudget(const EvaluationBudget* budget) {
+  if (budget && !impl::current_budget) {
+    tracker_.emplace(*budget);
+    impl::current_budget = &*tracker_;
+  }
+}
+
+ScopedBudget::~ScopedBudget() {
+  if (tracker_) {
+    impl::current_budget = nullptr;
+  }
+}
+
+}  // namespace magl::executer
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+#include <executer/profile.hpp>
+
+namespace magl::executer {
+
+/// Limits of a single evaluation, see EvaluationContext::budget. Evaluations
+/// are counted in steps: items of Map. Lambdas can not recurse, so any other
+/// work is bounded by the size of the expression and of its inputs
+struct EvaluationBudget {
+  // 0 is no limit
+  uint64_t max_steps = 0;
+  // Bytes allocated by the thread during the evaluation as read by
+  // `allocation_counter`. 0 is no limit
+  uint64_t max_allocated_bytes = 0;
+  AllocationCounter allocation_counter = nullptr;
+  std::optional<std::chrono::steady_clock::time_point> deadline{};
+};
+
+enum class BudgetLimit {
+  kSteps = 0,
+  kAllocatedBytes = 1,
+  kDeadline = 2,
+};
+
+/// Aborts an evaluation that exceeds its budget. The evaluation has no side
+/// effects, so there is nothing to roll back
+class BudgetExceeded : public std::runtime_error {
+ public:
+  explicit BudgetExceeded(BudgetLimit limit);
+
+  BudgetLimit GetLimit() const { return limit_; }
+
+ private:
+  const BudgetLimit limit_;
+};
+
+/// Spends the budget of the evaluation running on the thread
+class BudgetTracker {
+ public:
+  /// The deadline and the allocations are checked once in kCheckInterval
+  /// steps, the clock and the counter are too slow for each one
+  static constexpr uint64_t kCheckInterval = 64;
+
+  explicit BudgetTracker(const EvaluationBudget& budget);
+
+  /// Throws BudgetExceeded if the budget is spent
+  void Step() {
+    if (++steps_ >= next_check_) {
+      Check();
+    }
+  }
+
+ private:
+  void Check();
+
+ private:
+  const EvaluationBudget& budget_;
+  uint64_t steps_ = 0;
+  // The first step checks the deadline
+  uint64_t next_check_ = 1;
+  uint64_t start_allocated_ = 0;
+};
+
+namespace impl {
+
+inline thread_local BudgetTracker* current_budget = nullptr;
+
+}  // namespace impl
+
+/// Spends a step of the evaluation running on the thread if it has a budget.
+/// Called on the back-edges of loops that evaluate parts of the expression
+inline void CountStep() {
+  if (BudgetTracker* tracker = impl::current_budget) {
+    tracker->Step();
+  }
+}
+
+/// Makes `budget` the budget of the evaluations on the thread in the scope.
+/// Does nothing without a budget, a nested scope keeps the outer one
+class ScopedBudget {
+ public:
+  explicit ScopedBudget(const EvaluationBudget* budget);
+  ~ScopedBudget();
+
+  ScopedBudget(const ScopedBudget&) = delete;
+  ScopedBudget& operator=(const ScopedBudget&) = delete;
+
+ private:
+  std::optional<BudgetTracker> tracker_;
+};
+
+}  // namespace magl::executer
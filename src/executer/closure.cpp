@@ -0,0 +1,652 @@
+#include <executer/closure.hpp>
+
+#include <any>
+#include <format>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+
+#include <functions/function-factory.hpp>
+#include <functions/library/add.hpp>
+#include <functions/library/ducttape-var-map-at.hpp>
+#include <functions/library/multiply.hpp>
+#include <functions/utils/value-type.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+using parser::terms::ApplicationTerm;
+using parser::terms::FunctionTerm;
+using parser::terms::LambdaTerm;
+using parser::terms::LetTerm;
+using parser::terms::Term;
+using parser::terms::ValueTerm;
+using parser::terms::VariableTerm;
+
+// NB: Function values are only supported as immediately applied lambdas and
+// as arguments of Map
+template <typename T>
+constexpr bool kIsSupported = !std::is_same_v<T, value::LambdaValue>;
+
+template <typename T>
+value::Value ToValue(T v) {
+  if constexpr (std::is_same_v<T, value::Value>) {
+    return v;
+  } else {
+    return value::Value{std::move(v)};
+  }
+}
+
+template <typename T>
+const T& FromValue(const value::Value& v) {
+  if constexpr (std::is_same_v<T, value::Value>) {
+    return v;
+  } else {
+    return boost::get<T>(v);
+  }
+}
+
+const functions::Type& GetTermType(const Term& t) {
+  return boost::apply_visitor(
+      [](const auto& t) -> const functions::Type& { return t.type; }, t);
+}
+
+/// Returns types of the first `n` arguments of a curried function type
+std::vector<functions::Type> GetArgumentTypes(const functions::Type& type,
+                                              size_t n) {
+  std::vector<functions::Type> result;
+  const functions::Type* current = &type;
+  for (size_t i = 0; i < n; ++i) {
+    const auto* function = boost::get<functions::FunctionType>(current);
+    if (!function) {
+      throw functions::UnsupportedType(
+          std::format("Too many arguments for {}", ToString(type)));
+    }
+    result.push_back(function->argument);
+    current = &function->body;
+  }
+  return result;
+}
+
+[[noreturn]] void ThrowUnsupported(std::string_view what) {
+  throw functions::UnsupportedType(
+      std::format("Closure backend does not support {}.", what));
+}
+
+/// Whether a term refers to a value that outlives its evaluation
+bool IsReference(const Term& t) {
+  if (boost::get<VariableTerm>(&t)) {
+    return true;
+  }
+  if (const auto* application = boost::get<ApplicationTerm>(&t)) {
+    const auto* function = boost::get<FunctionTerm>(&application->executable);
+    return function && function->name == "VarMapAt";
+  }
+  return false;
+}
+
+/// Returns the function if `t` is Add or Multiply of type Any
+const FunctionTerm* GetAnyArithmetic(const Term& t) {
+  const auto* application = boost::get<ApplicationTerm>(&t);
+  if (!application || !boost::get<functions::AnyType>(&application->type) ||
+      application->arguments.size() != 2) {
+    return nullptr;
+  }
+  const auto* function = boost::get<FunctionTerm>(&application->executable);
+  if (!function || (function->name != "Add" && function->name != "Multiply")) {
+    return nullptr;
+  }
+  return function;
+}
+
+/// Guard of speculative code
+template <typename S>
+S Guard(const value::Value& v) {
+  if (const S* specialized = boost::get<S>(&v)) {
+    return *specialized;
+  }
+  throw DeoptimizationError("Value does not match the type profile.");
+}
+
+// Operands of arithmetic on Integer and Float. The operation is instantiated
+// for each pair of them, so constants and inputs are read inline instead of
+// through a call of a closure
+
+template <typename T>
+struct ConstantOperand {
+  T value;
+  T operator()(Frame&) const { return value; }
+};
+
+template <typename T>
+struct InputOperand {
+  size_t i;
+  const T& operator()(Frame& f) const { return GetInput<T>(*f.context, i); }
+};
+
+template <typename T>
+struct ClosureOperand {
+  Closure<T> closure;
+  T operator()(Frame& f) const { return closure(f); }
+};
+
+class ClosureCompiler {
+ public:
+  explicit ClosureCompiler(const ClosureOptions& options) : options_(options) {}
+
+  /// Binds input i to the variable with uid i
+  void BindInputs(const parser::terms::InputSchema& inputs);
+
+  /// Compiles a term that returns T
+  template <typename T>
+  Closure<T> Compile(const Term& t);
+
+  /// Compiles a term that returns a reference to T
+  template <typename T>
+  RefClosure<T> CompileRef(const Term& t);
+
+  /// Compiles a term of type `type` that returns value::Value
+  Closure<value::Value> CompileAsValue(const Term& t,
+                                       const functions::Type& type);
+
+ private:
+  /// Restores the previous binding of a variable when the scope is over
+  class BindingScope {
+   public:
+    BindingScope(ClosureCompiler* compiler, size_t uid)
+        : compiler_(compiler), uid_(uid) {
+      const auto find_variable = compiler_->variables_.find(uid_);
+      if (find_variable != compiler_->variables_.end()) {
+        old_binding_ = std::move(find_variable->second);
+      }
+    }
+
+    ~BindingScope() {
+      if (old_binding_.has_value()) {
+        compiler_->variables_.insert_or_assign(uid_, std::move(old_binding_));
+      } else {
+        compiler_->variables_.erase(uid_);
+      }
+    }
+
+   private:
+    ClosureCompiler* compiler_;
+    const size_t uid_;
+    std::any old_binding_;
+  };
+
+  template <typename T>
+  Closure<T> CompileTerm(const Term& t);
+
+  /// Returns nullopt if the term is not specialized by the profile
+  std::optional<Closure<value::Value>> TrySpeculate(const Term& t);
+
+  /// Compiles a term of type Any that is expected to return S
+  template <typename S>
+  Closure<S> CompileSpeculated(const Term& t);
+
+  /// Whether all values of the term were V during profiling
+  template <typename V>
+  bool IsProfiledAs(const Term& t) const {
+    const SiteProfile* site = options_.speculate->FindSite(&t);
+    return site && site->IsMonomorphic<V>();
+  }
+
+  template <typename T>
+  RefClosure<T> GetVariable(size_t uid);
+
+  /// Binds a variable to the value of a definition. Returns a closure that
+  /// evaluates the definition and must run before the scope of the variable
+  std::function<void(Frame&)> Bind(const VariableTerm& variable,
+                                   const Term& definition);
+
+  template <typename T>
+  Closure<T> CompileApplication(const ApplicationTerm& t);
+
+  template <typename T>
+  Closure<T> CompileFunction(const FunctionTerm& function,
+                             const std::vector<Term>& args);
+
+  template <typename T>
+  RefClosure<T> CompileVarMapAt(const std::vector<Term>& args);
+
+  /// Calls `make` with the operand that evaluates `t`, see ConstantOperand
+  template <typename T, typename F>
+  Closure<T> WithOperand(const Term& t, F make);
+
+  /// Compiles `op` of two terms that return T, with their operands fused
+  template <typename T, typename Op>
+  Closure<T> CompileArithmetic(Op op, const std::vector<Term>& args);
+
+ private:
+  const ClosureOptions options_;
+  // Variables with uids below are inputs
+  size_t inputs_size_ = 0;
+
+  // uid -> RefClosure<T>
+  std::unordered_map<size_t, std::any> variables_;
+};
+
+void ClosureCompiler::BindInputs(const parser::terms::InputSchema& inputs) {
+  inputs_size_ = inputs.size();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    functions::utils::VisitValueType(inputs[i].type, [&](auto tag) {
+      using V = typename decltype(tag)::type;
+      if constexpr (!kIsSupported<V>) {
+        ThrowUnsupported("function inputs");
+      } else {
+        // NB: Zero-copy: the value stays in the context
+        variables_.insert_or_assign(
+            i, RefClosure<V>{[i](Frame& f) -> const V& {
+              return GetInput<V>(*f.context, i);
+            }});
+      }
+    });
+  }
+}
+
+Closure<value::Value> ClosureCompiler::CompileAsValue(
+    const Term& t, const functions::Type& type) {
+  return functions::utils::VisitValueType(
+      type, [&](auto tag) -> Closure<value::Value> {
+        using V = typename decltype(tag)::type;
+        if constexpr (!kIsSupported<V>) {
+          ThrowUnsupported("function values");
+        } else {
+          Closure<V> compiled = Compile<V>(t);
+          return [compiled](Frame& f) -> value::Value {
+            return ToValue<V>(compiled(f));
+          };
+        }
+      });
+}
+
+template <typename T>
+Closure<T> ClosureCompiler::Compile(const Term& t) {
+  if constexpr (std::is_same_v<T, value::Value>) {
+    if (options_.speculate) {
+      if (auto speculated = TrySpeculate(t)) {
+        return *std::move(speculated);
+      }
+    }
+    Closure<T> compiled = CompileTerm<T>(t);
+    if (options_.record_profile) {
+      SiteProfile* site = options_.record_profile->AddSite(&t);
+      return [compiled, site](Frame& f) -> T {
+        T result = compiled(f);
+        site->Record(result);
+        return result;
+      };
+    }
+    return compiled;
+  } else {
+    return CompileTerm<T>(t);
+  }
+}
+
+std::optional<Closure<value::Value>> ClosureCompiler::TrySpeculate(
+    const Term& t) {
+  if (!GetAnyArithmetic(t)) {
+    return std::nullopt;
+  }
+  if (IsProfiledAs<value::IntegerValue>(t)) {
+    Closure<value::IntegerValue> speculated =
+        CompileSpeculated<value::IntegerValue>(t);
+    return [speculated](Frame& f) -> value::Value { return speculated(f); };
+  }
+  if (IsProfiledAs<value::FloatValue>(t)) {
+    Closure<value::FloatValue> speculated =
+        CompileSpeculated<value::FloatValue>(t);
+    return [speculated](Frame& f) -> value::Value { return speculated(f); };
+  }
+  return std::nullopt;
+}
+
+template <typename S>
+Closure<S> ClosureCompiler::CompileSpeculated(const Term& t) {
+  if (const FunctionTerm* function = GetAnyArithmetic(t)) {
+    // Typed kernels of AddAny and MultiplyAny are Integer x S -> S for S in
+    // {Integer, Float}
+    const std::vector<Term>& args = boost::get<ApplicationTerm>(t).arguments;
+    if (IsProfiledAs<value::IntegerValue>(args.at(0)) &&
+        IsProfiledAs<S>(args.at(1))) {
+      Closure<value::IntegerValue> lhs =
+          CompileSpeculated<value::IntegerValue>(args.at(0));
+      Closure<S> rhs = CompileSpeculated<S>(args.at(1));
+      if (function->name == "Add") {
+        return [lhs, rhs](Frame& f) -> S { return lhs(f) + rhs(f); };
+      }
+      return [lhs, rhs](Frame& f) -> S { return lhs(f) * rhs(f); };
+    }
+  }
+
+  // Guarded value of type Any
+  if (IsReference(t)) {
+    RefClosure<value::Value> ref = CompileRef<value::Value>(t);
+    return [ref](Frame& f) -> S { return Guard<S>(ref(f)); };
+  }
+  Closure<value::Value> generic = CompileTerm<value::Value>(t);
+  return [generic](Frame& f) -> S { return Guard<S>(generic(f)); };
+}
+
+template <typename T>
+Closure<T> ClosureCompiler::CompileTerm(const Term& t) {
+  if (const auto* value = boost::get<ValueTerm>(&t)) {
+    return [v = FromValue<T>(value->value)](Frame&) -> T { return v; };
+  }
+
+  if (const auto* variable = boost::get<VariableTerm>(&t)) {
+    RefClosure<T> ref = GetVariable<T>(variable->uid);
+    return [ref](Frame& f) -> T { return ref(f); };
+  }
+
+  if (const auto* let = boost::get<LetTerm>(&t)) {
+    const BindingScope scope{this, let->variable.uid};
+    std::function<void(Frame&)> bind = Bind(let->variable, let->definition);
+    Closure<T> body = Compile<T>(let->body);
+    return [bind, body](Frame& f) -> T {
+      bind(f);
+      return body(f);
+    };
+  }
+
+  if (const auto* application = boost::get<ApplicationTerm>(&t)) {
+    return CompileApplication<T>(*application);
+  }
+
+  ThrowUnsupported("function values");
+}
+
+template <typename T>
+RefClosure<T> ClosureCompiler::CompileRef(const Term& t) {
+  if (const auto* variable = boost::get<VariableTerm>(&t)) {
+    return GetVariable<T>(variable->uid);
+  }
+
+  if (const auto* application = boost::get<ApplicationTerm>(&t)) {
+    const auto* function = boost::get<FunctionTerm>(&application->executable);
+    if (function && function->name == "VarMapAt") {
+      return CompileVarMapAt<T>(application->arguments);
+    }
+  }
+
+  // Keep a temporary until the next evaluation
+  Closure<T> compiled = Compile<T>(t);
+  auto slot = std::make_shared<T>();
+  return [compiled, slot](Frame& f) -> const T& {
+    *slot = compiled(f);
+    return *slot;
+  };
+}
+
+template <typename T>
+RefClosure<T> ClosureCompiler::GetVariable(size_t uid) {
+  const auto find_variable = variables_.find(uid);
+  if (find_variable == variables_.end()) {
+    throw std::runtime_error(
+        std::format("Variable mapping is not defined for uid={}", uid));
+  }
+  const auto* ref = std::any_cast<RefClosure<T>>(&find_variable->second);
+  if (!ref) {
+    throw std::logic_error(
+        std::format("Variable uid={} has unexpected type.", uid));
+  }
+  return *ref;
+}
+
+std::function<void(Frame&)> ClosureCompiler::Bind(const VariableTerm& variable,
+                                                  const Term& definition) {
+  // NB: The definition is compiled before the variable is bound: bindings are
+  // non-recursive
+  return functions::utils::VisitValueType(
+      variable.type, [&](auto tag) -> std::function<void(Frame&)> {
+        using V = typename decltype(tag)::type;
+        if constexpr (!kIsSupported<V>) {
+          ThrowUnsupported("function variables");
+        } else {
+          if (IsReference(definition)) {
+            // Borrow the value
+            RefClosure<V> ref = CompileRef<V>(definition);
+            auto slot = std::make_shared<const V*>(nullptr);
+            variables_.insert_or_assign(
+                variable.uid,
+                RefClosure<V>{[slot](Frame&) -> const V& { return **slot; }});
+            return [ref, slot](Frame& f) { *slot = &ref(f); };
+          }
+
+          Closure<V> compiled = Compile<V>(definition);
+          auto slot = std::make_shared<V>();
+          variables_.insert_or_assign(
+              variable.uid,
+              RefClosure<V>{[slot](Frame&) -> const V& { return *slot; }});
+          return [compiled, slot](Frame& f) { *slot = compiled(f); };
+        }
+      });
+}
+
+template <typename T>
+Closure<T> ClosureCompiler::CompileApplication(const ApplicationTerm& t) {
+  if (const auto* lambda = boost::get<LambdaTerm>(&t.executable)) {
+    // Immediately applied lambda is a binding of its argument
+    if (t.arguments.size() != 1) {
+      ThrowUnsupported("lambda application with multiple arguments");
+    }
+    const BindingScope scope{this, lambda->argument.uid};
+    std::function<void(Frame&)> bind =
+        Bind(lambda->argument, t.arguments.front());
+    Closure<T> body = Compile<T>(lambda->body);
+    return [bind, body](Frame& f) -> T {
+      bind(f);
+      return body(f);
+    };
+  }
+
+  if (const auto* function = boost::get<FunctionTerm>(&t.executable)) {
+    return CompileFunction<T>(*function, t.arguments);
+  }
+
+  ThrowUnsupported("application of a computed function");
+}
+
+template <typename T>
+RefClosure<T> ClosureCompiler::CompileVarMapAt(const std::vector<Term>& args) {
+  using functions::library::impl::GetItem;
+
+  RefClosure<value::ObjectValue> object =
+      CompileRef<value::ObjectValue>(args.at(0));
+
+  if (const auto* key = boost::get<ValueTerm>(&args.at(1))) {
+    auto key_string = std::make_shared<const std::string>(
+        boost::get<value::StringValue>(key->value));
+    const value::PrehashedKey prehashed = value::MakePrehashedKey(*key_string);
+    return [object, key_string, prehashed](Frame& f) -> const T& {
+      return GetItem<T>(object(f), prehashed);
+    };
+  }
+
+  Closure<std::string> key = Compile<std::string>(args.at(1));
+  return [object, key](Frame& f) -> const T& {
+    return GetItem<T>(object(f), key(f));
+  };
+}
+
+template <typename T, typename F>
+Closure<T> ClosureCompiler::WithOperand(const Term& t, F make) {
+  if (const auto* value = boost::get<ValueTerm>(&t)) {
+    return make(ConstantOperand<T>{FromValue<T>(value->value)});
+  }
+  if (const auto* variable = boost::get<VariableTerm>(&t);
+      variable && variable->uid < inputs_size_) {
+    // NB: Checks that the input is bound as T
+    GetVariable<T>(variable->uid);
+    return make(InputOperand<T>{variable->uid});
+  }
+  return make(ClosureOperand<T>{Compile<T>(t)});
+}
+
+template <typename T, typename Op>
+Closure<T> ClosureCompiler::CompileArithmetic(Op op,
+                                              const std::vector<Term>& args) {
+  return WithOperand<T>(args.at(0), [&](auto lhs) {
+    return WithOperand<T>(args.at(1), [&](auto rhs) -> Closure<T> {
+      return [op, lhs, rhs](Frame& f) -> T { return op(lhs(f), rhs(f)); };
+    });
+  });
+}
+
+template <typename T>
+Closure<T> ClosureCompiler::CompileFunction(const FunctionTerm& function,
+                                            const std::vector<Term>& args) {
+  const std::string& name = function.name;
+
+  if (name == "Add" || name == "Multiply") {
+    if constexpr (std::is_same_v<T, value::IntegerValue> ||
+                  std::is_same_v<T, value::FloatValue>) {
+      if (name == "Add") {
+        return CompileArithmetic<T>(std::plus<T>{}, args);
+      }
+      return CompileArithmetic<T>(std::multiplies<T>{}, args);
+    } else if constexpr (std::is_same_v<T, value::Value>) {
+      Closure<T> lhs = Compile<T>(args.at(0));
+      Closure<T> rhs = Compile<T>(args.at(1));
+      // Inline cache of the call site
+      auto cache =
+          name == "Add"
+              ? std::make_shared<functions::utils::BinaryInlineCache>(
+                    &functions::library::FindAddKernel,
+                    &functions::library::AddAny)
+              : std::make_shared<functions::utils::BinaryInlineCache>(
+                    &functions::library::FindMultiplyKernel,
+                    &functions::library::MultiplyAny);
+      return [lhs, rhs, cache](Frame& f) -> T {
+        return cache->Call(lhs(f), rhs(f));
+      };
+    }
+  }
+
+  if (name == "And" || name == "Or") {
+    if constexpr (std::is_same_v<T, value::BoolValue>) {
+      Closure<T> lhs = Compile<T>(args.at(0));
+      Closure<T> rhs = Compile<T>(args.at(1));
+      if (name == "And") {
+        return [lhs, rhs](Frame& f) -> T { return lhs(f) && rhs(f); };
+      }
+      return [lhs, rhs](Frame& f) -> T { return lhs(f) || rhs(f); };
+    }
+  }
+
+  if (name == "If") {
+    Closure<value::BoolValue> condition =
+        Compile<value::BoolValue>(args.at(0));
+    Closure<T> then_branch = Compile<T>(args.at(1));
+    Closure<T> else_branch = Compile<T>(args.at(2));
+    return [condition, then_branch, else_branch](Frame& f) -> T {
+      return condition(f) ? then_branch(f) : else_branch(f);
+    };
+  }
+
+  if (name == "VarMapAt") {
+    RefClosure<T> ref = CompileVarMapAt<T>(args);
+    return [ref](Frame& f) -> T { return ref(f); };
+  }
+
+  if (name == "GetVar") {
+    RefClosure<T> ref = CompileRef<T>(args.at(0));
+    return [ref](Frame& f) -> T { return ref(f); };
+  }
+
+  if (name == "Insert") {
+    if constexpr (std::is_same_v<T, value::ObjectValue>) {
+      // Dict[X] -> String -> X -> Dict[X]
+      const auto arg_types = GetArgumentTypes(function.type, 3);
+      Closure<T> object = Compile<T>(args.at(0));
+      Closure<std::string> key = Compile<std::string>(args.at(1));
+      Closure<value::Value> item = CompileAsValue(args.at(2), arg_types[2]);
+      return [object, key, item](Frame& f) -> T {
+        T result = object(f);
+        result.emplace(key(f), item(f));
+        return result;
+      };
+    }
+  }
+
+  if (name == "Append") {
+    if constexpr (std::is_same_v<T, value::ArrayValue>) {
+      // List[X] -> X -> List[X]
+      const auto arg_types = GetArgumentTypes(function.type, 2);
+      Closure<T> list = Compile<T>(args.at(0));
+      Closure<value::Value> item = CompileAsValue(args.at(1), arg_types[1]);
+      return [list, item](Frame& f) -> T {
+        T result = list(f);
+        result.push_back(item(f));
+        return result;
+      };
+    }
+  }
+
+  if (name == "Map") {
+    if constexpr (std::is_same_v<T, value::ArrayValue>) {
+      // (X -> Y) -> List[X] -> List[Y]
+      const auto* lambda = boost::get<LambdaTerm>(&args.at(0));
+      if (!lambda) {
+        ThrowUnsupported("Map of a computed function");
+      }
+      RefClosure<value::ArrayValue> items =
+          CompileRef<value::ArrayValue>(args.at(1));
+
+      return functions::utils::VisitValueType(
+          lambda->argument.type, [&](auto tag) -> Closure<T> {
+            using X = typename decltype(tag)::type;
+            if constexpr (!kIsSupported<X>) {
+              ThrowUnsupported("Map over functions");
+            } else {
+              // Items are borrowed from the list
+              auto slot = std::make_shared<const X*>(nullptr);
+              const BindingScope scope{this, lambda->argument.uid};
+              variables_.insert_or_assign(
+                  lambda->argument.uid,
+                  RefClosure<X>{
+                      [slot](Frame&) -> const X& { return **slot; }});
+              Closure<value::Value> body =
+                  CompileAsValue(lambda->body, GetTermType(lambda->body));
+
+              return [items, slot, body](Frame& f) -> T {
+                const value::ArrayValue& input = items(f);
+                T result;
+                result.reserve(input.size());
+                for (const value::Value& item : input) {
+                  CountStep();
+                  *slot = &FromValue<X>(item);
+                  result.push_back(body(f));
+                }
+                return result;
+              };
+            }
+          });
+    }
+  }
+
+  if (name == "GetAnyOne") {
+    if constexpr (std::is_same_v<T, value::Value>) {
+      return [](Frame&) -> T { return value::IntegerValue{1}; };
+    }
+  }
+
+  ThrowUnsupported(std::format("f={}, t={}", name, ToString(function.type)));
+}
+
+}  // namespace
+
+CompiledClosure CompileClosure(const parser::terms::SemanticGraph& graph,
+                               const ClosureOptions& options) {
+  ClosureCompiler compiler{options};
+  if (options.inputs) {
+    compiler.BindInputs(*options.inputs);
+  }
+  return compiler.CompileAsValue(graph, GetTermType(graph));
+}
+
+}  // namespace magl::executer
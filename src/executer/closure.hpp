@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+
+#include <executer/context.hpp>
+#include <executer/type-profile.hpp>
+#include <parser/terms/input-schema.hpp>
+#include <parser/terms/semantic-graph.hpp>
+#include <value/value.hpp>
+
+namespace magl::executer {
+
+// Closure backend: the semantic graph is compiled to nested closures that are
+// typed by the C++ representation of values (int64_t, std::string,
+// value::ObjectValue, ...). Values are passed by C++ return values instead of
+// ValueHolders, so no reinterpretation of holders is needed.
+//
+// Each node is a separate std::function, so the compiler does not inline a
+// node into its parent. The only exception is arithmetic on Int and Float:
+// its constant and input operands are read inline. Other operands are still
+// called through their closures.
+
+/// State of a single evaluation that is passed to each closure
+struct Frame {
+  const EvaluationContext* context;
+};
+
+template <typename T>
+using Closure = std::function<T(Frame&)>;
+
+/// Returns a reference to a value that stays valid for the rest of the
+/// evaluation: a variable, an item of a container, etc.
+template <typename T>
+using RefClosure = std::function<const T&(Frame&)>;
+
+using CompiledClosure = Closure<value::Value>;
+
+struct ClosureOptions {
+  // Inputs the graph is compiled with, read from Frame::context
+  const parser::terms::InputSchema* inputs = nullptr;
+  // Records runtime types of values of type Any. Keys are terms of the
+  // compiled graph
+  TypeProfile* record_profile = nullptr;
+  // Specializes arithmetic on Any on the types in the profile: monomorphic
+  // subtrees are evaluated unboxed, and the values of type Any they read are
+  // guarded. A failed guard throws DeoptimizationError
+  const TypeProfile* speculate = nullptr;
+};
+
+/// Throws functions::UnsupportedType if a term is not supported by the closure
+/// backend
+CompiledClosure CompileClosure(const parser::terms::SemanticGraph& graph,
+                               const ClosureOptions& options = {});
+
+}  // namespace magl::executer
@@ -0,0 +1,180 @@
+#include <executer/common-subterms.hpp>
+
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <binary/encoder.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+using namespace parser::terms;
+
+constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+/// Interned structure of a term
+struct Subterm {
+  size_t id;
+  // 1 + the depth of the outermost binder whose variable the term reads, 0 for
+  // a variable that is not bound in the graph, kNone if it reads none. The
+  // term is closed if it is deeper than the binders in its scope
+  size_t outermost_binder = kNone;
+};
+
+/// Occurrences of a class of equal closed applications
+struct Occurrences {
+  std::vector<const ApplicationTerm*> terms;
+  // Class of the closed application the occurrences are directly nested in,
+  // kNone if they are not all nested in one of the same class
+  std::optional<size_t> parent;
+};
+
+class FindCommonSubtermsVisitor : public boost::static_visitor<Subterm> {
+ public:
+  explicit FindCommonSubtermsVisitor(size_t inputs_count)
+      : inputs_count_(inputs_count) {}
+
+  Subterm operator()(const VariableTerm& t) {
+    const auto find_binder =
+        std::find(binders_.rbegin(), binders_.rend(), t.uid);
+    if (find_binder != binders_.rend()) {
+      // De Bruijn index: equal terms bind their variables at the same distance
+      const size_t index = find_binder - binders_.rbegin();
+      return {.id = Intern(std::format("B{}", index)),
+              .outermost_binder = binders_.size() - index};
+    }
+    if (t.uid < inputs_count_) {
+      return {.id = Intern(std::format("I{}", t.uid))};
+    }
+    return {.id = Intern(std::format("U{}", t.uid)), .outermost_binder = 0};
+  }
+
+  Subterm operator()(const LambdaTerm& t) {
+    binders_.push_back(t.argument.uid);
+    const Subterm body = boost::apply_visitor(*this, t.body);
+    binders_.pop_back();
+    return {
+        .id = Intern(std::format("L{}|{}", functions::ToString(t.type),
+                                 body.id)),
+        .outermost_binder = body.outermost_binder,
+    };
+  }
+
+  Subterm operator()(const LetTerm& t) {
+    const Subterm definition = boost::apply_visitor(*this, t.definition);
+    binders_.push_back(t.variable.uid);
+    const Subterm body = boost::apply_visitor(*this, t.body);
+    binders_.pop_back();
+    return {
+        .id = Intern(std::format("T{}|{}|{}", functions::ToString(t.type),
+                                 definition.id, body.id)),
+        .outermost_binder =
+            std::min(definition.outermost_binder, body.outermost_binder),
+    };
+  }
+
+  Subterm operator()(const ApplicationTerm& t) {
+    nested_.emplace_back();
+    const Subterm executable = boost::apply_visitor(*this, t.executable);
+    std::string key = std::format("A{}|{}", functions::ToString(t.type),
+                                  executable.id);
+    size_t outermost_binder = executable.outermost_binder;
+    for (const Term& argument : t.arguments) {
+      const Subterm arg = boost::apply_visitor(*this, argument);
+      key += std::format("|{}", arg.id);
+      outermost_binder = std::min(outermost_binder, arg.outermost_binder);
+    }
+    const Subterm result{.id = Intern(std::move(key)),
+                         .outermost_binder = outermost_binder};
+
+    const std::vector<size_t> nested = std::move(nested_.back());
+    nested_.pop_back();
+    const bool closed = outermost_binder > binders_.size();
+    for (size_t id : nested) {
+      SetParent(id, closed ? result.id : kNone);
+    }
+    if (closed) {
+      occurrences_[result.id].terms.push_back(&t);
+      if (nested_.empty()) {
+        SetParent(result.id, kNone);
+      } else {
+        nested_.back().push_back(result.id);
+      }
+    }
+    return result;
+  }
+
+  Subterm operator()(const FunctionTerm& t) {
+    return {.id = Intern(std::format("F{}|{}", t.name,
+                                     functions::ToString(t.type)))};
+  }
+
+  Subterm operator()(const ValueTerm& t) {
+    std::string key = std::format("V{}|", functions::ToString(t.type));
+    try {
+      binary::Encode(t.value, &key);
+    } catch (const std::invalid_argument&) {
+      // A lambda value is equal only to itself
+      key += std::format("#{}", static_cast<const void*>(&t));
+    }
+    return {.id = Intern(std::move(key))};
+  }
+
+  CommonSubterms GetResult() && {
+    CommonSubterms result;
+    for (const auto& [id, occurrences] : occurrences_) {
+      if (occurrences.terms.size() < 2) {
+        continue;
+      }
+      // Evaluated once with each occurrence of the parent anyway
+      if (occurrences.parent != kNone &&
+          occurrences_.at(*occurrences.parent).terms.size() ==
+              occurrences.terms.size()) {
+        continue;
+      }
+      for (const ApplicationTerm* term : occurrences.terms) {
+        result.emplace(term, id);
+      }
+    }
+    return result;
+  }
+
+ private:
+  size_t Intern(std::string key) {
+    return ids_.try_emplace(std::move(key), ids_.size()).first->second;
+  }
+
+  void SetParent(size_t id, size_t parent) {
+    std::optional<size_t>& current = occurrences_.at(id).parent;
+    current = !current || *current == parent ? parent : kNone;
+  }
+
+ private:
+  const size_t inputs_count_;
+  std::unordered_map<std::string, size_t> ids_;
+  // Uids of the variables in scope, the innermost last
+  std::vector<size_t> binders_;
+  // Classes of the closed applications directly nested in each application
+  // being visited
+  std::vector<std::vector<size_t>> nested_;
+  std::unordered_map<size_t, Occurrences> occurrences_;
+};
+
+}  // namespace
+
+CommonSubterms FindCommonSubterms(
+    std::span<const parser::terms::SemanticGraph> graphs,
+    size_t inputs_count) {
+  FindCommonSubtermsVisitor visitor{inputs_count};
+  for (const SemanticGraph& graph : graphs) {
+    boost::apply_visitor(visitor, graph);
+  }
+  return std::move(visitor).GetResult();
+}
+
+}  // namespace magl::executer
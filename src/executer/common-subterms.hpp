@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+
+#include <parser/terms/semantic-graph.hpp>
+
+namespace magl::executer {
+
+/// Class of equal applications by each of its occurrences
+using CommonSubterms =
+    std::unordered_map<const parser::terms::ApplicationTerm*, size_t>;
+
+/// Finds applications that occur more than once in `graphs`, which share
+/// their first `inputs_count` inputs. Applications are equal if they are equal
+/// up to the uids of the variables they bind, and only the ones that read no
+/// variables bound outside of them are considered: their value is the same
+/// wherever they occur during an evaluation. An application is left out if
+/// all its occurrences are within the occurrences of another common one
+CommonSubterms FindCommonSubterms(
+    std::span<const parser::terms::SemanticGraph> graphs, size_t inputs_count);
+
+}  // namespace magl::executer
@@ -0,0 +1,100 @@
+#include <executer/constant-folding.hpp>
+
+#include <exception>
+#include <type_traits>
+
+#include <executer/expression.hpp>
+#include <functions/utils/value-type.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+using parser::terms::ApplicationTerm;
+using parser::terms::FunctionTerm;
+using parser::terms::LambdaTerm;
+using parser::terms::LetTerm;
+using parser::terms::Term;
+using parser::terms::ValueTerm;
+using parser::terms::VariableTerm;
+
+/// Whether values of the type can be stored in a ValueTerm
+bool IsFoldable(const functions::Type& type) {
+  try {
+    return functions::utils::VisitValueType(type, [](auto tag) {
+      using V = typename decltype(tag)::type;
+      return !std::is_same_v<V, value::LambdaValue>;
+    });
+  } catch (const functions::UnsupportedType&) {
+    // Unresolved type
+    return false;
+  }
+}
+
+class FoldConstantsVisitor : public boost::static_visitor<Term> {
+ public:
+  FoldConstantsVisitor() = default;
+
+  Term operator()(const VariableTerm& t) const { return t; }
+
+  Term operator()(const FunctionTerm& t) const { return t; }
+
+  Term operator()(const ValueTerm& t) const { return t; }
+
+  Term operator()(const LambdaTerm& t) const {
+    return LambdaTerm{
+        .argument = t.argument,
+        .body = boost::apply_visitor(*this, t.body),
+        .type = t.type,
+    };
+  }
+
+  Term operator()(const LetTerm& t) const {
+    return LetTerm{
+        .variable = t.variable,
+        .definition = boost::apply_visitor(*this, t.definition),
+        .body = boost::apply_visitor(*this, t.body),
+        .type = t.type,
+    };
+  }
+
+  Term operator()(const ApplicationTerm& t) const {
+    ApplicationTerm result{
+        .executable = boost::apply_visitor(*this, t.executable),
+        .arguments = {},
+        .type = t.type,
+    };
+
+    bool all_constant = true;
+    result.arguments.reserve(t.arguments.size());
+    for (const Term& argument : t.arguments) {
+      result.arguments.push_back(boost::apply_visitor(*this, argument));
+      all_constant =
+          all_constant && boost::get<ValueTerm>(&result.arguments.back());
+    }
+
+    if (!all_constant || !boost::get<FunctionTerm>(&result.executable) ||
+        !IsFoldable(result.type)) {
+      return result;
+    }
+
+    try {
+      Expression constant{Term{result}};
+      return ValueTerm{
+          .value = constant.Evaluate({}),
+          .type = result.type,
+      };
+    } catch (const std::exception&) {
+      return result;
+    }
+  }
+};
+
+}  // namespace
+
+parser::terms::SemanticGraph FoldConstants(
+    const parser::terms::SemanticGraph& graph) {
+  return boost::apply_visitor(FoldConstantsVisitor{}, graph);
+}
+
+}  // namespace magl::executer
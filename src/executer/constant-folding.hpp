@@ -0,0 +1,14 @@
+#pragma once
+
+#include <parser/terms/semantic-graph.hpp>
+
+namespace magl::executer {
+
+/// Replaces applications of library functions to constants with their values,
+/// bottom-up: Add(2, Multiply(3, 4)) -> 14, Insert({}, "a", 1) -> {"a": 1}.
+/// Applications that fail (e.g. VarMapAt of a missing key) are left as is, so
+/// the error is still reported by the evaluation.
+parser::terms::SemanticGraph FoldConstants(
+    const parser::terms::SemanticGraph& graph);
+
+}  // namespace magl::executer
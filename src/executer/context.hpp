@@ -1,7 +1,44 @@
 #pragma once
 
+#include <cstddef>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include <executer/budget.hpp>
+#include <value/value.hpp>
+
 namespace magl::executer {
 
-struct EvaluationContext {};
+struct EvaluationContext {
+  /// Values of the inputs of the expression in the order of its InputSchema
+  /// (see parser/terms/input-schema.hpp). Values are bound by pointer and must
+  /// outlive the evaluation
+  std::span<const value::Value* const> inputs;
+  /// Limits of the evaluation, which throws BudgetExceeded when it runs out.
+  /// Must outlive the evaluation
+  const EvaluationBudget* budget = nullptr;
+};
+
+/// Returns input `i` represented as V. Throws std::invalid_argument if the
+/// input is not bound or has another representation
+template <typename V>
+const V& GetInput(const EvaluationContext& context, size_t i) {
+  if (i >= context.inputs.size() || !context.inputs[i]) {
+    throw std::invalid_argument(std::format("Input #{} is not bound.", i));
+  }
+  const value::Value& input = *context.inputs[i];
+  if constexpr (std::is_same_v<V, value::Value>) {
+    return input;
+  } else {
+    const V* typed = boost::get<V>(&input);
+    if (!typed) {
+      throw std::invalid_argument(
+          std::format("Input #{} does not match its declared type.", i));
+    }
+    return *typed;
+  }
+}
 
 }  // namespace magl::executer
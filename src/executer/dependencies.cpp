@@ -0,0 +1,171 @@
+#include <executer/dependencies.hpp>
+
+#include <algorithm>
+#include <optional>
+
+namespace magl::executer {
+
+namespace {
+
+using namespace parser::terms;
+
+bool IsPrefix(const FieldPath& prefix, const FieldPath& path) {
+  return prefix.size() <= path.size() &&
+         std::equal(prefix.begin(), prefix.end(), path.begin());
+}
+
+/// Union of `from` and `to`, which is not an access then
+void Merge(Dependencies from, Dependencies* to) {
+  to->is_access = false;
+  to->paths.insert(to->paths.end(), std::make_move_iterator(from.paths.begin()),
+                   std::make_move_iterator(from.paths.end()));
+  std::sort(to->paths.begin(), to->paths.end());
+  // NB: A prefix is sorted before the paths it covers
+  std::vector<InputPath> pruned;
+  for (InputPath& path : to->paths) {
+    if (pruned.empty() || pruned.back().input != path.input ||
+        !IsPrefix(pruned.back().path, path.path)) {
+      pruned.push_back(std::move(path));
+    }
+  }
+  to->paths = std::move(pruned);
+
+  to->lambda_arguments.insert(to->lambda_arguments.end(),
+                              from.lambda_arguments.begin(),
+                              from.lambda_arguments.end());
+  std::sort(to->lambda_arguments.begin(), to->lambda_arguments.end());
+  to->lambda_arguments.erase(std::unique(to->lambda_arguments.begin(),
+                                         to->lambda_arguments.end()),
+                             to->lambda_arguments.end());
+}
+
+class CollectDependenciesVisitor
+    : public boost::static_visitor<Dependencies> {
+ public:
+  explicit CollectDependenciesVisitor(size_t inputs_count)
+      : inputs_count_(inputs_count) {}
+
+  Dependencies operator()(const VariableTerm& t) {
+    const auto find_variable = variables_.find(t.uid);
+    if (find_variable != variables_.end()) {
+      return find_variable->second;
+    }
+    if (t.uid < inputs_count_) {
+      return {.paths = {{.input = t.uid}}, .is_access = true};
+    }
+    // Unknown variables are assumed to change from call to call
+    return {.lambda_arguments = {t.uid}};
+  }
+
+  Dependencies operator()(const LambdaTerm& t) {
+    const ScopedVariable argument{
+        this, t.argument.uid, {.lambda_arguments = {t.argument.uid}}};
+    Dependencies result = boost::apply_visitor(*this, t.body);
+    // The lambda itself is the same whatever its argument is
+    std::erase(result.lambda_arguments, t.argument.uid);
+    result.is_access = false;
+    return result;
+  }
+
+  Dependencies operator()(const LetTerm& t) {
+    // The variable is an alias: its uses read what the definition reads
+    const ScopedVariable variable{
+        this, t.variable.uid, boost::apply_visitor(*this, t.definition)};
+    return boost::apply_visitor(*this, t.body);
+  }
+
+  Dependencies operator()(const ApplicationTerm& t) {
+    Dependencies result = GetApplicationDependencies(t);
+    result_.insert_or_assign(&t, result);
+    return result;
+  }
+
+  Dependencies operator()(const FunctionTerm&) { return {}; }
+  Dependencies operator()(const ValueTerm&) { return {}; }
+
+  DependencyMap GetResult() && { return std::move(result_); }
+
+ private:
+  /// Binds a variable for the lifetime of the scope
+  class ScopedVariable {
+   public:
+    ScopedVariable(CollectDependenciesVisitor* visitor, size_t uid,
+                   Dependencies dependencies)
+        : visitor_(visitor), uid_(uid) {
+      const auto find_variable = visitor_->variables_.find(uid_);
+      if (find_variable != visitor_->variables_.end()) {
+        old_dependencies_ = std::move(find_variable->second);
+      }
+      visitor_->variables_.insert_or_assign(uid_, std::move(dependencies));
+    }
+
+    ~ScopedVariable() {
+      if (old_dependencies_) {
+        visitor_->variables_.insert_or_assign(uid_,
+                                              std::move(*old_dependencies_));
+      } else {
+        visitor_->variables_.erase(uid_);
+      }
+    }
+
+   private:
+    CollectDependenciesVisitor* visitor_;
+    const size_t uid_;
+    std::optional<Dependencies> old_dependencies_;
+  };
+
+  Dependencies GetApplicationDependencies(const ApplicationTerm& t) {
+    const auto* function = boost::get<FunctionTerm>(&t.executable);
+    if (function && function->name == "GetVar" && t.arguments.size() == 1) {
+      return boost::apply_visitor(*this, t.arguments[0]);
+    }
+    if (function && function->name == "VarMapAt" && t.arguments.size() == 2) {
+      const auto* key = boost::get<ValueTerm>(&t.arguments[1]);
+      const auto* key_string =
+          key ? boost::get<value::StringValue>(&key->value) : nullptr;
+      if (key_string) {
+        Dependencies result = boost::apply_visitor(*this, t.arguments[0]);
+        if (result.is_access) {
+          result.paths.front().path.push_back(*key_string);
+        }
+        return result;
+      }
+    }
+
+    Dependencies result = boost::apply_visitor(*this, t.executable);
+    result.is_access = false;
+    for (const Term& argument : t.arguments) {
+      Merge(boost::apply_visitor(*this, argument), &result);
+    }
+    return result;
+  }
+
+ private:
+  const size_t inputs_count_;
+  std::unordered_map<size_t, Dependencies> variables_;
+  DependencyMap result_;
+};
+
+}  // namespace
+
+bool Overlap(const InputPath& lhs, const InputPath& rhs) {
+  return lhs.input == rhs.input &&
+         (IsPrefix(lhs.path, rhs.path) || IsPrefix(rhs.path, lhs.path));
+}
+
+bool Dependencies::DependsOn(std::span<const InputPath> changed) const {
+  return std::any_of(paths.begin(), paths.end(), [&](const InputPath& path) {
+    return std::any_of(
+        changed.begin(), changed.end(),
+        [&](const InputPath& change) { return Overlap(path, change); });
+  });
+}
+
+DependencyMap CollectDependencies(const parser::terms::SemanticGraph& graph,
+                                  size_t inputs_count) {
+  CollectDependenciesVisitor visitor{inputs_count};
+  boost::apply_visitor(visitor, graph);
+  return std::move(visitor).GetResult();
+}
+
+}  // namespace magl::executer
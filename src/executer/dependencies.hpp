@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <parser/terms/field-access.hpp>
+#include <parser/terms/semantic-graph.hpp>
+
+namespace magl::executer {
+
+/// Field of input i (see parser/terms/input-schema.hpp), an empty path stands
+/// for the whole input
+struct InputPath {
+  size_t input = 0;
+  parser::terms::FieldPath path{};
+
+  bool operator==(const InputPath&) const = default;
+  auto operator<=>(const InputPath&) const = default;
+};
+
+/// Whether one of the paths is a prefix of the other, i.e. a change at one of
+/// them may change the value at the other
+bool Overlap(const InputPath& lhs, const InputPath& rhs);
+
+/// What the value of a term is computed from
+struct Dependencies {
+  // Input fields the term reads. Sorted, none is a prefix of another
+  std::vector<InputPath> paths{};
+  // Arguments of enclosing lambdas the term reads, which change from call to
+  // call. A term that reads none of them is invariant: its value is the same
+  // during an evaluation and between evaluations that do not change its paths
+  std::vector<size_t> lambda_arguments{};
+  // Whether the value is the field at the only path itself, so that VarMapAt
+  // with a constant key extends the path
+  bool is_access = false;
+
+  bool IsInvariant() const { return lambda_arguments.empty(); }
+
+  /// Whether a change at one of `changed` may change the value
+  bool DependsOn(std::span<const InputPath> changed) const;
+};
+
+using DependencyMap =
+    std::unordered_map<const parser::terms::ApplicationTerm*, Dependencies>;
+
+/// Returns the dependencies of each application of `graph` on its first
+/// `inputs_count` inputs. Accesses are followed through VarMapAt with constant
+/// keys, GetVar and let variables as in CollectFieldPaths
+DependencyMap CollectDependencies(const parser::terms::SemanticGraph& graph,
+                                  size_t inputs_count);
+
+}  // namespace magl::executer
@@ -2,20 +2,29 @@
 
 namespace magl::executer {
 
+functions::ValueHolder EvaluateTerm(EvaluationTree& t) {
+  functions::ValueHolder to;
+  EvaluateTerm(t, &to);
+  return to;
+}
+
 // TODO: Optimize execution
 // * consider avoiding recursion
 // * consider reusing ArgsContainer considering cache hits
-functions::ValueHolder EvaluateTerm(EvaluationTree& t) {
+void EvaluateTerm(EvaluationTree& t, functions::ValueHolder* to) {
   functions::ArgsContainer args;
-  functions::ValueHolder to;
+  EvaluateArgs(t, &args);
+  t.implementation->Evaluate(&args, to);
+}
 
+void EvaluateArgs(EvaluationTree& t, functions::ArgsContainer* args) {
   for (size_t i = 0; i < t.args.size(); ++i) {
-    args[i] = EvaluateTerm(t.args[i]);
+    if (t.lazy_args[i]) {
+      *reinterpret_cast<EvaluationTree**>(&(*args)[i]) = &t.args[i];
+      continue;
+    }
+    EvaluateTerm(t.args[i], &(*args)[i]);
   }
-
-  t.implementation->Evaluate(&args, &to);
-
-  return to;
 }
 
 }  // namespace magl::executer
@@ -7,4 +7,11 @@ namespace magl::executer {
 
 functions::ValueHolder EvaluateTerm(EvaluationTree& t);
 
+/// Evaluates a term directly into `to` without copying the result holder
+void EvaluateTerm(EvaluationTree& t, functions::ValueHolder* to);
+
+/// Evaluates the arguments of a term (or makes thunks of the lazy ones) for its
+/// implementation
+void EvaluateArgs(EvaluationTree& t, functions::ArgsContainer* args);
+
 }  // namespace magl::executer
@@ -0,0 +1,324 @@
+#include <executer/explain.hpp>
+
+#include <format>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+
+#include <boost/core/demangle.hpp>
+
+#include <functions/library/apply.hpp>
+#include <functions/library/borrow.hpp>
+#include <functions/library/get-value.hpp>
+#include <functions/library/lambda.hpp>
+#include <functions/library/let.hpp>
+#include <json/writer.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+using functions::IEvaluatable;
+
+template <typename T>
+std::string Demangle() {
+  return boost::core::demangle(typeid(T).name());
+}
+
+/// Replaces `from` where it is a whole template argument
+void ReplaceTemplateArgument(std::string* name, std::string_view from,
+                             std::string_view to) {
+  for (size_t pos = name->find(from); pos != std::string::npos;
+       pos = name->find(from, pos)) {
+    const size_t end = pos + from.size();
+    const bool is_argument =
+        pos > 0 && ((*name)[pos - 1] == '<' || (*name)[pos - 1] == ' ') &&
+        end < name->size() &&
+        ((*name)[end] == '>' || (*name)[end] == ',' || (*name)[end] == ' ');
+    if (is_argument) {
+      name->replace(pos, from.size(), to);
+      pos += to.size();
+    } else {
+      ++pos;
+    }
+  }
+}
+
+void ReplaceAll(std::string* name, std::string_view from,
+                std::string_view to = {}) {
+  for (size_t pos = name->find(from); pos != std::string::npos;
+       pos = name->find(from, pos + to.size())) {
+    name->replace(pos, from.size(), to);
+  }
+}
+
+/// Returns the name of the class of `e` with value types named as in MAGL
+std::string GetKernelName(const IEvaluatable& e) {
+  // NB: Containers go first, their names include the names of the items
+  static const std::vector<std::pair<std::string, std::string>> kValueTypes =
+      {
+          {Demangle<value::ObjectValue>(), "Object"},
+          {Demangle<value::ArrayValue>(), "List"},
+          {Demangle<value::Value>(), "Any"},
+          {Demangle<value::IntegerValue>(), "Int"},
+          {Demangle<value::FloatValue>(), "Float"},
+          {Demangle<value::BoolValue>(), "Bool"},
+          {Demangle<value::StringValue>(), "String"},
+          {Demangle<value::NullValue>(), "Null"},
+          {Demangle<value::LambdaValue>(), "Lambda"},
+      };
+
+  std::string result = boost::core::demangle(typeid(e).name());
+  for (const auto& [from, to] : kValueTypes) {
+    ReplaceTemplateArgument(&result, from, to);
+  }
+  for (const std::string_view prefix :
+       {"magl::functions::library::", "magl::functions::", "magl::executer::",
+        "magl::"}) {
+    ReplaceAll(&result, prefix);
+  }
+  // Closes the template argument lists left as "List >" by the replacements
+  ReplaceAll(&result, " >", ">");
+  return result;
+}
+
+/// Returns the number of items of a container literal, 0 for other nodes
+size_t GetLiteralItems(const IEvaluatable& e) {
+  using functions::library::GetValue;
+  const value::Value* boxed = nullptr;
+  if (const auto* any = dynamic_cast<const GetValue<value::Value>*>(&e)) {
+    boxed = &any->GetConstant();
+  }
+  if (const auto* list =
+          dynamic_cast<const GetValue<value::ArrayValue>*>(&e)) {
+    return list->GetConstant().size();
+  }
+  if (const auto* object =
+          dynamic_cast<const GetValue<value::ObjectValue>*>(&e)) {
+    return object->GetConstant().size();
+  }
+  if (const auto* list =
+          boxed ? boost::get<value::ArrayValue>(boxed) : nullptr) {
+    return list->size();
+  }
+  if (const auto* object =
+          boxed ? boost::get<value::ObjectValue>(boxed) : nullptr) {
+    return object->size();
+  }
+  return 0;
+}
+
+PlanNode ExplainEvaluatable(const IEvaluatable& e, const PlanInfo& info);
+
+PlanNode ExplainNested(const EvaluationTree& t, std::string role,
+                       const PlanInfo& info, double calls = 1) {
+  PlanNode result = ExplainTree(t, info);
+  result.role = std::move(role);
+  result.cost *= calls;
+  return result;
+}
+
+/// Adds the trees owned by `e` (lambda and let bodies) as its children
+void AddNested(const IEvaluatable& e, const PlanInfo& info, PlanNode* node) {
+  if (const auto* lambda_value =
+          dynamic_cast<const functions::library::GetLambdaValue*>(&e)) {
+    node->children.push_back(
+        ExplainEvaluatable(*lambda_value->GetEvaluatable(), info));
+    node->children.back().role = "function";
+  } else if (const auto* apply =
+                 dynamic_cast<const functions::library::Apply*>(&e)) {
+    node->children.push_back(ExplainEvaluatable(*apply->GetApplied(), info));
+    node->children.back().role = "function";
+  } else if (const auto* lambda =
+                 dynamic_cast<const functions::library::Lambda*>(&e)) {
+    node->children.push_back(ExplainNested(*lambda->GetBody(), "body", info,
+                                           PlanNode::kAssumedLambdaCalls));
+  } else if (const auto* let =
+                 dynamic_cast<const functions::library::Let*>(&e)) {
+    node->children.push_back(
+        ExplainNested(*let->GetDefinition(), "definition", info));
+    node->children.push_back(ExplainNested(*let->GetBody(), "body", info));
+  } else if (const auto* apply_let =
+                 dynamic_cast<const functions::library::ApplyLet*>(&e)) {
+    node->children.push_back(
+        ExplainNested(*apply_let->GetDefinition(), "definition", info));
+    node->children.push_back(ExplainEvaluatable(*apply_let->GetBody(), info));
+    node->children.back().role = "function";
+  }
+}
+
+PlanNode ExplainEvaluatable(const IEvaluatable& e, const PlanInfo& info) {
+  PlanNode result{.kernel = GetKernelName(e)};
+  const auto find_info = info.find(&e);
+  if (find_info != info.end()) {
+    result.info = find_info->second;
+  }
+
+  // Values or lists of values that are boxed in Any
+  const functions::Type* type = result.info ? &result.info->type : nullptr;
+  if (const auto* list = type ? boost::get<functions::ListType>(type) : nullptr) {
+    type = &list->value_type;
+  }
+  const bool any_type = type && boost::get<functions::AnyType>(type);
+  if (any_type || result.kernel.find("Any") != std::string::npos) {
+    result.warnings.push_back("generic Any path");
+  }
+  const size_t literal_items = GetLiteralItems(e);
+  if (literal_items > 0) {
+    result.warnings.push_back(
+        std::format("copies a literal of {} items per call", literal_items));
+  }
+  if (result.kernel.starts_with("CopyBorrowedImpl")) {
+    result.warnings.push_back("copies a borrowed value");
+  }
+
+  result.cost = 1 + static_cast<double>(literal_items);
+  AddNested(e, info, &result);
+  for (const PlanNode& child : result.children) {
+    result.cost += child.cost;
+  }
+  return result;
+}
+
+std::string FormatType(const PlanNode& node) {
+  return node.info ? functions::ToString(node.info->type) : std::string{};
+}
+
+void RenderText(const PlanNode& node, size_t depth, std::string* to) {
+  to->append(2 * depth, ' ');
+  if (!node.role.empty()) {
+    *to += std::format("{}: ", node.role);
+  }
+  *to += node.kernel;
+  if (node.info) {
+    *to += std::format(" :: {} ({}{})", FormatType(node), node.info->term,
+                       node.info->borrowed ? ", borrowed" : "");
+  }
+  *to += std::format(" cost={:.0f}", node.cost);
+  std::vector<std::string> notes;
+  if (node.info) {
+    notes = node.info->notes;
+  }
+  for (const std::string& warning : node.warnings) {
+    notes.push_back("warning: " + warning);
+  }
+  for (size_t i = 0; i < notes.size(); ++i) {
+    *to += std::format("{}{}", i == 0 ? " [" : "; ", notes[i]);
+  }
+  *to += notes.empty() ? "\n" : "]\n";
+  for (const PlanNode& child : node.children) {
+    RenderText(child, depth + 1, to);
+  }
+}
+
+void WriteStrings(std::string_view key, const std::vector<std::string>& items,
+                  json::Writer* writer) {
+  writer->Key(key);
+  writer->BeginArray();
+  for (const std::string& item : items) {
+    writer->WriteString(item);
+  }
+  writer->EndArray();
+}
+
+void RenderJson(const PlanNode& node, json::Writer* writer) {
+  writer->BeginObject();
+  writer->Key("kernel");
+  writer->WriteString(node.kernel);
+  if (!node.role.empty()) {
+    writer->Key("role");
+    writer->WriteString(node.role);
+  }
+  if (node.info) {
+    writer->Key("term");
+    writer->WriteString(node.info->term);
+    writer->Key("type");
+    writer->WriteString(FormatType(node));
+    writer->Key("borrowed");
+    writer->Write(node.info->borrowed);
+    WriteStrings("notes", node.info->notes, writer);
+  }
+  WriteStrings("warnings", node.warnings, writer);
+  writer->Key("cost");
+  writer->Write(node.cost);
+  writer->Key("children");
+  writer->BeginArray();
+  for (const PlanNode& child : node.children) {
+    RenderJson(child, writer);
+  }
+  writer->EndArray();
+  writer->EndObject();
+}
+
+std::string EscapeDot(std::string_view text) {
+  std::string result;
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+    }
+    result.push_back(c);
+  }
+  return result;
+}
+
+/// Returns the id of the node
+size_t RenderDot(const PlanNode& node, size_t* next_id, std::string* to) {
+  const size_t id = (*next_id)++;
+  std::string label = EscapeDot(node.kernel);
+  if (node.info) {
+    label += std::format("\\n{} :: {}", EscapeDot(node.info->term),
+                         EscapeDot(FormatType(node)));
+    for (const std::string& note : node.info->notes) {
+      label += "\\n" + EscapeDot(note);
+    }
+  }
+  label += std::format("\\ncost={:.0f}", node.cost);
+  for (const std::string& warning : node.warnings) {
+    label += "\\n" + EscapeDot(warning);
+  }
+  *to += std::format("  n{} [label=\"{}\"{}];\n", id, label,
+                     node.warnings.empty() ? "" : ", color=red");
+  for (const PlanNode& child : node.children) {
+    const size_t child_id = RenderDot(child, next_id, to);
+    *to += std::format("  n{} -> n{} [label=\"{}\"];\n", id, child_id,
+                       EscapeDot(child.role));
+  }
+  return id;
+}
+
+}  // namespace
+
+PlanNode ExplainTree(const EvaluationTree& t, const PlanInfo& info) {
+  PlanNode result = ExplainEvaluatable(*t.implementation, info);
+  for (size_t i = 0; i < t.args.size(); ++i) {
+    PlanNode arg = ExplainTree(t.args[i], info);
+    arg.role = std::format("{}arg {}", t.lazy_args[i] ? "lazy " : "", i);
+    result.cost += arg.cost;
+    result.children.push_back(std::move(arg));
+  }
+  return result;
+}
+
+std::string RenderPlan(const PlanNode& plan, ExplainFormat format) {
+  std::string result;
+  switch (format) {
+    case ExplainFormat::kText:
+      RenderText(plan, 0, &result);
+      break;
+    case ExplainFormat::kJson: {
+      json::Writer writer{&result};
+      RenderJson(plan, &writer);
+      break;
+    }
+    case ExplainFormat::kDot: {
+      result = "digraph plan {\n  node [shape=box];\n";
+      size_t next_id = 0;
+      RenderDot(plan, &next_id, &result);
+      result += "}\n";
+      break;
+    }
+  }
+  return result;
+}
+
+}  // namespace magl::executer
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <executer/term.hpp>
+#include <functions/evaluatable.hpp>
+#include <functions/type.hpp>
+
+namespace magl::executer {
+
+/// What the compiler knew about a node of an EvaluationTree
+struct NodeInfo {
+  // Term the node is compiled from: a function name, "lambda", "let",
+  // "variable" or "constant"
+  std::string term;
+  functions::Type type;
+  // Whether the node returns a borrowed value (`const V*`)
+  bool borrowed = false;
+  // E.g. a constant argument bound at compile time or a fusion
+  std::vector<std::string> notes;
+};
+
+/// Nodes of an EvaluationTree by their evaluatable, see Expression::Explain
+using PlanInfo = std::unordered_map<const functions::IEvaluatable*, NodeInfo>;
+
+enum class ExplainFormat {
+  kText = 0,
+  kJson = 1,
+  kDot = 2,
+};
+
+/// Node of an explained plan
+struct PlanNode {
+  // Specialization of the evaluatable, e.g. AddIntImpl or MapImpl<Int, Int>
+  std::string kernel;
+  // How the parent reaches the node, e.g. "arg 1", "lazy arg 0", "body"
+  std::string role{};
+  // Not set for nodes added by the lowering itself, e.g. copies of borrowed
+  // values
+  std::optional<NodeInfo> info{};
+  // Generic Any paths, literals copied per call and the like
+  std::vector<std::string> warnings{};
+  // Estimated node evaluations per evaluation of the plan with the children.
+  // A lambda body is assumed to be called kAssumedLambdaCalls times, a literal
+  // costs a copy of each of its items
+  double cost = 0;
+  std::vector<PlanNode> children{};
+
+  static constexpr double kAssumedLambdaCalls = 10;
+};
+
+/// Returns the plan of `t` with the nested trees of lambdas and lets
+PlanNode ExplainTree(const EvaluationTree& t, const PlanInfo& info);
+
+/// Renders a plan as indented text, a JSON object or a Graphviz digraph
+std::string RenderPlan(const PlanNode& plan, ExplainFormat format);
+
+}  // namespace magl::executer
@@ -1,15 +1,24 @@
 #include <executer/expression.hpp>
 
+#include <chrono>
 #include <format>
 #include <iostream>
+#include <optional>
+#include <type_traits>
 
 #include <executer/evaluate.hpp>
+#include <executer/peephole.hpp>
 #include <functions/include.hpp>
 #include <functions/library/apply.hpp>
+#include <functions/library/borrow.hpp>
 #include <functions/library/fetch-variable.hpp>
 #include <functions/library/get-value.hpp>
 #include <functions/library/lambda.hpp>
+#include <functions/library/let.hpp>
+#include <functions/library/mapped-var-map-at.hpp>
 #include <functions/library/pass.hpp>
+#include <functions/utils/value-type.hpp>
+#include <parser/parser.hpp>
 
 namespace magl::executer {
 
@@ -17,6 +26,85 @@ using namespace parser;
 
 namespace {
 
+struct VariableLocation {
+  const functions::ValueHolder* holder;
+  /// The holder keeps a borrowed value (`const V*`) instead of V
+  bool indirect = false;
+};
+
+using VariableLocations = std::unordered_map<size_t, VariableLocation>;
+
+/// Objects of the mapped inputs by the uid of their variables
+using MappedObjects = std::unordered_map<size_t, binary::ObjectView>;
+
+/// Binds a variable uid to a location for the lifetime of the scope and then
+/// restores the previous binding
+class ScopedVariableLocation {
+ public:
+  ScopedVariableLocation(VariableLocations* variables, size_t uid,
+                         VariableLocation location)
+      : variables_(variables), uid_(uid) {
+    const auto find_variable = variables_->find(uid_);
+    if (find_variable != variables_->end()) {
+      old_location_ = find_variable->second;
+    }
+    variables_->insert_or_assign(uid_, location);
+  }
+
+  ~ScopedVariableLocation() {
+    if (old_location_) {
+      variables_->insert_or_assign(uid_, old_location_.value());
+    } else {
+      variables_->erase(uid_);
+    }
+  }
+
+ private:
+  VariableLocations* variables_;
+  const size_t uid_;
+  std::optional<VariableLocation> old_location_;
+};
+
+/// Makes the location of a variable that holds values of `type`
+std::unique_ptr<functions::library::VariableSlot> MakeVariableSlot(
+    const functions::Type& type, bool borrowed = false) {
+  // Borrowed values are pointers, values of unresolved types are never bound
+  if (borrowed || boost::get<functions::TypeVariable>(&type)) {
+    return std::make_unique<functions::library::VariableSlot>(nullptr);
+  }
+  return std::make_unique<functions::library::VariableSlot>(
+      functions::utils::GetValueDestroyer(type),
+      functions::utils::GetValueRelocator(type));
+}
+
+/// Makes a term that evaluates to an owned value
+EvaluationTree Materialize(ExpressionData data) {
+  if (!data.borrowed) {
+    return std::move(data.term);
+  }
+
+  EvaluationTree result{
+      .args = {},
+      .implementation = functions::library::MakeCopyBorrowedImpl(data.type),
+  };
+  result.args.push_back(std::move(data.term));
+  return result;
+}
+
+/// Makes a term that evaluates to a borrowed value
+EvaluationTree Borrow(ExpressionData data) {
+  if (data.borrowed) {
+    return std::move(data.term);
+  }
+
+  EvaluationTree result{
+      .args = {},
+      .implementation = functions::library::MakeLendImpl(data.type),
+  };
+  result.args.push_back(std::move(data.term));
+  return result;
+}
+
 /// Turns a term that stands for lhs in an application into an evaluatable
 template <typename MakeExpressionVisitor>
 class MakeApplicationVisitor
@@ -27,13 +115,9 @@ class MakeApplicationVisitor
       : parent_(parent), type_(application_type) {}
 
   result_type operator()(const parser::terms::VariableTerm& t) {
-    const functions::FunctionType type =
-        boost::get<functions::FunctionType>(type_);
-    // TODO: Consider using single function fetch-and-apply. Will it improve
-    // performance?
+    // NB: Fused into a single fetch-and-apply by the peephole pass
     return std::make_unique<functions::library::Apply>(
-        std::make_unique<functions::library::FetchVariable>(
-            parent_->variables_.at(t.uid)));
+        parent_->MakeFetchVariable(t.uid));
   }
 
   result_type operator()(const parser::terms::ApplicationTerm& /*t*/) {
@@ -43,36 +127,33 @@ class MakeApplicationVisitor
   result_type operator()(const parser::terms::LambdaTerm& t) {
     // NB: Lambda recursion is prohibited
 
-    // Save old variable location
-    const std::optional<const functions::ValueHolder*> old_variable_location =
-        [this, &t]() -> std::optional<const functions::ValueHolder*> {
-      const auto find_variable = parent_->variables_.find(t.argument.uid);
-      if (find_variable == parent_->variables_.end()) {
-        return std::nullopt;
-      }
-      return find_variable->second;
-    }();
+    auto arg = MakeVariableSlot(t.argument.type);
+    const ScopedVariableLocation var{&parent_->variables_, t.argument.uid,
+                                     {.holder = arg->GetLocation()}};
 
-    // Update variable location
-    auto arg_holder = functions::library::Lambda::MakeVarHolder();
-    parent_->variables_[t.argument.uid] = arg_holder.get();
+    // Compile body. Lambda returns an owned value: borrowed values may point
+    // into the argument location which is overwritten by the next call
+    EvaluationTree compiled_body = parent_->Profile(
+        Materialize(boost::apply_visitor(*parent_, t.body)), t);
 
-    // Compile body
-    ExpressionData compiled_body_data = boost::apply_visitor(*parent_, t.body);
+    return std::make_unique<functions::library::Lambda>(
+        std::move(arg), std::move(compiled_body));
+  }
 
-    // Make lambda
-    std::unique_ptr<functions::library::Lambda> lambda =
-        std::make_unique<functions::library::Lambda>(
-            std::move(arg_holder), std::move(compiled_body_data.term));
+  result_type operator()(const parser::terms::LetTerm& t) {
+    // Compiled as an operand: the definition is evaluated on each application
+    ExpressionData definition = boost::apply_visitor(*parent_, t.definition);
 
-    // Revert variable location to its original value
-    if (old_variable_location) {
-      parent_->variables_[t.argument.uid] = old_variable_location.value();
-    } else {
-      parent_->variables_.erase(t.argument.uid);
-    }
+    auto var = MakeVariableSlot(definition.type, definition.borrowed);
+    const ScopedVariableLocation var_location{
+        &parent_->variables_, t.variable.uid,
+        {.holder = var->GetLocation(), .indirect = definition.borrowed}};
+
+    // The body stands for lhs of the same application
+    result_type body = boost::apply_visitor(*this, t.body);
 
-    return lambda;
+    return std::make_unique<functions::library::ApplyLet>(
+        std::move(var), std::move(definition.term), std::move(body));
   }
 
   result_type operator()(const parser::terms::FunctionTerm& t) {
@@ -101,90 +182,465 @@ class MakeApplicationVisitor
 
 class MakeExpressionVisitor : boost::static_visitor<ExpressionData> {
  public:
-  MakeExpressionVisitor(functions::FunctionsLibrary functions)
-      : functions_(std::move(functions)) {}
+  MakeExpressionVisitor(functions::FunctionsLibrary functions,
+                        VariableLocations inputs = {},
+                        MappedObjects mapped_inputs = {})
+      : functions_(std::move(functions)),
+        variables_(std::move(inputs)),
+        mapped_inputs_(std::move(mapped_inputs)) {}
+
+  /// Keeps results of invariant subtrees between evaluations: they are added
+  /// to `memoized` with their dependencies
+  void EnableMemoization(DependencyMap dependencies,
+                         std::vector<MemoizedTerm>* memoized) {
+    dependencies_ = std::move(dependencies);
+    memoized_ = memoized;
+  }
+
+  /// Compiles each class of `common` once: all its occurrences evaluate the
+  /// same memo, which is added to `shared`
+  void EnableSharing(CommonSubterms common, std::vector<SharedTerm>* shared) {
+    common_ = std::move(common);
+    shared_ = shared;
+  }
+
+  /// Records what is known about the nodes in `info`, see Expression::Explain
+  void EnablePlanInfo(PlanInfo* info) { plan_info_ = info; }
+
+  /// Counts the evaluations of applications and lambda bodies in `profiler`
+  void EnableProfiling(Profiler* profiler) { profiler_ = profiler; }
+
+  /// Counts the calls of the functions of applications in `metrics`
+  void EnableCallCounting(MetricsRegistry* metrics) { metrics_ = metrics; }
+
+  /// Memoizes the result of the whole graph
+  ExpressionData MemoizeResult(ExpressionData data,
+                               const parser::terms::Term& t) {
+    functions::Type type = data.type;
+    return {
+        .term = Memoize(Materialize(std::move(data)), type, t, nullptr),
+        .type = std::move(type),
+    };
+  }
 
   result_type operator()(const parser::terms::VariableTerm& t) {
-    const auto find_variable = variables_.find(t.uid);
-    if (find_variable == variables_.end()) {
-      throw std::runtime_error(
-          std::format("Variable mapping is not defined for uid={}", t.uid));
+    if (mapped_inputs_.contains(t.uid)) {
+      throw functions::UnsupportedType(std::format(
+          "Mapped input #{} can only be read with VarMapAt.", t.uid));
     }
-    return {
-        .term =
+    // Variables are always borrowed from their locations
+    return Note(
+        {
+            .term =
+                EvaluationTree{
+                    .args = {},
+                    .implementation = MakeFetchVariable(t.uid),
+                },
+            .type = t.type,
+            .borrowed = true,
+        },
+        "variable");
+  }
+
+  result_type operator()(const parser::terms::ApplicationTerm& t) {
+    if (std::optional<ExpressionData> shared = MakeShared(t)) {
+      return std::move(*shared);
+    }
+    ExpressionData result = MakeApplication(t);
+    result.term = CountCalls(Profile(std::move(result.term), t), t);
+    return result;
+  }
+
+  result_type operator()(const parser::terms::LambdaTerm& t) {
+    return Note(
+        {
+            .term =
+                {
+                    .args = {},
+                    .implementation =
+                        std::make_unique<functions::library::GetLambdaValue>(
+                            boost::apply_visitor(
+                                MakeApplicationVisitor{this, t.type},
+                                parser::terms::Term{t})),
+                },
+            .type = t.type,
+        },
+        "lambda");
+  }
+
+  result_type operator()(const parser::terms::LetTerm& t) {
+    // Compiled before the variable is bound: let is non-recursive
+    ExpressionData definition = boost::apply_visitor(*this, t.definition);
+
+    // A borrowed definition is kept borrowed: the variable location holds
+    // the borrowed value itself and the variable is fetched indirectly
+    auto var = MakeVariableSlot(definition.type, definition.borrowed);
+    const ScopedVariableLocation var_location{
+        &variables_, t.variable.uid,
+        {.holder = var->GetLocation(), .indirect = definition.borrowed}};
+
+    ExpressionData body = boost::apply_visitor(*this, t.body);
+
+    // NB: The variable location is owned by Let, so the body may stay borrowed
+    return Note(
+        {
+            .term =
+                {
+                    .args = {},
+                    .implementation = std::make_unique<functions::library::Let>(
+                        std::move(var), std::move(definition.term),
+                        std::move(body.term)),
+                },
+            .type = t.type,
+            .borrowed = body.borrowed,
+        },
+        "let");
+  }
+
+  result_type operator()(const parser::terms::FunctionTerm& t) {
+    return Note(
+        {
             EvaluationTree{
                 .args = {},
+                // TODO: Throw custom exception when function name is invalid
                 .implementation =
-                    std::make_unique<functions::library::FetchVariable>(
-                        find_variable->second),
+                    std::make_unique<functions::library::GetLambdaValue>(
+                        functions_.at(t.name)->GetImplementation(t.type)),
             },
-        .type = t.type,
-    };
+            t.type,
+        },
+        t.name);
   }
 
-  result_type operator()(const parser::terms::ApplicationTerm& t) {
+  result_type operator()(const parser::terms::ValueTerm& t) {
+    if (boost::get<functions::AnyType>(&t.type)) {
+      // E.g. a folded constant
+      return Note(
+          {
+              EvaluationTree{
+                  .args = {},
+                  .implementation = std::make_unique<
+                      functions::library::GetValue<value::Value>>(t.value)},
+              t.type,
+          },
+          "constant");
+    }
+    return Note(
+        {
+            EvaluationTree{
+                .args = {},
+                .implementation = functions::library::MakeGetValue(t.value)},
+            functions::utils::GetType(t.value),
+        },
+        "constant");
+  }
+
+ private:
+  friend class MakeApplicationVisitor<MakeExpressionVisitor>;
+
+  /// Memo of a class of common subterms
+  struct SharedLocation {
+    // Not set if the subterm is compiled at each occurrence
+    EvaluationTree* term = nullptr;
+    functions::Type type;
+  };
+
+  ExpressionData MakeApplication(const parser::terms::ApplicationTerm& t) {
+    if (std::optional<ExpressionData> lookup = MakeMappedVarMapAt(t)) {
+      return std::move(*lookup);
+    }
+
+    // Only library functions may take and return borrowed values
+    functions::PolymorphicFunctionFactory* function = nullptr;
+    if (const auto* function_term =
+            boost::get<parser::terms::FunctionTerm>(&t.executable)) {
+      function = functions_.at(function_term->name).get();
+    }
+
+    // Try to bind a constant argument at compile time
+    std::unique_ptr<functions::IEvaluatable> implementation;
+    std::optional<size_t> constant_arg;
+    for (size_t i = 0; function && i < t.arguments.size(); ++i) {
+      const auto* constant =
+          boost::get<parser::terms::ValueTerm>(&t.arguments[i]);
+      if (!constant) {
+        continue;
+      }
+      implementation = function->GetImplementationWithConstant(
+          boost::get<parser::terms::FunctionTerm>(t.executable).type, i,
+          constant->value);
+      if (implementation) {
+        constant_arg = i;
+        break;
+      }
+    }
+    if (!implementation) {
+      implementation = boost::apply_visitor(
+          MakeApplicationVisitor{this, t.type}, terms::Term{t.executable});
+    }
+
     std::vector<EvaluationTree> args;
+    std::bitset<functions::kMaxArgs> lazy_args;
     args.reserve(t.arguments.size());
-    for (const terms::Term& arg : t.arguments) {
-      args.emplace_back(boost::apply_visitor(*this, arg).term);
+    for (size_t i = 0; i < t.arguments.size(); ++i) {
+      if (i == constant_arg) {
+        continue;
+      }
+      if (function && function->IsLazyArgument(i)) {
+        lazy_args.set(args.size());
+      }
+      ExpressionData arg = boost::apply_visitor(*this, t.arguments[i]);
+      if (function && function->BorrowsArgument(i)) {
+        args.emplace_back(Borrow(std::move(arg)));
+      } else {
+        const functions::Type arg_type = arg.type;
+        args.emplace_back(Memoize(Materialize(std::move(arg)), arg_type,
+                                  t.arguments[i], FindDependencies(t)));
+      }
     }
 
-    return {
-        .term =
-            {
-                .args = std::move(args),
-                .implementation =
-                    boost::apply_visitor(MakeApplicationVisitor{this, t.type},
-                                         terms::Term{t.executable}),
-            },
-        .type = t.type,
+    std::vector<std::string> notes;
+    if (constant_arg) {
+      notes.push_back(std::format(
+          "constant argument {} bound at compile time", *constant_arg));
+    }
+    const auto* function_term =
+        boost::get<parser::terms::FunctionTerm>(&t.executable);
+    return Note(
+        {
+            .term =
+                {
+                    .args = std::move(args),
+                    .implementation = std::move(implementation),
+                    .lazy_args = lazy_args,
+                },
+            .type = t.type,
+            .borrowed = function && function->LendsResult(function_term->type),
+        },
+        function_term ? function_term->name : "apply", std::move(notes));
+  }
+
+  const Dependencies* FindDependencies(const parser::terms::Term& t) const {
+    const auto* application = boost::get<parser::terms::ApplicationTerm>(&t);
+    return application ? FindDependencies(*application) : nullptr;
+  }
+
+  const Dependencies* FindDependencies(
+      const parser::terms::ApplicationTerm& t) const {
+    const auto find_dependencies = dependencies_.find(&t);
+    return find_dependencies == dependencies_.end()
+               ? nullptr
+               : &find_dependencies->second;
+  }
+
+  /// Wraps an owned term into a memo if its result may outlive a change of
+  /// the inputs that its parent reads
+  EvaluationTree Memoize(EvaluationTree term, const functions::Type& type,
+                         const parser::terms::Term& t,
+                         const Dependencies* parent) {
+    const Dependencies* dependencies = FindDependencies(t);
+    // Accesses are cheap and lambdas are not values to keep
+    if (!memoized_ || !dependencies || !dependencies->IsInvariant() ||
+        dependencies->is_access || boost::get<functions::FunctionType>(&type)) {
+      return term;
+    }
+    // Otherwise it is recomputed only together with its parent
+    if (parent && parent->IsInvariant() &&
+        parent->paths == dependencies->paths) {
+      return term;
+    }
+
+    std::unique_ptr<functions::IEvaluatable> memo =
+        functions::utils::MakeForValueType<functions::library::MemoImpl>(type);
+    memoized_->push_back({
+        .memo = static_cast<functions::library::IMemo*>(memo.get()),
+        .dependencies = *dependencies,
+    });
+    EvaluationTree result{
+        .args = {},
+        .implementation = std::move(memo),
     };
+    result.args.push_back(std::move(term));
+    result.lazy_args.set(0);
+    return result;
   }
 
-  result_type operator()(const parser::terms::LambdaTerm& t) {
+  /// Records what is known about the node of `data` for Explain
+  ExpressionData Note(ExpressionData data, std::string term,
+                      std::vector<std::string> notes = {}) {
+    if (plan_info_) {
+      plan_info_->insert_or_assign(data.term.implementation.get(),
+                                   NodeInfo{
+                                       .term = std::move(term),
+                                       .type = data.type,
+                                       .borrowed = data.borrowed,
+                                       .notes = std::move(notes),
+                                   });
+    }
+    return data;
+  }
+
+  /// Wraps the term of an application or a lambda body into a profiled node
+  /// labelled by `t`
+  template <typename T>
+  EvaluationTree Profile(EvaluationTree term, const T& t) {
+    if (!profiler_) {
+      return term;
+    }
+    std::string label;
+    if constexpr (std::is_same_v<T, parser::terms::LambdaTerm>) {
+      label = std::format("lambda: {}", functions::ToString(t.type));
+    } else if (const auto* function =
+                   boost::get<parser::terms::FunctionTerm>(&t.executable)) {
+      label = std::format("{}: {}", function->name,
+                          functions::ToString(t.type));
+    } else {
+      label = std::format("apply: {}", functions::ToString(t.type));
+    }
+
+    EvaluationTree result{
+        .args = {},
+        .implementation = std::make_unique<ProfileNode>(
+            profiler_, profiler_->AddNode(std::move(label))),
+    };
+    result.args.push_back(std::move(term));
+    result.lazy_args.set(0);
+    return result;
+  }
+
+  /// Wraps the term of an application into a node that counts the calls of its
+  /// function
+  EvaluationTree CountCalls(EvaluationTree term,
+                            const parser::terms::ApplicationTerm& t) {
+    if (!metrics_) {
+      return term;
+    }
+    const auto* function =
+        boost::get<parser::terms::FunctionTerm>(&t.executable);
+    EvaluationTree result{
+        .args = {},
+        .implementation = std::make_unique<CountCallNode>(
+            metrics_, metrics_->AddFunction(function ? function->name
+                                                     : "apply")),
+    };
+    result.args.push_back(std::move(term));
+    result.lazy_args.set(0);
+    return result;
+  }
+
+  /// Makes a reference to the memo of a common subterm, compiles it on its
+  /// first occurrence
+  std::optional<ExpressionData> MakeShared(
+      const parser::terms::ApplicationTerm& t) {
+    const auto find_common = common_.find(&t);
+    if (!shared_ || find_common == common_.end()) {
+      return std::nullopt;
+    }
+    auto [find_shared, inserted] = shared_by_class_.try_emplace(
+        find_common->second, SharedLocation{.type = t.type});
+    SharedLocation& location = find_shared->second;
+    if (inserted) {
+      ExpressionData data = MakeApplication(t);
+      // An access is cheaper than a copy of the kept value
+      if (data.borrowed || boost::get<functions::FunctionType>(&data.type)) {
+        return data;
+      }
+      std::unique_ptr<functions::IEvaluatable> memo =
+          functions::utils::MakeForValueType<functions::library::MemoImpl>(
+              data.type);
+      auto term = std::make_unique<EvaluationTree>(EvaluationTree{
+          .args = {},
+          .implementation = std::move(memo),
+      });
+      term->args.push_back(std::move(data.term));
+      term->lazy_args.set(0);
+      location = {.term = term.get(), .type = std::move(data.type)};
+      shared_->push_back({
+          .term = std::move(term),
+          .memo = static_cast<functions::library::IMemo*>(
+              location.term->implementation.get()),
+      });
+    } else if (!location.term) {
+      return std::nullopt;
+    }
     return ExpressionData{
         .term =
             {
                 .args = {},
                 .implementation =
-                    std::make_unique<functions::library::GetLambdaValue>(
-                        boost::apply_visitor(
-                            MakeApplicationVisitor{this, t.type},
-                            parser::terms::Term{t})),
+                    std::make_unique<functions::library::EvaluateShared>(
+                        location.term),
             },
-        .type = t.type,
+        .type = location.type,
     };
   }
 
-  result_type operator()(const parser::terms::FunctionTerm& t) {
-    return {
-        EvaluationTree{
-            .args = {},
-            // TODO: Throw custom exception when function name is invalid
-            .implementation =
-                std::make_unique<functions::library::GetLambdaValue>(
-                    functions_.at(t.name)->GetImplementation(t.type)),
+  /// Makes VarMapAt of a mapped input, which has no value location
+  std::optional<ExpressionData> MakeMappedVarMapAt(
+      const parser::terms::ApplicationTerm& t) {
+    const auto* function =
+        boost::get<parser::terms::FunctionTerm>(&t.executable);
+    if (!function || function->name != "VarMapAt" ||
+        t.arguments.size() != 2) {
+      return std::nullopt;
+    }
+    const auto* object =
+        boost::get<parser::terms::VariableTerm>(&t.arguments[0]);
+    const auto find_mapped =
+        object ? mapped_inputs_.find(object->uid) : mapped_inputs_.end();
+    if (find_mapped == mapped_inputs_.end()) {
+      return std::nullopt;
+    }
+
+    std::vector<EvaluationTree> args;
+    args.push_back(Materialize(boost::apply_visitor(*this, t.arguments[1])));
+    return Note(
+        {
+            .term =
+                {
+                    .args = std::move(args),
+                    .implementation = functions::utils::MakeForValueType<
+                        functions::library::MappedVarMapAtImpl>(
+                        t.type, find_mapped->second),
+                },
+            .type = t.type,
         },
-        t.type,
-    };
+        "VarMapAt", {"looked up in the mapped input"});
   }
 
-  result_type operator()(const parser::terms::ValueTerm& t) {
-    return {
-        EvaluationTree{
-            .args = {},
-            .implementation = functions::library::MakeGetValue(t.value)},
-        functions::utils::GetType(t.value),
-    };
+  /// Makes an evaluatable that returns a borrowed value of a variable
+  std::unique_ptr<functions::IEvaluatable> MakeFetchVariable(size_t uid) {
+    const auto find_variable = variables_.find(uid);
+    if (find_variable == variables_.end()) {
+      throw std::runtime_error(
+          std::format("Variable mapping is not defined for uid={}", uid));
+    }
+    if (find_variable->second.indirect) {
+      return std::make_unique<functions::library::FetchIndirectVariable>(
+          find_variable->second.holder);
+    }
+    return std::make_unique<functions::library::FetchVariable>(
+        find_variable->second.holder);
   }
 
- private:
-  friend class MakeApplicationVisitor<MakeExpressionVisitor>;
-
  private:
   functions::FunctionsLibrary functions_;
 
-  std::unordered_map<size_t, const functions::ValueHolder*> variables_;
+  VariableLocations variables_;
+  const MappedObjects mapped_inputs_;
+  // Set if the results of invariant subtrees are memoized
+  DependencyMap dependencies_;
+  std::vector<MemoizedTerm>* memoized_ = nullptr;
+  // Set if common subterms are shared
+  CommonSubterms common_;
+  std::vector<SharedTerm>* shared_ = nullptr;
+  std::unordered_map<size_t, SharedLocation> shared_by_class_;
+  // Set if the nodes are profiled
+  Profiler* profiler_ = nullptr;
+  // Set if the calls of functions are counted
+  MetricsRegistry* metrics_ = nullptr;
+  // Set if the nodes are recorded for Explain
+  PlanInfo* plan_info_ = nullptr;
 };
 
 class GetValueVisitor : boost::static_visitor<value::Value> {
@@ -216,7 +672,7 @@ class GetValueVisitor : boost::static_visitor<value::Value> {
 
   result_type operator()(const functions::BoolType&) const {
     // TODO: Use memory-safe interface to ValueHolder
-    auto* held_result = reinterpret_cast<value::FloatValue*>(holder_);
+    auto* held_result = reinterpret_cast<value::BoolValue*>(holder_);
     value::Value result = std::move(*held_result);
     return result;
   }
@@ -279,6 +735,92 @@ class GetValueVisitor : boost::static_visitor<value::Value> {
   functions::ValueHolder* holder_;
 };
 
+/// Mapped inputs are not bound, they are read by MappedVarMapAtImpl
+void SkipMappedInput(const EvaluationContext& /*context*/, size_t /*i*/,
+                     functions::ValueHolder* /*to*/) {}
+
+/// Inputs are borrowed from the context, so they are fetched indirectly
+template <typename V>
+void BindInput(const EvaluationContext& context, size_t i,
+               functions::ValueHolder* to) {
+  *reinterpret_cast<const V**>(to) = &GetInput<V>(context, i);
+}
+
+InputBinder MakeInputBinder(const functions::Type& type) {
+  return functions::utils::VisitValueType(
+      type, [](auto tag) -> InputBinder {
+        using V = typename decltype(tag)::type;
+        if constexpr (std::is_same_v<V, value::LambdaValue>) {
+          throw functions::UnsupportedType("Inputs may not be functions.");
+        } else {
+          return &BindInput<V>;
+        }
+      });
+}
+
+size_t FindInput(const parser::terms::InputSchema& inputs,
+                 std::string_view name) {
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].name == name) {
+      return i;
+    }
+  }
+  throw std::invalid_argument(std::format("Input {} is not declared.", name));
+}
+
+MappedObjects FindMappedInputs(const ExpressionOptions& options) {
+  // Input i is the variable with uid i, see parser/terms/input-schema.hpp
+  MappedObjects result;
+  for (const MappedInput& input : options.mapped_inputs) {
+    const size_t i = FindInput(options.inputs, input.name);
+    if (!boost::get<functions::DictType>(&options.inputs[i].type)) {
+      throw std::invalid_argument(
+          std::format("Mapped input {} is not a Dict.", input.name));
+    }
+    result.emplace(i, input.object);
+  }
+  return result;
+}
+
+/// Input i is bound to `holders[i]` by `binders[i]` before each evaluation,
+/// mapped inputs have no location
+VariableLocations MakeInputLocations(const parser::terms::InputSchema& inputs,
+                                     const MappedObjects& mapped_inputs,
+                                     functions::ValueHolder* holders,
+                                     std::vector<InputBinder>* binders) {
+  VariableLocations result;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (mapped_inputs.contains(i)) {
+      binders->push_back(&SkipMappedInput);
+      continue;
+    }
+    binders->push_back(MakeInputBinder(inputs[i].type));
+    result.emplace(i,
+                   VariableLocation{.holder = &holders[i], .indirect = true});
+  }
+  return result;
+}
+
+/// Registers the expression in `options.metrics` with its compilation from
+/// `start`, returns its id
+size_t RegisterMetrics(const ExpressionOptions& options,
+                       std::chrono::steady_clock::time_point start) {
+  const size_t id = options.metrics->AddExpression(options.metrics_name);
+  options.metrics->CountCompilation(
+      id, std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+  return id;
+}
+
+size_t CountNodes(const PlanNode& plan) {
+  size_t result = 1;
+  for (const PlanNode& child : plan.children) {
+    result += CountNodes(child);
+  }
+  return result;
+}
+
 // TODO: Use memory-safe interface to ValueHolder
 value::Value GetValue(functions::ValueHolder* holder,
                       const functions::Type& result_type) {
@@ -287,13 +829,357 @@ value::Value GetValue(functions::ValueHolder* holder,
 
 }  // namespace
 
-Expression::Expression(const parser::terms::SemanticGraph& graph)
-    : Expression(boost::apply_visitor(
-          MakeExpressionVisitor{functions::MakeDefaultLibrary()}, graph)) {}
+Expression::Expression(ExpressionData in) { InitTree(std::move(in)); }
+
+Expression::Expression(const parser::terms::SemanticGraph& graph,
+                       ExpressionOptions options) {
+  const auto start = std::chrono::steady_clock::now();
+  Init(graph, options);
+  FinishCompilation(options, start);
+}
+
+Expression::Expression(std::string_view source, ExpressionOptions options) {
+  const auto start = std::chrono::steady_clock::now();
+  parser::terms::InputSchema placeholders;
+  if (options.use_precompiled && options.mapped_inputs.empty() &&
+      !options.incremental && !options.profile && !options.metrics_calls) {
+    // NB: Only a function generated with the same declared inputs reads the
+    // placeholders from the positions that follow them
+    precompiled_ = FindPrecompiled(source, options.inputs);
+    if (precompiled_) {
+      placeholders = parser::ParsePlaceholders(source);
+      inputs_ = std::move(options.inputs);
+      inputs_.insert(inputs_.end(), placeholders.begin(), placeholders.end());
+      field_paths_.assign(inputs_.size(), {parser::terms::FieldPath{}});
+      FinishCompilation(options, start);
+      return;
+    }
+  }
+  if (options.compile_stats && options.compile_stats->name.empty()) {
+    options.compile_stats->name = source;
+  }
+  const parser::terms::SemanticGraph graph = parser::Parse(
+      source, options.inputs, &placeholders, options.compile_stats);
+  options.inputs.insert(options.inputs.end(), placeholders.begin(),
+                        placeholders.end());
+  Init(graph, options);
+  FinishCompilation(options, start);
+}
+
+void Expression::Init(const parser::terms::SemanticGraph& graph,
+                      ExpressionOptions options) {
+  inputs_ = options.inputs;
+  field_paths_ = parser::terms::CollectFieldPaths(graph, inputs_.size());
+  if (!options.mapped_inputs.empty() &&
+      (options.backend != Backend::kTree || options.tier_up_after > 0)) {
+    throw std::invalid_argument(
+        "Mapped inputs are supported by the tree backend without tiering.");
+  }
+  if (options.incremental &&
+      (options.backend != Backend::kTree || options.tier_up_after > 0)) {
+    throw std::invalid_argument(
+        "Incremental evaluation is supported by the tree backend without "
+        "tiering.");
+  }
+  if (options.profile &&
+      (options.backend != Backend::kTree || options.tier_up_after > 0)) {
+    throw std::invalid_argument(
+        "Profiling is supported by the tree backend without tiering.");
+  }
+  if (options.metrics_calls &&
+      (!options.metrics || options.backend != Backend::kTree ||
+       options.tier_up_after > 0)) {
+    throw std::invalid_argument(
+        "Calls are counted in metrics by the tree backend without tiering.");
+  }
+  MappedObjects mapped_inputs = FindMappedInputs(options);
+  const parser::ScopedStage stage{options.compile_stats, "lowering"};
+  switch (options.backend) {
+    case Backend::kTree: {
+      input_holders_ =
+          std::make_unique<functions::ValueHolder[]>(inputs_.size());
+      VariableLocations inputs = MakeInputLocations(
+          inputs_, mapped_inputs, input_holders_.get(), &input_binders_);
+      MakeExpressionVisitor visitor{functions::MakeDefaultLibrary(),
+                                    std::move(inputs),
+                                    std::move(mapped_inputs)};
+      visitor.EnablePlanInfo(&plan_info_);
+      if (options.profile) {
+        profiler_ = std::make_unique<Profiler>(options.profile_allocations);
+        visitor.EnableProfiling(profiler_.get());
+      }
+      if (options.metrics_calls) {
+        visitor.EnableCallCounting(options.metrics);
+      }
+      // Profiles and counted calls are attributed to the applications of the
+      // source, so their nodes are kept as they are
+      const bool optimize = !options.profile && !options.metrics_calls;
+      if (options.incremental) {
+        visitor.EnableMemoization(
+            CollectDependencies(graph, options.inputs.size()), &memoized_);
+        InitTree(visitor.MemoizeResult(boost::apply_visitor(visitor, graph),
+                                       graph),
+                 optimize);
+      } else {
+        InitTree(boost::apply_visitor(visitor, graph), optimize);
+      }
+      if (options.tier_up_after > 0) {
+        tiered_ = std::make_unique<TieredCode>(
+            graph, TieringOptions{
+                       .threshold = options.tier_up_after,
+                       .background = options.background_tier_up,
+                       .speculate_after = options.speculate_after,
+                       .inputs = options.inputs,
+                   });
+      }
+      break;
+    }
+    case Backend::kClosure:
+      closure_ = CompileClosure(graph, {.inputs = &options.inputs});
+      break;
+  }
+}
+
+void Expression::FinishCompilation(
+    const ExpressionOptions& options,
+    std::chrono::steady_clock::time_point start) {
+  if (options.metrics) {
+    metrics_ = options.metrics;
+    metrics_id_ = RegisterMetrics(options, start);
+  }
+  if (options.compile_stats && term_.implementation) {
+    options.compile_stats->runtime_nodes +=
+        CountNodes(ExplainTree(term_, plan_info_));
+  }
+}
 
-value::Value Expression::Evaluate(const EvaluationContext& /*context*/) {
-  functions::ValueHolder result = EvaluateTerm(term_);
+void Expression::InitTree(ExpressionData in, bool optimize) {
+  type_ = std::move(in.type);
+  // Result escapes the evaluation, so it must be owned
+  term_ = Materialize({
+      .term = std::move(in.term),
+      .type = type_,
+      .borrowed = in.borrowed,
+  });
+  if (optimize) {
+    OptimizePeephole(&term_, &plan_info_);
+  }
+  streamable_ = dynamic_cast<functions::library::IStreamable*>(
+      term_.implementation.get());
+}
+
+value::Value Expression::Evaluate(const EvaluationContext& context) {
+  const ScopedEvaluation evaluation{metrics_, metrics_id_};
+  const ScopedBudget budget{context.budget};
+  if (precompiled_) {
+    return precompiled_(context);
+  }
+
+  if (closure_) {
+    Frame frame{.context = &context};
+    return closure_(frame);
+  }
+
+  if (tiered_) {
+    if (const CompiledClosure* optimized = tiered_->Enter()) {
+      Frame frame{.context = &context};
+      try {
+        return (*optimized)(frame);
+      } catch (const DeoptimizationError&) {
+        // Evaluation has no side effects, so it is restarted
+        Frame generic_frame{.context = &context};
+        return (*tiered_->Deoptimize())(generic_frame);
+      }
+    }
+  }
+
+  // Any input may have changed
+  InvalidateMemoized(std::nullopt);
+  BindInputs(context);
+  functions::ValueHolder result;
+  EvaluateTerm(term_, &result);
+  return GetValue(&result, type_);
+}
+
+value::Value Expression::Evaluate(const EvaluationContext& context,
+                                  std::span<const InputPath> changed_paths) {
+  if (memoized_.empty()) {
+    return Evaluate(context);
+  }
+  const ScopedEvaluation evaluation{metrics_, metrics_id_};
+  const ScopedBudget budget{context.budget};
+  InvalidateMemoized(changed_paths);
+  BindInputs(context);
+  functions::ValueHolder result;
+  EvaluateTerm(term_, &result);
   return GetValue(&result, type_);
 }
 
+void Expression::EvaluateTo(const EvaluationContext& context,
+                            json::Writer* writer) {
+  if (!streamable_ || tiered_) {
+    writer->Write(Evaluate(context));
+    return;
+  }
+
+  const ScopedEvaluation evaluation{metrics_, metrics_id_};
+  const ScopedBudget budget{context.budget};
+  InvalidateMemoized(std::nullopt);
+  BindInputs(context);
+  functions::ArgsContainer args;
+  EvaluateArgs(term_, &args);
+  functions::ValueHolder item;
+  writer->BeginArray();
+  streamable_->EvaluateTo(&args, &item, writer);
+  writer->EndArray();
+}
+
+void Expression::InvalidateMemoized(
+    std::optional<std::span<const InputPath>> changed_paths) {
+  for (const MemoizedTerm& memoized : memoized_) {
+    if (!changed_paths || memoized.dependencies.DependsOn(*changed_paths)) {
+      memoized.memo->Invalidate();
+    }
+  }
+}
+
+void Expression::BindInputs(const EvaluationContext& context) {
+  for (size_t i = 0; i < input_binders_.size(); ++i) {
+    input_binders_[i](context, i, &input_holders_[i]);
+  }
+}
+
+std::string Expression::Explain(ExplainFormat format) const {
+  if (precompiled_ || closure_) {
+    return RenderPlan({.kernel = precompiled_ ? "PrecompiledFunction"
+                                              : "CompiledClosure"},
+                      format);
+  }
+  return RenderPlan(ExplainTree(term_, plan_info_), format);
+}
+
+size_t Expression::GetInputIndex(std::string_view name) const {
+  return FindInput(inputs_, name);
+}
+
+bool Expression::IsOptimized() const {
+  return tiered_ && tiered_->IsOptimized();
+}
+
+bool Expression::IsSpeculative() const {
+  return tiered_ && tiered_->IsSpeculative();
+}
+
+void Expression::WaitForOptimization() {
+  if (tiered_) {
+    tiered_->Wait();
+  }
+}
+
+ExpressionSet::ExpressionSet(
+    std::span<const parser::terms::SemanticGraph> graphs,
+    ExpressionOptions options) {
+  const auto start = std::chrono::steady_clock::now();
+  Init(graphs, options);
+  if (options.metrics) {
+    metrics_ = options.metrics;
+    metrics_id_ = RegisterMetrics(options, start);
+  }
+}
+
+ExpressionSet::ExpressionSet(std::span<const std::string_view> sources,
+                             ExpressionOptions options) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<parser::terms::SemanticGraph> graphs;
+  graphs.reserve(sources.size());
+  for (const std::string_view source : sources) {
+    parser::terms::InputSchema placeholders;
+    graphs.push_back(parser::Parse(source, options.inputs, &placeholders,
+                                   options.compile_stats));
+    if (!placeholders.empty()) {
+      throw std::invalid_argument(
+          "Expressions of a set may not have placeholders.");
+    }
+  }
+  Init(graphs, options);
+  if (options.metrics) {
+    metrics_ = options.metrics;
+    metrics_id_ = RegisterMetrics(options, start);
+  }
+}
+
+void ExpressionSet::Init(std::span<const parser::terms::SemanticGraph> graphs,
+                         ExpressionOptions options) {
+  if (options.backend != Backend::kTree || options.tier_up_after > 0 ||
+      options.incremental || options.profile || options.metrics_calls) {
+    throw std::invalid_argument(
+        "Expression sets are supported by the tree backend without tiering, "
+        "incremental evaluation, profiling and counting of calls.");
+  }
+  std::optional<parser::ScopedStage> stage{std::in_place,
+                                           options.compile_stats, "lowering"};
+  inputs_ = std::move(options.inputs);
+  options.inputs = inputs_;
+  field_paths_ = parser::terms::CollectFieldPaths(graphs, inputs_.size());
+
+  MappedObjects mapped_inputs = FindMappedInputs(options);
+  input_holders_ = std::make_unique<functions::ValueHolder[]>(inputs_.size());
+  VariableLocations inputs = MakeInputLocations(
+      inputs_, mapped_inputs, input_holders_.get(), &input_binders_);
+  MakeExpressionVisitor visitor{functions::MakeDefaultLibrary(),
+                                std::move(inputs), std::move(mapped_inputs)};
+  visitor.EnableSharing(FindCommonSubterms(graphs, inputs_.size()), &shared_);
+
+  expressions_.reserve(graphs.size());
+  for (const parser::terms::SemanticGraph& graph : graphs) {
+    ExpressionData data = boost::apply_visitor(visitor, graph);
+    // Results escape the evaluation, so they must be owned
+    CompiledExpression& expression = expressions_.emplace_back(
+        CompiledExpression{.term = {}, .type = data.type});
+    expression.term = Materialize(std::move(data));
+    OptimizePeephole(&expression.term);
+  }
+  for (SharedTerm& shared : shared_) {
+    OptimizePeephole(shared.term.get());
+  }
+  stage.reset();
+
+  if (options.compile_stats) {
+    for (const CompiledExpression& expression : expressions_) {
+      options.compile_stats->runtime_nodes +=
+          CountNodes(ExplainTree(expression.term, {}));
+    }
+    for (const SharedTerm& shared : shared_) {
+      options.compile_stats->runtime_nodes +=
+          CountNodes(ExplainTree(*shared.term, {}));
+    }
+  }
+}
+
+std::vector<value::Value> ExpressionSet::Evaluate(
+    const EvaluationContext& context) {
+  const ScopedEvaluation evaluation{metrics_, metrics_id_};
+  const ScopedBudget budget{context.budget};
+  // Kept values belong to the previous inputs
+  for (const SharedTerm& shared : shared_) {
+    shared.memo->Invalidate();
+  }
+  for (size_t i = 0; i < input_binders_.size(); ++i) {
+    input_binders_[i](context, i, &input_holders_[i]);
+  }
+
+  std::vector<value::Value> result;
+  result.reserve(expressions_.size());
+  for (CompiledExpression& expression : expressions_) {
+    functions::ValueHolder holder;
+    EvaluateTerm(expression.term, &holder);
+    result.push_back(GetValue(&holder, expression.type));
+  }
+  return result;
+}
+
+size_t ExpressionSet::GetInputIndex(std::string_view name) const {
+  return FindInput(inputs_, name);
+}
+
 }  // namespace magl::executer
@@ -1,7 +1,22 @@
 #pragma once
 
+#include <binary/view.hpp>
+#include <executer/closure.hpp>
+#include <executer/common-subterms.hpp>
 #include <executer/context.hpp>
+#include <executer/dependencies.hpp>
+#include <executer/explain.hpp>
+#include <executer/metrics.hpp>
+#include <executer/precompiled.hpp>
+#include <executer/profile.hpp>
 #include <executer/term.hpp>
+#include <executer/tiering.hpp>
+#include <functions/library/memo.hpp>
+#include <functions/library/stream.hpp>
+#include <json/writer.hpp>
+#include <parser/compile-stats.hpp>
+#include <parser/terms/field-access.hpp>
+#include <parser/terms/input-schema.hpp>
 #include <parser/terms/semantic-graph.hpp>
 #include <value/value.hpp>
 
@@ -10,20 +25,255 @@ namespace magl::executer {
 struct ExpressionData {
   EvaluationTree term;
   functions::Type type;
+  /// Whether the term evaluates to a borrowed value (`const V*`) instead of V
+  bool borrowed = false;
+};
+
+enum class Backend {
+  // Tree of IEvaluatable that pass values through ValueHolders
+  kTree = 0,
+  // Nested closures typed by value representations, see closure.hpp
+  kClosure = 1,
+};
+
+/// Input bound once to an encoded object, e.g. a reference table of
+/// binary::MappedValue, instead of a value of EvaluationContext::inputs
+struct MappedInput {
+  std::string name;
+  binary::ObjectView object;
+};
+
+struct ExpressionOptions {
+  Backend backend = Backend::kTree;
+  // Inputs of the expression. A graph must be parsed with the same schema
+  // including its placeholders, a source is parsed with it
+  parser::terms::InputSchema inputs{};
+  // Whether Expression(source) uses a function compiled ahead of time by
+  // codegen/ when one is linked in and was generated with the same `inputs`.
+  // The function replaces the backend, so `backend` and `tier_up_after` are
+  // ignored then
+  bool use_precompiled = true;
+  // Number of evaluations by the tree interpreter after which the expression
+  // is re-lowered into the optimized tier, see tiering.hpp. 0 disables tiering
+  size_t tier_up_after = 0;
+  // Whether the optimized tier is compiled by a background thread
+  bool background_tier_up = true;
+  // Number of evaluations by the optimized tier that profile runtime types of
+  // values of type Any before it is specialized on them, see tiering.hpp.
+  // 0 disables speculation
+  size_t speculate_after = 0;
+  // Inputs of type Dict looked up in encoded objects, which must outlive the
+  // expression. They are read only with VarMapAt, each lookup decodes just the
+  // item. Their values in EvaluationContext::inputs are ignored. Supported by
+  // the tree backend without tiering
+  std::vector<MappedInput> mapped_inputs{};
+  // Whether results of subtrees that depend only on inputs are kept between
+  // evaluations, so that Evaluate(context, changed_paths) recomputes only the
+  // ones that read the changed paths. Supported by the tree backend without
+  // tiering
+  bool incremental = false;
+  // Whether each application and lambda body counts its calls, cycles and
+  // allocations by call path, see Expression::GetProfiler. Nodes are not
+  // fused by the peephole pass then. Supported by the tree backend without
+  // tiering
+  bool profile = false;
+  // Reads allocated bytes for the profile, they are not counted if it is not
+  // set
+  AllocationCounter profile_allocations = nullptr;
+  // Counts the evaluations, exceptions, allocations and latencies of the
+  // compilation and of the evaluations under `metrics_name`, see metrics.hpp.
+  // Must outlive the expression
+  MetricsRegistry* metrics = nullptr;
+  std::string metrics_name{};
+  // Whether each application also counts the calls of its function in
+  // `metrics`. Nodes are not fused by the peephole pass then, so the calls are
+  // counted under the functions of the source. Supported by the tree backend
+  // without tiering
+  bool metrics_calls = false;
+  // Receives the wall time of the stages of the compilation and their
+  // counters, see parser/compile-stats.hpp
+  parser::CompileStats* compile_stats = nullptr;
+};
+
+/// Writes `const V*` to input i into its holder
+using InputBinder = void (*)(const EvaluationContext& context, size_t i,
+                             functions::ValueHolder* to);
+
+/// Subtree whose result is kept between evaluations, see
+/// ExpressionOptions::incremental
+struct MemoizedTerm {
+  functions::library::IMemo* memo;
+  Dependencies dependencies;
+};
+
+/// Subtree evaluated once for all its occurrences in an ExpressionSet
+struct SharedTerm {
+  std::unique_ptr<EvaluationTree> term;
+  functions::library::IMemo* memo;
 };
 
 class Expression {
  public:
-  Expression(const parser::terms::SemanticGraph& graph);
-  Expression(ExpressionData in)
-      : term_(std::move(in.term)), type_(std::move(in.type)) {}
+  Expression(const parser::terms::SemanticGraph& graph,
+             ExpressionOptions options = {});
+  Expression(ExpressionData in);
+  /// Parses `source` unless a precompiled function is registered for it with
+  /// the same `options.inputs`. Placeholders of `source` are the inputs after
+  /// `options.inputs`
+  Expression(std::string_view source, ExpressionOptions options = {});
 
   // TODO: Make Evaluate const
   value::Value Evaluate(const EvaluationContext& context);
 
+  /// Evaluates inputs that are equal to the ones of the previous evaluation
+  /// except at `changed_paths`, e.g. the next version of a document. They may
+  /// be other objects: kept results are owned. With
+  /// ExpressionOptions::incremental only the subtrees that read a changed path
+  /// are recomputed, otherwise everything is
+  value::Value Evaluate(const EvaluationContext& context,
+                        std::span<const InputPath> changed_paths);
+
+  /// Writes the result to `writer`. A list returned by Map is written by the
+  /// tree interpreter item by item as they are produced, without building it.
+  /// If the evaluation throws, the output is undefined: the items written so
+  /// far may already be flushed to the file descriptor of the writer. Write to
+  /// a buffer to discard them
+  void EvaluateTo(const EvaluationContext& context, json::Writer* writer);
+
+  /// Renders the plan of the tree interpreter, see explain.hpp: the
+  /// specialization and the type of each node, constant arguments bound and
+  /// nodes fused at compile time, generic Any paths, literals copied per call
+  /// and a static cost estimate. A precompiled or closure-compiled expression
+  /// is a single opaque node
+  std::string Explain(ExplainFormat format = ExplainFormat::kText) const;
+
+  /// Counters of the profiled nodes, see ExpressionOptions::profile. Null if
+  /// the expression is not profiled
+  Profiler* GetProfiler() { return profiler_.get(); }
+
+  /// Whether the expression is re-lowered into the optimized tier
+  bool IsOptimized() const;
+
+  /// Whether the optimized tier is specialized on profiled types
+  bool IsSpeculative() const;
+
+  /// Blocks until a background re-lowering started by Evaluate is over
+  void WaitForOptimization();
+
+  /// Inputs in the order of EvaluationContext::inputs
+  const parser::terms::InputSchema& GetInputs() const { return inputs_; }
+
+  /// Returns the position of an input or a placeholder (with the leading '$')
+  /// in EvaluationContext::inputs. Throws std::invalid_argument if there is
+  /// none
+  size_t GetInputIndex(std::string_view name) const;
+
+  /// Fields of input i the expression can access, see field-access.hpp. A
+  /// reader may skip the others, e.g. json::Projection. A precompiled
+  /// expression accesses its whole inputs
+  const std::vector<parser::terms::FieldPath>& GetFieldPaths(size_t i) const {
+    return field_paths_.at(i);
+  }
+
+ private:
+  void Init(const parser::terms::SemanticGraph& graph,
+            ExpressionOptions options);
+  /// Nodes are fused by the peephole pass if `optimize` is set
+  void InitTree(ExpressionData in, bool optimize = true);
+  /// Registers the expression in the metrics and counts the runtime nodes of
+  /// the compilation that started at `start`
+  void FinishCompilation(const ExpressionOptions& options,
+                         std::chrono::steady_clock::time_point start);
+  void BindInputs(const EvaluationContext& context);
+  /// Drops the kept results that depend on `changed_paths`, all of them if
+  /// it is not set
+  void InvalidateMemoized(
+      std::optional<std::span<const InputPath>> changed_paths);
+
  private:
   EvaluationTree term_;
   functions::Type type_;
+  parser::terms::InputSchema inputs_;
+  std::vector<std::vector<parser::terms::FieldPath>> field_paths_;
+  // Locations of the inputs in the tree
+  std::unique_ptr<functions::ValueHolder[]> input_holders_;
+  std::vector<InputBinder> input_binders_;
+  // Set if the root of the tree can stream its items
+  functions::library::IStreamable* streamable_ = nullptr;
+  // Set if the evaluation is incremental
+  std::vector<MemoizedTerm> memoized_;
+  // Set if the expression is profiled
+  std::unique_ptr<Profiler> profiler_;
+  // What is known about the nodes of the tree, see Explain
+  PlanInfo plan_info_;
+  // Set if the evaluations are counted
+  MetricsRegistry* metrics_ = nullptr;
+  size_t metrics_id_ = 0;
+
+  // Set if the expression is compiled by the closure backend
+  CompiledClosure closure_;
+  // Set if the expression is compiled ahead of time, see precompiled.hpp
+  PrecompiledFunction precompiled_ = nullptr;
+  // Set if tiering is enabled
+  std::unique_ptr<TieredCode> tiered_;
+};
+
+/// Expressions compiled together over the same inputs, e.g. the rules that run
+/// on each document. The inputs are bound once per evaluation and an
+/// application that occurs in several expressions (or several times in one) is
+/// evaluated once, see common-subterms.hpp
+class ExpressionSet {
+ public:
+  /// Graphs must be parsed with `options.inputs`. Supported by the tree
+  /// backend without tiering, incremental evaluation, profiling and counting
+  /// of calls. The evaluations of the whole set are counted under
+  /// `options.metrics_name`
+  ExpressionSet(std::span<const parser::terms::SemanticGraph> graphs,
+                ExpressionOptions options = {});
+  /// Parses `sources` with `options.inputs`, which may not have placeholders
+  ExpressionSet(std::span<const std::string_view> sources,
+                ExpressionOptions options = {});
+
+  /// Returns the results in the order of the expressions. Throws if any of
+  /// them fails
+  std::vector<value::Value> Evaluate(const EvaluationContext& context);
+
+  size_t Size() const { return expressions_.size(); }
+
+  /// Number of subterms evaluated once for all their occurrences
+  size_t GetSharedCount() const { return shared_.size(); }
+
+  const parser::terms::InputSchema& GetInputs() const { return inputs_; }
+
+  /// Returns the position of an input in EvaluationContext::inputs. Throws
+  /// std::invalid_argument if there is none
+  size_t GetInputIndex(std::string_view name) const;
+
+  /// Fields of input i any of the expressions can access
+  const std::vector<parser::terms::FieldPath>& GetFieldPaths(size_t i) const {
+    return field_paths_.at(i);
+  }
+
+ private:
+  void Init(std::span<const parser::terms::SemanticGraph> graphs,
+            ExpressionOptions options);
+
+ private:
+  struct CompiledExpression {
+    EvaluationTree term;
+    functions::Type type;
+  };
+
+  std::vector<CompiledExpression> expressions_;
+  // Memos referenced from the expressions and from each other
+  std::vector<SharedTerm> shared_;
+  parser::terms::InputSchema inputs_;
+  std::vector<std::vector<parser::terms::FieldPath>> field_paths_;
+  std::unique_ptr<functions::ValueHolder[]> input_holders_;
+  std::vector<InputBinder> input_binders_;
+  // Set if the evaluations are counted
+  MetricsRegistry* metrics_ = nullptr;
+  size_t metrics_id_ = 0;
 };
 
 }  // namespace magl::executer
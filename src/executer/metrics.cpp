@@ -0,0 +1,223 @@
+#include <executer/metrics.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <deque>
+#include <exception>
+
+#include <functions/library/thunk.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+std::atomic<uint64_t> next_registry_id{0};
+
+size_t FindOrAdd(std::vector<std::string>* names, std::string_view name) {
+  const auto find_name = std::find(names->begin(), names->end(), name);
+  if (find_name != names->end()) {
+    return find_name - names->begin();
+  }
+  names->emplace_back(name);
+  return names->size() - 1;
+}
+
+}  // namespace
+
+void LatencyHistogram::Record(uint64_t nanoseconds) {
+  ++counts_[GetBucket(nanoseconds)];
+  ++count_;
+  sum_ += nanoseconds;
+  max_ = std::max(max_, nanoseconds);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (size_t i = 0; i < kBuckets; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  max_ = std::max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::GetQuantile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::clamp<uint64_t>(
+      static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))), 1,
+      count_);
+  uint64_t seen = 0;
+  for (size_t i = 0; i + 1 < kBuckets; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::min(GetLowerBound(i + 1) - 1, max_);
+    }
+  }
+  return max_;
+}
+
+size_t LatencyHistogram::GetBucket(uint64_t value) {
+  constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+  value = std::min(value, (uint64_t{1} << kMaxBits) - 1);
+  if (value < kSubBuckets) {
+    return value;
+  }
+  // The kSubBucketBits + 1 leading bits of the value, the first one is set
+  const size_t shift = std::bit_width(value) - kSubBucketBits - 1;
+  return ((shift + 1) << kSubBucketBits) + (value >> shift) - kSubBuckets;
+}
+
+uint64_t LatencyHistogram::GetLowerBound(size_t bucket) {
+  constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+  const size_t shift = (bucket >> kSubBucketBits) - 1;
+  return ((bucket & (kSubBuckets - 1)) + kSubBuckets) << shift;
+}
+
+struct MetricsRegistry::Shard {
+  // Guards the expressions and the growth of the calls. The owner thread
+  // changes the calls without it, as no other thread does
+  std::mutex mutex;
+  std::vector<ExpressionMetrics> expressions;
+  // NB: A deque keeps the counters in place when it grows
+  std::deque<std::atomic<uint64_t>> calls;
+
+  ExpressionMetrics& GetExpression(size_t expression) {
+    if (expression >= expressions.size()) {
+      expressions.resize(expression + 1);
+    }
+    return expressions[expression];
+  }
+};
+
+MetricsRegistry::MetricsRegistry(AllocationCounter allocation_counter)
+    : id_(next_registry_id++), allocation_counter_(allocation_counter) {}
+
+MetricsRegistry::~MetricsRegistry() = default;
+
+size_t MetricsRegistry::AddExpression(std::string_view name) {
+  const std::lock_guard lock{mutex_};
+  return FindOrAdd(&expressions_, name);
+}
+
+size_t MetricsRegistry::AddFunction(std::string_view name) {
+  const std::lock_guard lock{mutex_};
+  return FindOrAdd(&functions_, name);
+}
+
+void MetricsRegistry::CountCompilation(size_t expression,
+                                       uint64_t nanoseconds) {
+  Shard& shard = GetShard();
+  const std::lock_guard lock{shard.mutex};
+  shard.GetExpression(expression).compilation_latency.Record(nanoseconds);
+}
+
+void MetricsRegistry::CountEvaluation(size_t expression, uint64_t nanoseconds,
+                                      uint64_t allocated_bytes, bool failed) {
+  Shard& shard = GetShard();
+  // NB: Only Collect contends for the lock
+  const std::lock_guard lock{shard.mutex};
+  ExpressionMetrics& metrics = shard.GetExpression(expression);
+  ++metrics.evaluations;
+  metrics.exceptions += failed ? 1 : 0;
+  metrics.allocated_bytes += allocated_bytes;
+  metrics.evaluation_latency.Record(nanoseconds);
+}
+
+void MetricsRegistry::CountCall(size_t function) {
+  Shard& shard = GetShard();
+  if (function >= shard.calls.size()) {
+    const std::lock_guard lock{shard.mutex};
+    while (function >= shard.calls.size()) {
+      shard.calls.emplace_back(0);
+    }
+  }
+  // Not an atomic increment, the owner thread is the only writer
+  std::atomic<uint64_t>& calls = shard.calls[function];
+  calls.store(calls.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+}
+
+uint64_t MetricsRegistry::ReadAllocated() const {
+  return allocation_counter_ ? allocation_counter_() : 0;
+}
+
+MetricsSnapshot MetricsRegistry::Collect() const {
+  const std::lock_guard lock{mutex_};
+  MetricsSnapshot result;
+  for (const std::string& name : expressions_) {
+    result.expressions.push_back({.name = name});
+  }
+  for (const std::string& name : functions_) {
+    result.calls.emplace_back(name, 0);
+  }
+
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    const std::lock_guard shard_lock{shard->mutex};
+    for (size_t i = 0; i < shard->expressions.size(); ++i) {
+      const ExpressionMetrics& from = shard->expressions[i];
+      ExpressionMetrics& to = result.expressions[i];
+      to.evaluations += from.evaluations;
+      to.exceptions += from.exceptions;
+      to.allocated_bytes += from.allocated_bytes;
+      to.evaluation_latency.Merge(from.evaluation_latency);
+      to.compilation_latency.Merge(from.compilation_latency);
+    }
+    for (size_t i = 0; i < shard->calls.size(); ++i) {
+      result.calls[i].second +=
+          shard->calls[i].load(std::memory_order_relaxed);
+    }
+  }
+  return result;
+}
+
+MetricsRegistry::Shard& MetricsRegistry::GetShard() {
+  // Shards of the registries the thread counted into by their ids, which are
+  // not reused
+  thread_local std::vector<std::pair<uint64_t, Shard*>> local_shards;
+  for (const auto& [id, shard] : local_shards) {
+    if (id == id_) {
+      return *shard;
+    }
+  }
+
+  const std::lock_guard lock{mutex_};
+  shards_.push_back(std::make_unique<Shard>());
+  local_shards.emplace_back(id_, shards_.back().get());
+  return *shards_.back();
+}
+
+ScopedEvaluation::ScopedEvaluation(MetricsRegistry* registry,
+                                   size_t expression)
+    : registry_(registry), expression_(expression) {
+  if (registry_) {
+    uncaught_exceptions_ = std::uncaught_exceptions();
+    start_allocated_ = registry_->ReadAllocated();
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedEvaluation::~ScopedEvaluation() {
+  if (!registry_) {
+    return;
+  }
+  const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_);
+  registry_->CountEvaluation(
+      expression_, nanoseconds.count(),
+      registry_->ReadAllocated() - start_allocated_,
+      std::uncaught_exceptions() > uncaught_exceptions_);
+}
+
+void CountCallNode::Evaluate(functions::ArgsContainer* args,
+                             functions::ValueHolder* to) {
+  registry_->CountCall(function_);
+  functions::library::Force(&args->at(0), to);
+}
+
+}  // namespace magl::executer
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <executer/profile.hpp>
+#include <functions/evaluatable.hpp>
+
+namespace magl::executer {
+
+/// Histogram of latencies in nanoseconds with buckets in the manner of
+/// HdrHistogram: values below 2^kSubBucketBits are counted exactly, larger ones
+/// with kSubBucketBits significant bits, i.e. within 1/16 of the value. Values
+/// from 2^kMaxBits nanoseconds (about 18 minutes) share the last bucket
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 4;
+  static constexpr size_t kMaxBits = 40;
+  static constexpr size_t kBuckets = (kMaxBits - kSubBucketBits + 1)
+                                     << kSubBucketBits;
+
+  void Record(uint64_t nanoseconds);
+  void Merge(const LatencyHistogram& other);
+
+  uint64_t GetCount() const { return count_; }
+  uint64_t GetSum() const { return sum_; }
+  uint64_t GetMax() const { return max_; }
+
+  /// Returns the largest value of the bucket that holds quantile `q`, e.g.
+  /// 0.99, but at most the recorded maximum. 0 if the histogram is empty
+  uint64_t GetQuantile(double q) const;
+
+  /// Bucket i counts the values from GetLowerBound(i) to
+  /// GetLowerBound(i + 1) - 1
+  static size_t GetBucket(uint64_t value);
+  static uint64_t GetLowerBound(size_t bucket);
+
+ private:
+  std::array<uint64_t, kBuckets> counts_{};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+/// Counters of the expressions registered under a name
+struct ExpressionMetrics {
+  std::string name;
+  uint64_t evaluations = 0;
+  // Evaluations that threw
+  uint64_t exceptions = 0;
+  // Allocated by the evaluations, 0 without an AllocationCounter
+  uint64_t allocated_bytes = 0;
+  LatencyHistogram evaluation_latency{};
+  LatencyHistogram compilation_latency{};
+};
+
+struct MetricsSnapshot {
+  // In the order of registration
+  std::vector<ExpressionMetrics> expressions;
+  // Calls by function name in the order of registration, see
+  // ExpressionOptions::metrics_calls
+  std::vector<std::pair<std::string, uint64_t>> calls;
+};
+
+/// Counts evaluations, exceptions, allocations and latencies of expressions
+/// and calls of library functions, see ExpressionOptions::metrics. Each thread
+/// counts into its own shard, the shards are summed by Collect. Thread-safe
+class MetricsRegistry {
+ public:
+  explicit MetricsRegistry(AllocationCounter allocation_counter = nullptr);
+  ~MetricsRegistry();
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  /// Returns the id of the expressions named `name`, e.g. a rule. Expressions
+  /// with the same name share the counters
+  size_t AddExpression(std::string_view name);
+  /// Returns the id of the function for CountCall
+  size_t AddFunction(std::string_view name);
+
+  void CountCompilation(size_t expression, uint64_t nanoseconds);
+  void CountEvaluation(size_t expression, uint64_t nanoseconds,
+                       uint64_t allocated_bytes, bool failed);
+  void CountCall(size_t function);
+
+  /// Reads allocated bytes, 0 without an AllocationCounter
+  uint64_t ReadAllocated() const;
+
+  /// Sums the counters of all threads
+  MetricsSnapshot Collect() const;
+
+ private:
+  struct Shard;
+
+  Shard& GetShard();
+
+ private:
+  // Tells the registry apart from the destroyed ones in the thread-local
+  // caches of shards
+  const uint64_t id_;
+  const AllocationCounter allocation_counter_;
+  // Guards the names and the list of shards
+  mutable std::mutex mutex_;
+  std::vector<std::string> expressions_;
+  std::vector<std::string> functions_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+/// Counts an evaluation from construction to destruction, as failed if the
+/// scope is left by an exception. Does nothing without a registry
+class ScopedEvaluation {
+ public:
+  ScopedEvaluation(MetricsRegistry* registry, size_t expression);
+  ~ScopedEvaluation();
+
+  ScopedEvaluation(const ScopedEvaluation&) = delete;
+  ScopedEvaluation& operator=(const ScopedEvaluation&) = delete;
+
+ private:
+  MetricsRegistry* registry_;
+  const size_t expression_;
+  int uncaught_exceptions_ = 0;
+  uint64_t start_allocated_ = 0;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// Counts a call of a function, then evaluates its lazy argument, the
+/// application
+class CountCallNode : public functions::IEvaluatable {
+ public:
+  CountCallNode(MetricsRegistry* registry, size_t function)
+      : registry_(registry), function_(function) {}
+
+  void Evaluate(functions::ArgsContainer* args,
+                functions::ValueHolder* to) override;
+
+ private:
+  MetricsRegistry* registry_;
+  const size_t function_;
+};
+
+}  // namespace magl::executer
@@ -0,0 +1,154 @@
+#include <executer/peephole.hpp>
+
+#include <format>
+#include <string_view>
+
+#include <functions/library/add.hpp>
+#include <functions/library/apply.hpp>
+#include <functions/library/fetch-variable.hpp>
+#include <functions/library/get-value.hpp>
+#include <functions/library/lambda.hpp>
+#include <functions/library/let.hpp>
+#include <functions/library/multiply.hpp>
+#include <value/value.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+using functions::IEvaluatable;
+
+/// Moves what is known about the replaced evaluatable of `t` to its fused
+/// replacement
+void ReplaceImplementation(EvaluationTree* t,
+                           std::unique_ptr<IEvaluatable> implementation,
+                           std::string_view note, PlanInfo* info) {
+  if (info) {
+    auto node = info->extract(t->implementation.get());
+    if (!node.empty()) {
+      NodeInfo fused = std::move(node.mapped());
+      fused.notes.emplace_back(note);
+      info->insert_or_assign(implementation.get(), std::move(fused));
+    }
+  }
+  t->implementation = std::move(implementation);
+}
+
+/// Optimizes trees that are owned by an evaluatable (lambda and let bodies)
+void OptimizeNested(IEvaluatable* e, PlanInfo* info) {
+  if (auto* lambda_value =
+          dynamic_cast<functions::library::GetLambdaValue*>(e)) {
+    OptimizeNested(lambda_value->GetEvaluatable(), info);
+  } else if (auto* apply = dynamic_cast<functions::library::Apply*>(e)) {
+    OptimizeNested(apply->GetApplied(), info);
+  } else if (auto* lambda = dynamic_cast<functions::library::Lambda*>(e)) {
+    OptimizePeephole(lambda->GetBody(), info);
+  } else if (auto* let = dynamic_cast<functions::library::Let*>(e)) {
+    OptimizePeephole(let->GetDefinition(), info);
+    OptimizePeephole(let->GetBody(), info);
+  } else if (auto* apply_let =
+                 dynamic_cast<functions::library::ApplyLet*>(e)) {
+    OptimizePeephole(apply_let->GetDefinition(), info);
+    OptimizeNested(apply_let->GetBody(), info);
+  }
+}
+
+/// Removes argument `i` of the node, which is a leaf
+void EraseArgument(EvaluationTree* t, size_t i, PlanInfo* info) {
+  if (info) {
+    info->erase(t->args[i].implementation.get());
+  }
+  t->args.erase(t->args.begin() + i);
+
+  // Shift lazy flags of the following arguments
+  const std::bitset<functions::kMaxArgs> low_mask =
+      (std::bitset<functions::kMaxArgs>{}.set() >>
+       (functions::kMaxArgs - i));
+  t->lazy_args = (t->lazy_args & low_mask) | ((t->lazy_args >> 1) & ~low_mask);
+}
+
+const functions::ValueHolder* GetFetchedVariable(const EvaluationTree& t) {
+  const auto* fetch =
+      dynamic_cast<functions::library::FetchVariable*>(t.implementation.get());
+  return fetch ? fetch->GetVariableLocation() : nullptr;
+}
+
+const value::IntegerValue* GetIntegerConstant(const EvaluationTree& t) {
+  const auto* get_value =
+      dynamic_cast<functions::library::GetValue<value::IntegerValue>*>(
+          t.implementation.get());
+  return get_value ? &get_value->GetConstant() : nullptr;
+}
+
+bool FuseApplyVariable(EvaluationTree* t, PlanInfo* info) {
+  const auto* apply =
+      dynamic_cast<functions::library::Apply*>(t->implementation.get());
+  if (!apply) {
+    return false;
+  }
+  const auto* fetch =
+      dynamic_cast<functions::library::FetchVariable*>(apply->GetApplied());
+  if (!fetch) {
+    return false;
+  }
+
+  ReplaceImplementation(t,
+                        std::make_unique<functions::library::ApplyVariable>(
+                            fetch->GetVariableLocation()),
+                        "fused with the fetch of the applied variable", info);
+  return true;
+}
+
+bool FuseVariableArgument(EvaluationTree* t, PlanInfo* info) {
+  const auto* fusable = dynamic_cast<functions::library::IFusableWithVariable*>(
+      t->implementation.get());
+  if (!fusable || t->args.empty() || t->lazy_args[0]) {
+    return false;
+  }
+  const functions::ValueHolder* location = GetFetchedVariable(t->args[0]);
+  if (!location) {
+    return false;
+  }
+
+  ReplaceImplementation(t, fusable->FuseWithVariable(location),
+                        "fused with the fetch of variable argument 0", info);
+  EraseArgument(t, 0, info);
+  return true;
+}
+
+template <typename Impl, typename ConstImpl>
+bool FuseIntegerConstant(EvaluationTree* t, PlanInfo* info) {
+  if (!dynamic_cast<Impl*>(t->implementation.get()) || t->args.size() != 2 ||
+      t->lazy_args.any()) {
+    return false;
+  }
+
+  // Both operations are commutative
+  for (size_t i = 0; i < 2; ++i) {
+    if (const value::IntegerValue* constant = GetIntegerConstant(t->args[i])) {
+      ReplaceImplementation(
+          t, std::make_unique<ConstImpl>(*constant),
+          std::format("fused with constant argument {}", i), info);
+      EraseArgument(t, i, info);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+void OptimizePeephole(EvaluationTree* t, PlanInfo* info) {
+  for (EvaluationTree& arg : t->args) {
+    OptimizePeephole(&arg, info);
+  }
+  OptimizeNested(t->implementation.get(), info);
+
+  FuseApplyVariable(t, info) || FuseVariableArgument(t, info) ||
+      FuseIntegerConstant<functions::library::AddIntImpl,
+                          functions::library::AddIntConstImpl>(t, info) ||
+      FuseIntegerConstant<functions::library::MultiplyIntImpl,
+                          functions::library::MultiplyIntConstImpl>(t, info);
+}
+
+}  // namespace magl::executer
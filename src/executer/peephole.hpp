@@ -0,0 +1,17 @@
+#pragma once
+
+#include <executer/explain.hpp>
+#include <executer/term.hpp>
+
+namespace magl::executer {
+
+/// Replaces recurring node patterns with fused evaluatables that skip
+/// intermediate holders and virtual calls:
+/// * Apply(FetchVariable) -> ApplyVariable
+/// * f(FetchVariable, ...) -> f fused with the variable, see
+///   IFusableWithVariable (e.g. VarMapAt(x, "const"))
+/// * Add(X, const), Multiply(X, const) for integers
+/// The fusions are noted in `info` if it is set
+void OptimizePeephole(EvaluationTree* t, PlanInfo* info = nullptr);
+
+}  // namespace magl::executer
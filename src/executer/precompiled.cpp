@@ -0,0 +1,88 @@
+#include <executer/precompiled.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace magl::executer {
+
+namespace {
+
+struct Entry {
+  std::string_view source;
+  std::span<const PrecompiledInput> inputs;
+  PrecompiledFunction function;
+};
+
+bool IsSameInput(const PrecompiledInput& lhs, const PrecompiledInput& rhs) {
+  return lhs.name == rhs.name && lhs.type == rhs.type;
+}
+
+bool IsSameInput(const PrecompiledInput& lhs,
+                 const parser::terms::InputVariable& rhs) {
+  return lhs.name == rhs.name && lhs.type == functions::ToString(rhs.type);
+}
+
+/// Whether the function of `entry` was generated with `inputs` declared
+template <typename Inputs>
+bool HasInputs(const Entry& entry, const Inputs& inputs) {
+  return std::ranges::equal(
+      entry.inputs, inputs,
+      [](const auto& lhs, const auto& rhs) { return IsSameInput(lhs, rhs); });
+}
+
+struct Registry {
+  std::mutex mutex;
+  std::unordered_multimap<uint64_t, Entry> functions;
+};
+
+// NB: Function-local static: registration happens during static
+// initialization of other translation units
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+}  // namespace
+
+uint64_t HashSource(std::string_view source) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const char c : source) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool RegisterPrecompiled(std::string_view source, PrecompiledFunction function,
+                         std::span<const PrecompiledInput> inputs) {
+  const uint64_t hash = HashSource(source);
+
+  Registry& registry = GetRegistry();
+  const std::lock_guard lock{registry.mutex};
+  const auto [begin, end] = registry.functions.equal_range(hash);
+  for (auto it = begin; it != end; ++it) {
+    if (it->second.source == source && HasInputs(it->second, inputs)) {
+      return false;
+    }
+  }
+  registry.functions.emplace(hash, Entry{source, inputs, function});
+  return true;
+}
+
+PrecompiledFunction FindPrecompiled(
+    std::string_view source, const parser::terms::InputSchema& inputs) {
+  const uint64_t hash = HashSource(source);
+
+  Registry& registry = GetRegistry();
+  const std::lock_guard lock{registry.mutex};
+  const auto [begin, end] = registry.functions.equal_range(hash);
+  for (auto it = begin; it != end; ++it) {
+    if (it->second.source == source && HasInputs(it->second, inputs)) {
+      return it->second.function;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace magl::executer
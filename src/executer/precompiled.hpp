@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <executer/context.hpp>
+#include <parser/terms/input-schema.hpp>
+#include <value/value.hpp>
+
+namespace magl::executer {
+
+// Registry of expressions compiled ahead of time by codegen/ (see
+// codegen::GenerateCpp). Generated translation units register themselves
+// during static initialization. Functions are looked up by the hash of the
+// source, the source is compared to rule out hash collisions. A function is
+// only used with the declared inputs it was generated with, since it reads
+// the inputs and the placeholders that follow them by position.
+
+using PrecompiledFunction = value::Value (*)(const EvaluationContext&);
+
+/// Declared input of a precompiled function, the type is functions::ToString
+/// of the input type
+struct PrecompiledInput {
+  std::string_view name;
+  std::string_view type;
+};
+
+/// 64-bit FNV-1a hash of an expression source
+uint64_t HashSource(std::string_view source);
+
+/// `source` and `inputs` must outlive the registry (constants in generated
+/// code). Returns whether the function is registered, i.e. there was no
+/// function for the same source and inputs
+bool RegisterPrecompiled(std::string_view source, PrecompiledFunction function,
+                         std::span<const PrecompiledInput> inputs = {});
+
+/// Returns nullptr if there is no function for the source that was generated
+/// with the same declared inputs
+PrecompiledFunction FindPrecompiled(
+    std::string_view source, const parser::terms::InputSchema& inputs = {});
+
+}  // namespace magl::executer
@@ -0,0 +1,151 @@
+#include <executer/profile.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <functions/library/thunk.hpp>
+
+namespace magl::executer {
+
+namespace {
+
+uint64_t ReadCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/// Exits the node even if its evaluation throws
+class ScopedEnter {
+ public:
+  ScopedEnter(Profiler* profiler, size_t node) : profiler_(profiler) {
+    profiler_->Enter(node);
+  }
+
+  ~ScopedEnter() { profiler_->Exit(); }
+
+ private:
+  Profiler* profiler_;
+};
+
+}  // namespace
+
+Profiler::Profiler(AllocationCounter allocation_counter)
+    : allocation_counter_(allocation_counter), paths_(1) {}
+
+size_t Profiler::AddNode(std::string label) {
+  // Frames of the folded format are separated by ';'
+  std::replace(label.begin(), label.end(), ';', ',');
+  labels_.push_back(std::move(label));
+  return labels_.size() - 1;
+}
+
+void Profiler::Enter(size_t node) {
+  const size_t parent = frames_.empty() ? 0 : frames_.back().path;
+  const size_t path = FindChild(parent, node);
+  frames_.push_back({.path = path});
+  Frame& frame = frames_.back();
+  frame.start_allocated = ReadAllocated();
+  // NB: Read last, so that the bookkeeping is not counted
+  frame.start_cycles = ReadCycles();
+}
+
+void Profiler::Exit() {
+  const uint64_t cycles = ReadCycles() - frames_.back().start_cycles;
+  const uint64_t allocated =
+      ReadAllocated() - frames_.back().start_allocated;
+  const Frame frame = frames_.back();
+  frames_.pop_back();
+
+  ProfileCounters& counters = paths_[frame.path].counters;
+  ++counters.calls;
+  counters.inclusive_cycles += cycles;
+  counters.exclusive_cycles += cycles - std::min(cycles, frame.children_cycles);
+  counters.allocated_bytes +=
+      allocated - std::min(allocated, frame.children_allocated);
+  if (!frames_.empty()) {
+    frames_.back().children_cycles += cycles;
+    frames_.back().children_allocated += allocated;
+  }
+}
+
+std::vector<ProfileEntry> Profiler::GetEntries() const {
+  std::vector<ProfileEntry> result;
+  for (size_t path = 1; path < paths_.size(); ++path) {
+    result.push_back({
+        .stack = GetStack(path),
+        .counters = paths_[path].counters,
+    });
+  }
+  return result;
+}
+
+std::string Profiler::GetFoldedStacks(ProfileMetric metric) const {
+  std::string result;
+  for (size_t path = 1; path < paths_.size(); ++path) {
+    const ProfileCounters& counters = paths_[path].counters;
+    const uint64_t value = metric == ProfileMetric::kExclusiveCycles
+                               ? counters.exclusive_cycles
+                               : counters.allocated_bytes;
+    if (value == 0) {
+      continue;
+    }
+    const std::vector<std::string> stack = GetStack(path);
+    for (size_t i = 0; i < stack.size(); ++i) {
+      if (i > 0) {
+        result.push_back(';');
+      }
+      result += stack[i];
+    }
+    result += std::format(" {}\n", value);
+  }
+  return result;
+}
+
+void Profiler::Reset() {
+  for (CallPath& path : paths_) {
+    path.counters = {};
+  }
+}
+
+size_t Profiler::FindChild(size_t parent, size_t node) {
+  for (const auto& [child_node, child] : paths_[parent].children) {
+    if (child_node == node) {
+      return child;
+    }
+  }
+  paths_.push_back({.node = node, .parent = parent});
+  const size_t child = paths_.size() - 1;
+  paths_[parent].children.emplace_back(node, child);
+  return child;
+}
+
+uint64_t Profiler::ReadAllocated() const {
+  return allocation_counter_ ? allocation_counter_() : 0;
+}
+
+std::vector<std::string> Profiler::GetStack(size_t path) const {
+  std::vector<std::string> result;
+  for (; path != 0; path = paths_[path].parent) {
+    result.push_back(labels_[paths_[path].node]);
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+void ProfileNode::Evaluate(functions::ArgsContainer* args,
+                           functions::ValueHolder* to) {
+  const ScopedEnter enter{profiler_, node_};
+  functions::library::Force(&args->at(0), to);
+}
+
+}  // namespace magl::executer
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <functions/evaluatable.hpp>
+
+namespace magl::executer {
+
+/// Returns the number of bytes allocated by the calling thread so far, e.g.
+/// jemalloc's thread.allocated or the counter of a replaced operator new
+using AllocationCounter = uint64_t (*)();
+
+struct ProfileCounters {
+  uint64_t calls = 0;
+  // Cycles of the time stamp counter (nanoseconds where there is none)
+  uint64_t inclusive_cycles = 0;
+  // Without the profiled nodes called by the node
+  uint64_t exclusive_cycles = 0;
+  // Allocated by the node itself, 0 without an AllocationCounter
+  uint64_t allocated_bytes = 0;
+};
+
+/// Counters of a call path: the labels of the nodes from the outermost one
+struct ProfileEntry {
+  std::vector<std::string> stack;
+  ProfileCounters counters;
+};
+
+enum class ProfileMetric {
+  kExclusiveCycles = 0,
+  kAllocatedBytes = 1,
+};
+
+/// Counts the evaluations of profiled nodes by call path, see
+/// ExpressionOptions::profile. Not thread-safe, as the evaluation itself
+class Profiler {
+ public:
+  explicit Profiler(AllocationCounter allocation_counter = nullptr);
+
+  /// Registers a node of the tree, returns its id for Enter
+  size_t AddNode(std::string label);
+
+  void Enter(size_t node);
+  /// Exits the innermost entered node
+  void Exit();
+
+  /// Returns the counters of each call path in the order of first calls
+  std::vector<ProfileEntry> GetEntries() const;
+
+  /// Returns the call paths in the folded stack format of flamegraph tools: a
+  /// line per path with its frames separated by ';' and the metric
+  std::string GetFoldedStacks(
+      ProfileMetric metric = ProfileMetric::kExclusiveCycles) const;
+
+  /// Drops the counters, the nodes are kept
+  void Reset();
+
+ private:
+  struct CallPath {
+    size_t node = 0;
+    size_t parent = 0;
+    ProfileCounters counters{};
+    // Call paths of the nodes called from this one by node
+    std::vector<std::pair<size_t, size_t>> children{};
+  };
+
+  struct Frame {
+    size_t path = 0;
+    uint64_t start_cycles = 0;
+    uint64_t start_allocated = 0;
+    uint64_t children_cycles = 0;
+    uint64_t children_allocated = 0;
+  };
+
+  size_t FindChild(size_t parent, size_t node);
+  uint64_t ReadAllocated() const;
+  std::vector<std::string> GetStack(size_t path) const;
+
+ private:
+  const AllocationCounter allocation_counter_;
+  std::vector<std::string> labels_;
+  // Call path 0 is the root that is not a node
+  std::vector<CallPath> paths_;
+  std::vector<Frame> frames_;
+};
+
+/// Evaluates its lazy argument, the profiled node, between Enter and Exit
+class ProfileNode : public functions::IEvaluatable {
+ public:
+  ProfileNode(Profiler* profiler, size_t node)
+      : profiler_(profiler), node_(node) {}
+
+  void Evaluate(functions::ArgsContainer* args,
+                functions::ValueHolder* to) override;
+
+ private:
+  Profiler* profiler_;
+  const size_t node_;
+};
+
+}  // namespace magl::executer
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bitset>
 #include <vector>
 
 #include <functions/evaluatable.hpp>
@@ -10,6 +11,8 @@ namespace magl::executer {
 struct EvaluationTree {
   std::vector<EvaluationTree> args;
   std::unique_ptr<functions::IEvaluatable> implementation;
+  /// Arguments that are passed unevaluated as a thunk (`EvaluationTree*`)
+  std::bitset<functions::kMaxArgs> lazy_args{};
 };
 
 }  // namespace magl::executer
@@ -0,0 +1,94 @@
+#include <executer/tiering.hpp>
+
+#include <exception>
+
+#include <executer/constant-folding.hpp>
+
+namespace magl::executer {
+
+TieredCode::TieredCode(parser::terms::SemanticGraph graph,
+                       TieringOptions options)
+    : graph_(std::move(graph)), options_(std::move(options)) {}
+
+TieredCode::~TieredCode() { Wait(); }
+
+const CompiledClosure* TieredCode::Enter() {
+  if (const CompiledClosure* optimized =
+          optimized_.load(std::memory_order_acquire)) {
+    // NB: Deoptimized code is not speculated again: the counter is past the
+    // threshold
+    if (options_.speculate_after > 0 &&
+        optimized_evaluations_++ == options_.speculate_after) {
+      Start(&TieredCode::Speculate);
+      return optimized_.load(std::memory_order_acquire);
+    }
+    return optimized;
+  }
+
+  // NB: Exactly one evaluation observes the threshold
+  if (evaluations_.fetch_add(1, std::memory_order_relaxed) !=
+      options_.threshold) {
+    return nullptr;
+  }
+  Start(&TieredCode::Compile);
+  return optimized_.load(std::memory_order_acquire);
+}
+
+const CompiledClosure* TieredCode::Deoptimize() {
+  optimized_.store(&generic_, std::memory_order_release);
+  return &generic_;
+}
+
+bool TieredCode::IsOptimized() const {
+  return optimized_.load(std::memory_order_acquire) != nullptr;
+}
+
+bool TieredCode::IsSpeculative() const {
+  return optimized_.load(std::memory_order_acquire) == &speculative_;
+}
+
+void TieredCode::Wait() {
+  if (compiler_.joinable()) {
+    compiler_.join();
+  }
+}
+
+void TieredCode::Start(void (TieredCode::*compile)()) {
+  Wait();
+  if (options_.background) {
+    compiler_ = std::thread(compile, this);
+  } else {
+    (this->*compile)();
+  }
+}
+
+void TieredCode::Compile() {
+  try {
+    folded_ = FoldConstants(graph_);
+    generic_ = CompileClosure(
+        folded_, ClosureOptions{
+                     .inputs = &options_.inputs,
+                     .record_profile =
+                         options_.speculate_after > 0 ? &profile_ : nullptr,
+                 });
+  } catch (const std::exception&) {
+    // Not supported by the closure backend: stay in the interpreter
+    return;
+  }
+  optimized_.store(&generic_, std::memory_order_release);
+}
+
+void TieredCode::Speculate() {
+  try {
+    speculative_ =
+        CompileClosure(folded_, ClosureOptions{
+                                    .inputs = &options_.inputs,
+                                    .speculate = &profile_,
+                                });
+  } catch (const std::exception&) {
+    return;
+  }
+  optimized_.store(&speculative_, std::memory_order_release);
+}
+
+}  // namespace magl::executer
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include <executer/closure.hpp>
+#include <executer/type-profile.hpp>
+#include <parser/terms/input-schema.hpp>
+#include <parser/terms/semantic-graph.hpp>
+
+namespace magl::executer {
+
+// Tiered execution: an expression starts in the tree interpreter, which is
+// cheap to build, and counts its evaluations. Once the count crosses a
+// threshold the expression is re-lowered into the optimized tier: constants
+// are folded (see constant-folding.hpp) and the graph is compiled by the
+// closure backend, which fuses nodes and specializes them on value
+// representations. The optimized code is published with a single atomic store,
+// so evaluations never wait for the compilation.
+//
+// With speculation the optimized code also profiles runtime types of values of
+// type Any. After more evaluations it is compiled once more, specialized on the
+// profile (see ClosureOptions::speculate). If a guard of the speculative code
+// fails, the expression is deoptimized back to the generic optimized code for
+// good.
+
+struct TieringOptions {
+  // Number of evaluations by the interpreter
+  size_t threshold = 0;
+  // Whether the code is compiled by a background thread
+  bool background = true;
+  // Number of profiled evaluations by the optimized code before the
+  // speculative compilation. 0 disables speculation
+  size_t speculate_after = 0;
+  // Inputs the graph is parsed with
+  parser::terms::InputSchema inputs;
+};
+
+class TieredCode {
+ public:
+  TieredCode(parser::terms::SemanticGraph graph, TieringOptions options);
+
+  TieredCode(const TieredCode&) = delete;
+  TieredCode& operator=(const TieredCode&) = delete;
+
+  /// Waits for the compilation
+  ~TieredCode();
+
+  /// Counts an evaluation. Returns nullptr while the expression stays in the
+  /// interpreter
+  const CompiledClosure* Enter();
+
+  /// Called when the code returned by Enter throws DeoptimizationError.
+  /// Returns the generic code to evaluate the expression with
+  const CompiledClosure* Deoptimize();
+
+  /// Whether the optimized code is installed
+  bool IsOptimized() const;
+
+  /// Whether the speculative code is installed
+  bool IsSpeculative() const;
+
+  /// Blocks until a started compilation is over
+  void Wait();
+
+ private:
+  void Start(void (TieredCode::*compile)());
+
+  void Compile();
+
+  void Speculate();
+
+ private:
+  const parser::terms::SemanticGraph graph_;
+  const TieringOptions options_;
+
+  std::atomic<size_t> evaluations_ = 0;
+  size_t optimized_evaluations_ = 0;
+
+  // Written by the compilation before it is published by `optimized_`
+  parser::terms::SemanticGraph folded_;
+  TypeProfile profile_;
+  CompiledClosure generic_;
+  CompiledClosure speculative_;
+
+  std::atomic<const CompiledClosure*> optimized_ = nullptr;
+
+  std::thread compiler_;
+};
+
+}  // namespace magl::executer
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <parser/terms/semantic-graph.hpp>
+#include <value/value.hpp>
+
+namespace magl::executer {
+
+/// Runtime types of the values of a term of type Any
+class SiteProfile {
+ public:
+  // NB: Written by evaluations and read by a background compilation
+  void Record(const value::Value& v) {
+    const uint32_t bit = uint32_t{1} << v.which();
+    if (!(observed_.load(std::memory_order_relaxed) & bit)) {
+      observed_.fetch_or(bit, std::memory_order_relaxed);
+    }
+  }
+
+  /// Whether all observed values are V
+  template <typename V>
+  bool IsMonomorphic() const {
+    static const uint32_t kBit = uint32_t{1} << value::Value{V{}}.which();
+    return observed_.load(std::memory_order_relaxed) == kBit;
+  }
+
+ private:
+  std::atomic<uint32_t> observed_ = 0;
+};
+
+/// Profiles of terms of type Any of a semantic graph, keyed by the address of
+/// a term. The graph must outlive the profile
+class TypeProfile {
+ public:
+  /// Not thread-safe: sites are added by the compilation only
+  SiteProfile* AddSite(const parser::terms::Term* term) {
+    return &sites_[term];
+  }
+
+  /// Returns nullptr if the term is not profiled
+  const SiteProfile* FindSite(const parser::terms::Term* term) const {
+    const auto find_site = sites_.find(term);
+    return find_site == sites_.end() ? nullptr : &find_site->second;
+  }
+
+ private:
+  std::unordered_map<const parser::terms::Term*, SiteProfile> sites_;
+};
+
+/// Thrown by a guard of speculative code when a value does not match the
+/// profile the code is specialized on
+struct DeoptimizationError : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+}  // namespace magl::executer
@@ -6,6 +6,7 @@
 #include <functions/evaluatable.hpp>
 #include <functions/type.hpp>
 #include <functions/utils/type-equivalent.hpp>
+#include <value/value.hpp>
 
 namespace magl::functions {
 
@@ -27,6 +28,29 @@ class PolymorphicFunctionFactory {
   virtual std::unique_ptr<IEvaluatable> GetImplementation(
       const Type& specific_type) = 0;
 
+  /// Returns an implementation of `specific_type` with argument `i` bound to
+  /// a compile-time constant or nullptr if there is no such specialization.
+  /// The specialization takes the rest of the arguments in the same order
+  virtual std::unique_ptr<IEvaluatable> GetImplementationWithConstant(
+      const Type& /*specific_type*/, size_t /*i*/,
+      const value::Value& /*constant*/) {
+    return nullptr;
+  }
+
+  /// Whether argument `i` is passed unevaluated as a thunk, see
+  /// library/thunk.hpp
+  virtual bool IsLazyArgument(size_t /*i*/) const { return false; }
+
+  /// Whether the implementation expects argument `i` as a borrowed value, i.e.
+  /// a `const V*` to a value that outlives the call, instead of an owned V
+  virtual bool BorrowsArgument(size_t /*i*/) const { return false; }
+
+  /// Whether the implementation of `specific_type` returns a borrowed value
+  /// (`const V*`) that points into its borrowed arguments
+  virtual bool LendsResult(const Type& /*specific_type*/) const {
+    return false;
+  }
+
   virtual ~PolymorphicFunctionFactory() = default;
 
  private:
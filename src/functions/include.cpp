@@ -6,6 +6,7 @@
 #include <functions/library/ducttape-get-var.hpp>
 #include <functions/library/ducttape-var-map-at.hpp>
 #include <functions/library/insert.hpp>
+#include <functions/library/logic.hpp>
 #include <functions/library/map.hpp>
 #include <functions/library/multiply.hpp>
 
@@ -22,6 +23,9 @@ FunctionsLibrary MakeDefaultLibrary() {
   result.emplace("GetVar", std::make_unique<library::GetVar>());
   result.emplace("VarMapAt", std::make_unique<library::VarMapAt>());
   result.emplace("Map", std::make_unique<library::Map>());
+  result.emplace("And", std::make_unique<library::And>());
+  result.emplace("Or", std::make_unique<library::Or>());
+  result.emplace("If", std::make_unique<library::If>());
 
   return result;
 }
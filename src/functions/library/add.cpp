@@ -2,53 +2,81 @@
 
 #include <value/value.hpp>
 
+#include <type_traits>
+
 namespace magl::functions::library {
 
 namespace {
 
+template <typename V>
+constexpr bool kIsNumber = std::is_same_v<V, value::IntegerValue> ||
+                           std::is_same_v<V, value::FloatValue>;
+
 struct AddAnyVisitor : boost::static_visitor<value::Value> {
   AddAnyVisitor() = default;
 
-  result_type operator()(value::IntegerValue lhs, value::Value rhs) const {
-    if (boost::get<value::IntegerValue>(&rhs)) {
-      return value::IntegerValue{lhs + boost::get<value::IntegerValue>(rhs)};
-    }
-    if (boost::get<value::FloatValue>(&rhs)) {
-      return value::FloatValue{lhs + boost::get<value::FloatValue>(rhs)};
+  template <typename L, typename R>
+  result_type operator()(const L& lhs, const R& rhs) const {
+    if constexpr (kIsNumber<L> && kIsNumber<R>) {
+      if constexpr (std::is_same_v<L, value::IntegerValue> &&
+                    std::is_same_v<R, value::IntegerValue>) {
+        return value::IntegerValue{lhs + rhs};
+      } else {
+        return value::FloatValue{lhs + rhs};
+      }
+    } else if constexpr (std::is_same_v<L, value::StringValue> &&
+                         std::is_same_v<R, value::StringValue>) {
+      return value::StringValue{lhs + rhs};
+    } else if constexpr (std::is_same_v<L, value::IntegerValue>) {
+      throw std::invalid_argument(
+          "Integer value can only be added to integer or float value.");
+    } else if constexpr (std::is_same_v<L, value::FloatValue>) {
+      throw std::invalid_argument(
+          "Float value can only be added to integer or float value.");
+    } else if constexpr (std::is_same_v<L, value::StringValue>) {
+      throw std::invalid_argument(
+          "String value can only be added to string value.");
+    } else {
+      throw std::invalid_argument(
+          "Only integer, float and string values can be added.");
     }
-    throw std::invalid_argument(
-        "Integer value can only be added to integer or float value.");
-  }
-  result_type operator()(value::FloatValue /*lhs*/,
-                         value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
-  }
-  result_type operator()(value::BoolValue /*lhs*/, value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
-  }
-  result_type operator()(value::StringValue /*lhs*/,
-                         value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
-  }
-  result_type operator()(value::NullValue /*lhs*/, value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
-  }
-  result_type operator()(value::LambdaValue /*lhs*/,
-                         value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
-  }
-  result_type operator()(value::ObjectValue /*lhs*/,
-                         value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
-  }
-  result_type operator()(value::ArrayValue /*lhs*/,
-                         value::Value /*rhs*/) const {
-    throw std::logic_error("Not implemented.");
   }
 };
 
+template <typename L, typename R>
+value::Value AddKernel(const value::Value& lhs, const value::Value& rhs) {
+  return AddAnyVisitor{}(*boost::get<L>(&lhs), *boost::get<R>(&rhs));
+}
+
 }  // namespace
 
+value::Value AddAny(const value::Value& lhs, const value::Value& rhs) {
+  return boost::apply_visitor(AddAnyVisitor{}, lhs, rhs);
+}
+
+utils::BinaryInlineCache::Kernel FindAddKernel(const value::Value& lhs,
+                                               const value::Value& rhs) {
+  if (boost::get<value::IntegerValue>(&lhs)) {
+    if (boost::get<value::IntegerValue>(&rhs)) {
+      return &AddKernel<value::IntegerValue, value::IntegerValue>;
+    }
+    if (boost::get<value::FloatValue>(&rhs)) {
+      return &AddKernel<value::IntegerValue, value::FloatValue>;
+    }
+  } else if (boost::get<value::FloatValue>(&lhs)) {
+    if (boost::get<value::IntegerValue>(&rhs)) {
+      return &AddKernel<value::FloatValue, value::IntegerValue>;
+    }
+    if (boost::get<value::FloatValue>(&rhs)) {
+      return &AddKernel<value::FloatValue, value::FloatValue>;
+    }
+  } else if (boost::get<value::StringValue>(&lhs) &&
+             boost::get<value::StringValue>(&rhs)) {
+    return &AddKernel<value::StringValue, value::StringValue>;
+  }
+  return nullptr;
+}
+
 const Type Add::kType = FunctionType{
     TypeVariable{'X'}, FunctionType{TypeVariable{'X'}, TypeVariable{'X'}}};
 
@@ -58,6 +86,11 @@ void AddIntImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
       std::move(*reinterpret_cast<value::IntegerValue*>(&args->at(1)));
 }
 
+void AddIntConstImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
+  *reinterpret_cast<value::IntegerValue*>(to) =
+      *reinterpret_cast<value::IntegerValue*>(&args->at(0)) + constant_;
+}
+
 void AddFloatImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
   *reinterpret_cast<value::FloatValue*>(to) =
       std::move(*reinterpret_cast<value::FloatValue*>(&args->at(0))) +
@@ -71,10 +104,12 @@ void AddStringImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
 }
 
 void AddAnyImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
-  new (reinterpret_cast<value::Value*>(to)) value::Value(boost::apply_visitor(
-      AddAnyVisitor{},
-      std::move(*reinterpret_cast<value::Value*>(&args->at(0))),
-      std::move(*reinterpret_cast<value::Value*>(&args->at(1)))));
+  // NB: Arguments are moved out of their holders, which are not destroyed
+  const value::Value lhs =
+      std::move(*reinterpret_cast<value::Value*>(&args->at(0)));
+  const value::Value rhs =
+      std::move(*reinterpret_cast<value::Value*>(&args->at(1)));
+  new (reinterpret_cast<value::Value*>(to)) value::Value(cache_.Call(lhs, rhs));
 }
 
 }  // namespace magl::functions::library
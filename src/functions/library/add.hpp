@@ -1,13 +1,33 @@
 #pragma once
 
 #include <functions/function-factory.hpp>
+#include <functions/utils/inline-cache.hpp>
+#include <value/value.hpp>
 
 namespace magl::functions::library {
 
+/// Adds values of type Any
+value::Value AddAny(const value::Value& lhs, const value::Value& rhs);
+
+/// Returns the typed kernel of AddAny for the runtime types of the operands
+utils::BinaryInlineCache::Kernel FindAddKernel(const value::Value& lhs,
+                                               const value::Value& rhs);
+
 struct AddIntImpl : IEvaluatable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override;
 };
 
+/// Fused Add(X, const) for integers
+class AddIntConstImpl : public IEvaluatable {
+ public:
+  AddIntConstImpl(int64_t constant) : constant_(constant) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+
+ private:
+  const int64_t constant_;
+};
+
 struct AddFloatImpl : IEvaluatable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override;
 };
@@ -16,8 +36,12 @@ struct AddStringImpl : IEvaluatable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override;
 };
 
-struct AddAnyImpl : IEvaluatable {
+class AddAnyImpl : public IEvaluatable {
+ public:
   void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+
+ private:
+  utils::BinaryInlineCache cache_{&FindAddKernel, &AddAny};
 };
 
 class Add : public PolymorphicFunctionFactory {
@@ -51,9 +51,7 @@ struct MakeAppendImplVisitor
   }
 
   result_type operator()(const functions::AnyType&) const {
-    throw std::invalid_argument(
-        "Append: Dict[Any] -> String -> Any -> Dict[Any] is not "
-        "supported. TODO: add support.");
+    return std::make_unique<AppendImpl<value::Value>>();
   }
 
   result_type operator()(const functions::ListType& /*tau*/) const {
@@ -21,8 +21,24 @@ class Apply : public IEvaluatable {
         ->Evaluate(args, to);
   }
 
+  IEvaluatable* GetApplied() const { return apply_me_.get(); }
+
  private:
   std::unique_ptr<IEvaluatable> apply_me_;
 };
 
+/// Fused Apply(FetchVariable): applies a function held by a variable
+class ApplyVariable : public IEvaluatable {
+ public:
+  ApplyVariable(const ValueHolder* location) : variable_location_(location) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    (*reinterpret_cast<IEvaluatable* const*>(variable_location_))
+        ->Evaluate(args, to);
+  }
+
+ private:
+  const ValueHolder* variable_location_;
+};
+
 }  // namespace magl::functions::library
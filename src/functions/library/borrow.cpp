@@ -0,0 +1,15 @@
+#include <functions/library/borrow.hpp>
+
+#include <functions/utils/value-type.hpp>
+
+namespace magl::functions::library {
+
+std::unique_ptr<IEvaluatable> MakeCopyBorrowedImpl(const Type& value_type) {
+  return utils::MakeForValueType<CopyBorrowedImpl>(value_type);
+}
+
+std::unique_ptr<IEvaluatable> MakeLendImpl(const Type& value_type) {
+  return utils::MakeForValueType<LendImpl>(value_type);
+}
+
+}  // namespace magl::functions::library
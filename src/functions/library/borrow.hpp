@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <functions/evaluatable.hpp>
+#include <functions/type.hpp>
+#include <value/value.hpp>
+
+namespace magl::functions::library {
+
+// NB: A borrowed value is held as `const V*` to a value owned by someone else
+// (a variable location, an input or a parent container) which stays valid for
+// the rest of the evaluation. Values are borrowed to avoid copying strings and
+// containers that are only read, and copied when they escape into a result.
+
+/// Copies a borrowed value into an owned one
+template <typename V>
+struct CopyBorrowedImpl : IEvaluatable {
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    new (reinterpret_cast<V*>(to))
+        V(**reinterpret_cast<const V**>(&args->at(0)));
+  }
+};
+
+/// Takes ownership of a value and lends it until the next evaluation
+template <typename V>
+class LendImpl : public IEvaluatable {
+ public:
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    V* value = reinterpret_cast<V*>(&args->at(0));
+    held_ = std::move(*value);
+    std::destroy_at(value);
+    *reinterpret_cast<const V**>(to) = &held_.value();
+  }
+
+ private:
+  std::optional<V> held_;
+};
+
+std::unique_ptr<IEvaluatable> MakeCopyBorrowedImpl(const Type& value_type);
+
+std::unique_ptr<IEvaluatable> MakeLendImpl(const Type& value_type);
+
+}  // namespace magl::functions::library
@@ -1,23 +1,12 @@
 #pragma once
 
-#include <type_traits>
-
 #include <functions/function-factory.hpp>
+#include <functions/library/borrow.hpp>
 #include <value/value.hpp>
 
 namespace magl::functions::library {
 
-template <typename V>
-// Trivially copiable
-requires std::is_same_v<V, value::IntegerValue> ||
-         std::is_same_v<V, value::BoolValue>
-struct GetVarImpl : IEvaluatable {
-  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
-    // Copying
-    *reinterpret_cast<V*>(to) = **reinterpret_cast<V**>(&args->at(0));
-  }
-};
-
+/// Copies the value of a variable
 class GetVar : public PolymorphicFunctionFactory {
   const static Type kType;
 
@@ -26,14 +15,16 @@ class GetVar : public PolymorphicFunctionFactory {
 
   virtual std::unique_ptr<IEvaluatable> GetImplementation(
       const Type& specific_type) override {
-    if (specific_type == Type{FunctionType{IntegerType{}, IntegerType{}}}) {
-      return std::make_unique<GetVarImpl<value::IntegerValue>>();
-    } else if (specific_type == Type{FunctionType{BoolType{}, BoolType{}}}) {
-      return std::make_unique<GetVarImpl<value::BoolValue>>();
+    const FunctionType* type = boost::get<FunctionType>(&specific_type);
+    if (!type || !(type->argument == type->body)) {
+      throw UnsupportedType(
+          std::format("f=GetVar, t={}", ToString(specific_type)));
     }
-    throw UnsupportedType("GetVar is only implemented for integer and string");
+    return MakeCopyBorrowedImpl(type->argument);
   }
 
+  bool BorrowsArgument(size_t i) const override { return i == 0; }
+
  private:
 };
 
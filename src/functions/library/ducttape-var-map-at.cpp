@@ -1,8 +1,59 @@
 #include <functions/library/ducttape-var-map-at.hpp>
 
+#include <functions/utils/value-type.hpp>
+
 namespace magl::functions::library {
 
 const Type VarMapAt::kType = FunctionType{
     DictType{TypeVariable{'X'}}, FunctionType{StringType{}, TypeVariable{'X'}}};
 
+std::unique_ptr<IEvaluatable> VarMapAt::GetImplementation(
+    const Type& specific_type) {
+  const Type& x_type = GetItemType(specific_type);
+  if (LendsResult(specific_type)) {
+    return utils::MakeForValueType<VarMapAtBorrowedImpl>(x_type);
+  }
+  return utils::MakeForValueType<VarMapAtImpl>(x_type);
+}
+
+std::unique_ptr<IEvaluatable> VarMapAt::GetImplementationWithConstant(
+    const Type& specific_type, size_t i, const value::Value& constant) {
+  if (i != 1 || !boost::get<value::StringValue>(&constant)) {
+    return nullptr;
+  }
+
+  const Type& x_type = GetItemType(specific_type);
+  const std::string& key = boost::get<value::StringValue>(constant);
+  if (LendsResult(specific_type)) {
+    return utils::MakeForValueType<VarMapAtConstBorrowedImpl>(x_type, key);
+  }
+  return utils::MakeForValueType<VarMapAtConstImpl>(x_type, key);
+}
+
+bool VarMapAt::LendsResult(const Type& specific_type) const {
+  return !utils::IsTriviallyCopied(GetItemType(specific_type));
+}
+
+const Type& VarMapAt::GetItemType(const Type& specific_type) const {
+  // Dict[X] -> String -> X or Schema{..., key: X, ...} -> String -> X, see the
+  // inference of field access
+  const FunctionType* type = boost::get<FunctionType>(&specific_type);
+  const FunctionType* body =
+      type ? boost::get<FunctionType>(&type->body) : nullptr;
+  if (!body || !boost::get<StringType>(&body->argument)) {
+    throw UnsupportedType(
+        std::format("f=VarMapAt, t={}", ToString(specific_type)));
+  }
+  if (const auto* dict = boost::get<DictType>(&type->argument)) {
+    if (dict->value_type == body->body) {
+      return body->body;
+    }
+  }
+  if (boost::get<SchemaType>(&type->argument)) {
+    return body->body;
+  }
+  throw UnsupportedType(
+      std::format("f=VarMapAt, t={}", ToString(specific_type)));
+}
+
 }  // namespace magl::functions::library
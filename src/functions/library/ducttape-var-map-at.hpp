@@ -1,21 +1,140 @@
 #pragma once
 
+#include <stdexcept>
 #include <type_traits>
 
 #include <functions/function-factory.hpp>
+#include <functions/library/fetch-variable.hpp>
 #include <value/value.hpp>
 
 namespace magl::functions::library {
 
+namespace impl {
+
+template <typename V, typename K>
+const V& GetItem(const value::ObjectValue& object, const K& key) {
+  // NB: Heterogeneous lookup, no std::string is constructed for the key
+  const auto it = object.find(key);
+  if (it == object.end()) {
+    throw std::out_of_range("VarMapAt: key is not found.");
+  }
+  if constexpr (std::is_same_v<V, value::Value>) {
+    return it->second;
+  } else {
+    return boost::get<V>(it->second);
+  }
+}
+
+}  // namespace impl
+
+/// Copies the item: cheaper than borrowing for trivially copyable values
 template <typename V>
 struct VarMapAtImpl : IEvaluatable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override {
-    // Copying
     const std::string& key =
         *reinterpret_cast<value::StringValue*>(&args->at(1));
-    new (reinterpret_cast<V*>(to)) V(boost::get<V>(
-        (*reinterpret_cast<value::ObjectValue**>(&args->at(0)))->at(key)));
+    new (reinterpret_cast<V*>(to)) V(impl::GetItem<V>(
+        **reinterpret_cast<const value::ObjectValue**>(&args->at(0)), key));
+  }
+};
+
+/// Lends the item of a borrowed object
+template <typename V>
+struct VarMapAtBorrowedImpl : IEvaluatable {
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    const std::string& key =
+        *reinterpret_cast<value::StringValue*>(&args->at(1));
+    *reinterpret_cast<const V**>(to) = &impl::GetItem<V>(
+        **reinterpret_cast<const value::ObjectValue**>(&args->at(0)), key);
+  }
+};
+
+/// VarMapAtImpl of a variable with a constant key
+template <typename V>
+class VarMapAtVariableImpl : public IEvaluatable {
+ public:
+  VarMapAtVariableImpl(const ValueHolder* location, std::string key)
+      : variable_location_(location),
+        key_(std::move(key)),
+        prehashed_key_(value::MakePrehashedKey(key_)) {}
+
+  void Evaluate(ArgsContainer*, ValueHolder* to) override {
+    new (reinterpret_cast<V*>(to)) V(impl::GetItem<V>(
+        *reinterpret_cast<const value::ObjectValue*>(variable_location_),
+        prehashed_key_));
+  }
+
+ private:
+  const ValueHolder* variable_location_;
+  const std::string key_;
+  const value::PrehashedKey prehashed_key_;
+};
+
+/// VarMapAtBorrowedImpl of a variable with a constant key
+template <typename V>
+class VarMapAtVariableBorrowedImpl : public IEvaluatable {
+ public:
+  VarMapAtVariableBorrowedImpl(const ValueHolder* location, std::string key)
+      : variable_location_(location),
+        key_(std::move(key)),
+        prehashed_key_(value::MakePrehashedKey(key_)) {}
+
+  void Evaluate(ArgsContainer*, ValueHolder* to) override {
+    *reinterpret_cast<const V**>(to) = &impl::GetItem<V>(
+        *reinterpret_cast<const value::ObjectValue*>(variable_location_),
+        prehashed_key_);
+  }
+
+ private:
+  const ValueHolder* variable_location_;
+  const std::string key_;
+  const value::PrehashedKey prehashed_key_;
+};
+
+/// VarMapAtImpl with a constant key hashed once at compile time
+template <typename V>
+class VarMapAtConstImpl : public IFusableWithVariable {
+ public:
+  VarMapAtConstImpl(std::string key)
+      : key_(std::move(key)), prehashed_key_(value::MakePrehashedKey(key_)) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    new (reinterpret_cast<V*>(to)) V(impl::GetItem<V>(
+        **reinterpret_cast<const value::ObjectValue**>(&args->at(0)),
+        prehashed_key_));
+  }
+
+  std::unique_ptr<IEvaluatable> FuseWithVariable(
+      const ValueHolder* location) const override {
+    return std::make_unique<VarMapAtVariableImpl<V>>(location, key_);
   }
+
+ private:
+  const std::string key_;
+  const value::PrehashedKey prehashed_key_;
+};
+
+/// VarMapAtBorrowedImpl with a constant key hashed once at compile time
+template <typename V>
+class VarMapAtConstBorrowedImpl : public IFusableWithVariable {
+ public:
+  VarMapAtConstBorrowedImpl(std::string key)
+      : key_(std::move(key)), prehashed_key_(value::MakePrehashedKey(key_)) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    *reinterpret_cast<const V**>(to) = &impl::GetItem<V>(
+        **reinterpret_cast<const value::ObjectValue**>(&args->at(0)),
+        prehashed_key_);
+  }
+
+  std::unique_ptr<IEvaluatable> FuseWithVariable(
+      const ValueHolder* location) const override {
+    return std::make_unique<VarMapAtVariableBorrowedImpl<V>>(location, key_);
+  }
+
+ private:
+  const std::string key_;
+  const value::PrehashedKey prehashed_key_;
 };
 
 class VarMapAt : public PolymorphicFunctionFactory {
@@ -25,26 +144,18 @@ class VarMapAt : public PolymorphicFunctionFactory {
   VarMapAt() : PolymorphicFunctionFactory(kType) {}
 
   virtual std::unique_ptr<IEvaluatable> GetImplementation(
-      const Type& specific_type) override {
-    if (specific_type ==
-        Type{FunctionType{DictType{IntegerType{}},
-                          FunctionType{StringType{}, IntegerType{}}}}) {
-      return std::make_unique<VarMapAtImpl<value::IntegerValue>>();
-    } else if (specific_type ==
-               Type{FunctionType{DictType{BoolType{}},
-                                 FunctionType{StringType{}, BoolType{}}}}) {
-      return std::make_unique<VarMapAtImpl<value::BoolValue>>();
-    } else if (specific_type ==
-               Type{FunctionType{DictType{StringType{}},
-                                 FunctionType{StringType{}, StringType{}}}}) {
-      return std::make_unique<VarMapAtImpl<value::StringValue>>();
-    }
-    // TODO: support other types
-    throw UnsupportedType(
-        std::format("f=VarMapAt, t={}", ToString(specific_type)));
-  }
+      const Type& specific_type) override;
+
+  std::unique_ptr<IEvaluatable> GetImplementationWithConstant(
+      const Type& specific_type, size_t i,
+      const value::Value& constant) override;
+
+  bool BorrowsArgument(size_t i) const override { return i == 0; }
+
+  bool LendsResult(const Type& specific_type) const override;
 
  private:
+  const Type& GetItemType(const Type& specific_type) const;
 };
 
 }  // namespace magl::functions::library
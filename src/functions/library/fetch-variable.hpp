@@ -2,8 +2,11 @@
 
 #include <functions/evaluatable.hpp>
 
+#include <memory>
+
 namespace magl::functions::library {
 
+/// Returns a variable value borrowed from its location
 class FetchVariable : public IEvaluatable {
  public:
   FetchVariable(const ValueHolder* location) : variable_location_(location) {}
@@ -16,6 +19,31 @@ class FetchVariable : public IEvaluatable {
     *reinterpret_cast<const ValueHolder**>(to) = variable_location_;
   }
 
+  const ValueHolder* GetVariableLocation() const { return variable_location_; }
+
+ private:
+  const ValueHolder* variable_location_;
+};
+
+/// Evaluatable that borrows its first argument and can read it from a
+/// variable location directly, see executer/peephole.hpp
+struct IFusableWithVariable : IEvaluatable {
+  /// Returns an equivalent evaluatable that takes no first argument
+  virtual std::unique_ptr<IEvaluatable> FuseWithVariable(
+      const ValueHolder* location) const = 0;
+};
+
+/// Returns a borrowed value that is stored in a variable location
+class FetchIndirectVariable : public IEvaluatable {
+ public:
+  FetchIndirectVariable(const ValueHolder* location)
+      : variable_location_(location) {}
+
+  void Evaluate(ArgsContainer*, ValueHolder* to) override {
+    *reinterpret_cast<const void**>(to) =
+        *reinterpret_cast<const void* const*>(variable_location_);
+  }
+
  private:
   const ValueHolder* variable_location_;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 #include <functions/evaluatable.hpp>
 #include <value/value.hpp>
 
@@ -9,12 +11,24 @@ template <typename OutputT>
 class GetValue : public IEvaluatable {
  public:
   GetValue(value::Value to_return)
-      : return_me_(std::move(boost::get<OutputT>(to_return))) {}
+      : return_me_(Unbox(std::move(to_return))) {}
 
   virtual void Evaluate(ArgsContainer*, ValueHolder* to) override {
     new (reinterpret_cast<OutputT*>(to)) OutputT(return_me_);
   }
 
+  const OutputT& GetConstant() const { return return_me_; }
+
+ private:
+  static OutputT Unbox(value::Value v) {
+    if constexpr (std::is_same_v<OutputT, value::Value>) {
+      // Constant of type Any stays boxed
+      return v;
+    } else {
+      return std::move(boost::get<OutputT>(v));
+    }
+  }
+
  private:
   const OutputT return_me_;
 };
@@ -31,6 +45,8 @@ class GetLambdaValue : public IEvaluatable {
     *reinterpret_cast<IEvaluatable**>(to) = evaluatable_.get();
   }
 
+  IEvaluatable* GetEvaluatable() const { return evaluatable_.get(); }
+
  private:
   std::unique_ptr<IEvaluatable> evaluatable_;
 };
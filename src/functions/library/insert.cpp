@@ -54,9 +54,7 @@ struct MakeInsertImplVisitor
   }
 
   result_type operator()(const functions::AnyType&) const {
-    throw std::invalid_argument(
-        "Insert: Dict[Any] -> String -> Any -> Dict[Any] is not "
-        "supported. TODO: add support.");
+    return std::make_unique<InsertImpl<value::Value>>();
   }
 
   result_type operator()(const functions::ListType& /*tau*/) const {
@@ -14,11 +14,11 @@ struct InsertImpl : public IEvaluatable {
  public:
   void Evaluate(ArgsContainer* args, ValueHolder* to) override {
     // Assuming that Dict[X] is represented as
-    // std::unordered_map<std::string, X>.
+    // std::unordered_map<std::string, X, ...>.
     // TODO: add corresonding type trait to eliminate this assumption
     // TODO: If direct value containers are supported, change map<string, Value>
     // to map<string, X>
-    using ObjectX = std::unordered_map<std::string, value::Value>;
+    using ObjectX = value::ObjectValue;
     new (reinterpret_cast<ObjectX*>(to))
         ObjectX(std::move(*reinterpret_cast<ObjectX*>(&args->at(0))));
 
@@ -3,6 +3,7 @@
 #include <executer/evaluate.hpp>
 #include <executer/expression.hpp>
 #include <functions/evaluatable.hpp>
+#include <functions/library/variable-slot.hpp>
 #include <functions/utils/value-type.hpp>
 #include <parser/terms/terms.hpp>
 #include <value/value.hpp>
@@ -28,27 +29,25 @@ class HoldVariable : public IEvaluatable {
 
 class Lambda : public IEvaluatable {
  public:
-  Lambda(std::unique_ptr<ValueHolder> arg_holder, executer::EvaluationTree body)
-      : arg_var_holder_(std::move(arg_holder)), body_(std::move(body)) {}
+  Lambda(std::unique_ptr<VariableSlot> arg, executer::EvaluationTree body)
+      : arg_(std::move(arg)), body_(std::move(body)) {}
 
-  static std::unique_ptr<ValueHolder> MakeVarHolder() {
-    return std::make_unique<ValueHolder>();
-  }
-
-  const ValueHolder* GetVariableLocation() const {
-    return arg_var_holder_.get();
-  }
+  const ValueHolder* GetVariableLocation() const { return arg_->GetLocation(); }
 
   void Evaluate(ArgsContainer* args, ValueHolder* to) override {
-    // Put argument to the variable location
-    *arg_var_holder_.get() = args->at(0);
+    // Move argument to the variable location, the argument of the previous
+    // call is destroyed
+    arg_->Relocate(&args->at(0));
 
     // Evaluate body
-    *to = executer::EvaluateTerm(body_);
+    executer::EvaluateTerm(body_, to);
   }
 
+  executer::EvaluationTree* GetBody() { return &body_; }
+  const executer::EvaluationTree* GetBody() const { return &body_; }
+
  private:
-  std::unique_ptr<ValueHolder> arg_var_holder_;
+  std::unique_ptr<VariableSlot> arg_;
   executer::EvaluationTree body_;
 };
 
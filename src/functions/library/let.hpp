@@ -0,0 +1,77 @@
+#pragma once
+
+#include <executer/evaluate.hpp>
+#include <executer/term.hpp>
+#include <functions/evaluatable.hpp>
+#include <functions/library/variable-slot.hpp>
+
+#include <memory>
+
+namespace magl::functions::library {
+
+/// Evaluates a definition into a variable slot and then evaluates a body that
+/// reads the variable by reference. The value is kept until the next
+/// evaluation
+class Let : public IEvaluatable {
+ public:
+  Let(std::unique_ptr<VariableSlot> var, executer::EvaluationTree definition,
+      executer::EvaluationTree body)
+      : var_(std::move(var)),
+        definition_(std::move(definition)),
+        body_(std::move(body)) {}
+
+  const ValueHolder* GetVariableLocation() const { return var_->GetLocation(); }
+
+  void Evaluate(ArgsContainer*, ValueHolder* to) override {
+    var_->Assign([this](ValueHolder* location) {
+      executer::EvaluateTerm(definition_, location);
+    });
+    executer::EvaluateTerm(body_, to);
+  }
+
+  executer::EvaluationTree* GetDefinition() { return &definition_; }
+  executer::EvaluationTree* GetBody() { return &body_; }
+  const executer::EvaluationTree* GetDefinition() const {
+    return &definition_;
+  }
+  const executer::EvaluationTree* GetBody() const { return &body_; }
+
+ private:
+  std::unique_ptr<VariableSlot> var_;
+  executer::EvaluationTree definition_;
+  executer::EvaluationTree body_;
+};
+
+/// Let in the function position of an application, e.g.
+/// `(let x = 1 in lambda y: y + x)(2)`: evaluates the definition into a
+/// variable slot and then applies the body to the arguments
+class ApplyLet : public IEvaluatable {
+ public:
+  ApplyLet(std::unique_ptr<VariableSlot> var,
+           executer::EvaluationTree definition,
+           std::unique_ptr<IEvaluatable> body)
+      : var_(std::move(var)),
+        definition_(std::move(definition)),
+        body_(std::move(body)) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    var_->Assign([this](ValueHolder* location) {
+      executer::EvaluateTerm(definition_, location);
+    });
+    body_->Evaluate(args, to);
+  }
+
+  executer::EvaluationTree* GetDefinition() { return &definition_; }
+  IEvaluatable* GetBody() { return body_.get(); }
+  const executer::EvaluationTree* GetDefinition() const {
+    return &definition_;
+  }
+  const IEvaluatable* GetBody() const { return body_.get(); }
+
+ private:
+  std::unique_ptr<VariableSlot> var_;
+  executer::EvaluationTree definition_;
+  std::unique_ptr<IEvaluatable> body_;
+};
+
+}  // namespace magl::functions::library
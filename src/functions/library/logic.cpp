@@ -0,0 +1,52 @@
+#include <functions/library/logic.hpp>
+
+#include <functions/library/thunk.hpp>
+#include <value/value.hpp>
+
+namespace magl::functions::library {
+
+const Type And::kType =
+    FunctionType{BoolType{}, FunctionType{BoolType{}, BoolType{}}};
+
+const Type Or::kType =
+    FunctionType{BoolType{}, FunctionType{BoolType{}, BoolType{}}};
+
+const Type If::kType = FunctionType{
+    BoolType{},
+    FunctionType{TypeVariable{'X'},
+                 FunctionType{TypeVariable{'X'}, TypeVariable{'X'}}}};
+
+void AndImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
+  if (!*reinterpret_cast<value::BoolValue*>(&args->at(0))) {
+    *reinterpret_cast<value::BoolValue*>(to) = false;
+    return;
+  }
+  Force(&args->at(1), to);
+}
+
+void OrImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
+  if (*reinterpret_cast<value::BoolValue*>(&args->at(0))) {
+    *reinterpret_cast<value::BoolValue*>(to) = true;
+    return;
+  }
+  Force(&args->at(1), to);
+}
+
+void IfImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
+  // NB: The branch is evaluated directly into the result, so the
+  // implementation does not depend on the type of branches
+  if (*reinterpret_cast<value::BoolValue*>(&args->at(0))) {
+    Force(&args->at(1), to);
+  } else {
+    Force(&args->at(2), to);
+  }
+}
+
+std::unique_ptr<IEvaluatable> If::GetImplementation(const Type& specific_type) {
+  if (!utils::IsInstanceOf(specific_type, kType)) {
+    throw UnsupportedType(std::format("f=If, t={}", ToString(specific_type)));
+  }
+  return std::make_unique<IfImpl>();
+}
+
+}  // namespace magl::functions::library
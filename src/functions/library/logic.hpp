@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functions/function-factory.hpp>
+
+namespace magl::functions::library {
+
+/// Evaluates rhs only if lhs is true
+struct AndImpl : IEvaluatable {
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+};
+
+/// Evaluates rhs only if lhs is false
+struct OrImpl : IEvaluatable {
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+};
+
+/// Evaluates only the chosen branch
+struct IfImpl : IEvaluatable {
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+};
+
+class And : public NonPolymorphicFunctionFactory {
+  // Bool -> Bool -> Bool
+  const static Type kType;
+
+ public:
+  And() : NonPolymorphicFunctionFactory(kType) {}
+
+  std::unique_ptr<IEvaluatable> GetImplementation() override {
+    return std::make_unique<AndImpl>();
+  }
+
+  bool IsLazyArgument(size_t i) const override { return i == 1; }
+};
+
+class Or : public NonPolymorphicFunctionFactory {
+  // Bool -> Bool -> Bool
+  const static Type kType;
+
+ public:
+  Or() : NonPolymorphicFunctionFactory(kType) {}
+
+  std::unique_ptr<IEvaluatable> GetImplementation() override {
+    return std::make_unique<OrImpl>();
+  }
+
+  bool IsLazyArgument(size_t i) const override { return i == 1; }
+};
+
+class If : public PolymorphicFunctionFactory {
+  // Bool -> X -> X -> X
+  const static Type kType;
+
+ public:
+  If() : PolymorphicFunctionFactory(kType) {}
+
+  std::unique_ptr<IEvaluatable> GetImplementation(
+      const Type& specific_type) override;
+
+  bool IsLazyArgument(size_t i) const override { return i == 1 || i == 2; }
+};
+
+}  // namespace magl::functions::library
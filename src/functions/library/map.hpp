@@ -1,12 +1,16 @@
 #pragma once
 
+#include <executer/budget.hpp>
 #include <functions/function-factory.hpp>
+#include <functions/library/stream.hpp>
 #include <value/value.hpp>
 
+#include <memory>
+
 namespace magl::functions::library {
 
 template <typename X, typename Y>
-struct MapImpl : IEvaluatable {
+struct MapImpl : IStreamable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override {
     IEvaluatable* f = *reinterpret_cast<value::LambdaValue*>(&args->at(0));
     value::ArrayValue items =
@@ -15,6 +19,7 @@ struct MapImpl : IEvaluatable {
     result.reserve(items.size());
 
     for (value::Value& v : items) {
+      executer::CountStep();
       new (&args->at(0)) X(std::move(boost::get<X>(v)));
       f->Evaluate(args, to);
       result.push_back(std::move(*reinterpret_cast<Y*>(to)));
@@ -22,6 +27,27 @@ struct MapImpl : IEvaluatable {
 
     new (to) value::ArrayValue(std::move(result));
   }
+
+  void EvaluateTo(ArgsContainer* args, ValueHolder* scratch,
+                  IItemSink* sink) override {
+    IEvaluatable* f = *reinterpret_cast<value::LambdaValue*>(&args->at(0));
+    value::ArrayValue items =
+        std::move(*reinterpret_cast<value::ArrayValue*>(&args->at(1)));
+
+    for (value::Value& v : items) {
+      executer::CountStep();
+      new (&args->at(0)) X(std::move(boost::get<X>(v)));
+      f->Evaluate(args, scratch);
+      Y* item = reinterpret_cast<Y*>(scratch);
+      try {
+        sink->Accept(*item);
+      } catch (...) {
+        std::destroy_at(item);
+        throw;
+      }
+      std::destroy_at(item);
+    }
+  }
 };
 
 class Map : public PolymorphicFunctionFactory {
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+#include <binary/view.hpp>
+#include <functions/evaluatable.hpp>
+#include <value/value.hpp>
+
+namespace magl::functions::library {
+
+namespace impl {
+
+/// Decodes an item of a mapped object in the representation V
+template <typename V>
+V ReadMapped(const binary::ValueView& item) {
+  if constexpr (std::is_same_v<V, value::IntegerValue>) {
+    return item.GetInteger();
+  } else if constexpr (std::is_same_v<V, value::FloatValue>) {
+    return item.GetFloat();
+  } else if constexpr (std::is_same_v<V, value::BoolValue>) {
+    return item.GetBool();
+  } else if constexpr (std::is_same_v<V, value::StringValue>) {
+    return value::StringValue{item.GetString()};
+  } else if constexpr (std::is_same_v<V, value::NullValue>) {
+    if (!item.IsNull()) {
+      throw std::invalid_argument("The value is not null.");
+    }
+    return {};
+  } else if constexpr (std::is_same_v<V, value::Value>) {
+    return item.Materialize();
+  } else if constexpr (std::is_same_v<V, value::LambdaValue>) {
+    throw std::invalid_argument("Mapped values may not be functions.");
+  } else {
+    value::Value result = item.Materialize();
+    V* typed = boost::get<V>(&result);
+    if (!typed) {
+      throw std::invalid_argument(
+          "VarMapAt: a mapped item does not match its declared type.");
+    }
+    return std::move(*typed);
+  }
+}
+
+}  // namespace impl
+
+/// VarMapAt of an input mapped to an encoded object (see
+/// executer::ExpressionOptions::mapped_inputs). The item is found by the hash
+/// index of the object and only the item is decoded
+template <typename V>
+class MappedVarMapAtImpl : public IEvaluatable {
+ public:
+  explicit MappedVarMapAtImpl(binary::ObjectView object) : object_(object) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    const std::string& key =
+        *reinterpret_cast<value::StringValue*>(&args->at(0));
+    const std::optional<binary::ValueView> item = object_.Find(key);
+    if (!item) {
+      throw std::out_of_range("VarMapAt: key is not found.");
+    }
+    new (reinterpret_cast<V*>(to)) V(impl::ReadMapped<V>(*item));
+  }
+
+ private:
+  const binary::ObjectView object_;
+};
+
+}  // namespace magl::functions::library
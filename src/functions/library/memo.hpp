@@ -0,0 +1,54 @@
+#pragma once
+
+#include <optional>
+
+#include <functions/evaluatable.hpp>
+#include <functions/library/thunk.hpp>
+
+namespace magl::functions::library {
+
+/// Subtree whose result is kept between evaluations, see
+/// executer::ExpressionOptions::incremental
+class IMemo : public IEvaluatable {
+ public:
+  /// Makes the next evaluation recompute the subtree
+  virtual void Invalidate() = 0;
+};
+
+/// Evaluates its lazy argument once and returns copies of the result until it
+/// is invalidated
+template <typename V>
+class MemoImpl : public IMemo {
+ public:
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override {
+    if (!cached_) {
+      ValueHolder result;
+      Force(&args->at(0), &result);
+      V* value = reinterpret_cast<V*>(&result);
+      cached_.emplace(std::move(*value));
+      value->~V();
+    }
+    new (reinterpret_cast<V*>(to)) V(*cached_);
+  }
+
+  void Invalidate() override { cached_.reset(); }
+
+ private:
+  std::optional<V> cached_;
+};
+
+/// Evaluates a subtree owned elsewhere, e.g. a memo shared by the expressions
+/// of an executer::ExpressionSet
+class EvaluateShared : public IEvaluatable {
+ public:
+  explicit EvaluateShared(Thunk subtree) : subtree_(subtree) {}
+
+  void Evaluate(ArgsContainer* /*args*/, ValueHolder* to) override {
+    executer::EvaluateTerm(*subtree_, to);
+  }
+
+ private:
+  Thunk subtree_;
+};
+
+}  // namespace magl::functions::library
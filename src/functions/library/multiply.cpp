@@ -2,8 +2,72 @@
 
 #include <value/value.hpp>
 
+#include <type_traits>
+
 namespace magl::functions::library {
 
+namespace {
+
+template <typename V>
+constexpr bool kIsNumber = std::is_same_v<V, value::IntegerValue> ||
+                           std::is_same_v<V, value::FloatValue>;
+
+struct MultiplyAnyVisitor : boost::static_visitor<value::Value> {
+  MultiplyAnyVisitor() = default;
+
+  template <typename L, typename R>
+  result_type operator()(const L& lhs, const R& rhs) const {
+    if constexpr (kIsNumber<L> && kIsNumber<R>) {
+      if constexpr (std::is_same_v<L, value::IntegerValue> &&
+                    std::is_same_v<R, value::IntegerValue>) {
+        return value::IntegerValue{lhs * rhs};
+      } else {
+        return value::FloatValue{lhs * rhs};
+      }
+    } else if constexpr (std::is_same_v<L, value::IntegerValue>) {
+      throw std::invalid_argument(
+          "Integer value can only be multiplied by integer or float value.");
+    } else if constexpr (std::is_same_v<L, value::FloatValue>) {
+      throw std::invalid_argument(
+          "Float value can only be multiplied by integer or float value.");
+    } else {
+      throw std::invalid_argument(
+          "Only integer and float values can be multiplied.");
+    }
+  }
+};
+
+template <typename L, typename R>
+value::Value MultiplyKernel(const value::Value& lhs, const value::Value& rhs) {
+  return MultiplyAnyVisitor{}(*boost::get<L>(&lhs), *boost::get<R>(&rhs));
+}
+
+}  // namespace
+
+value::Value MultiplyAny(const value::Value& lhs, const value::Value& rhs) {
+  return boost::apply_visitor(MultiplyAnyVisitor{}, lhs, rhs);
+}
+
+utils::BinaryInlineCache::Kernel FindMultiplyKernel(const value::Value& lhs,
+                                                    const value::Value& rhs) {
+  if (boost::get<value::IntegerValue>(&lhs)) {
+    if (boost::get<value::IntegerValue>(&rhs)) {
+      return &MultiplyKernel<value::IntegerValue, value::IntegerValue>;
+    }
+    if (boost::get<value::FloatValue>(&rhs)) {
+      return &MultiplyKernel<value::IntegerValue, value::FloatValue>;
+    }
+  } else if (boost::get<value::FloatValue>(&lhs)) {
+    if (boost::get<value::IntegerValue>(&rhs)) {
+      return &MultiplyKernel<value::FloatValue, value::IntegerValue>;
+    }
+    if (boost::get<value::FloatValue>(&rhs)) {
+      return &MultiplyKernel<value::FloatValue, value::FloatValue>;
+    }
+  }
+  return nullptr;
+}
+
 const Type Multiply::kType = FunctionType{
     TypeVariable{'X'}, FunctionType{TypeVariable{'X'}, TypeVariable{'X'}}};
 
@@ -13,10 +77,24 @@ void MultiplyIntImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
       std::move(*reinterpret_cast<value::IntegerValue*>(&args->at(1)));
 }
 
+void MultiplyIntConstImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
+  *reinterpret_cast<value::IntegerValue*>(to) =
+      *reinterpret_cast<value::IntegerValue*>(&args->at(0)) * constant_;
+}
+
 void MultiplyFloatImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
   *reinterpret_cast<value::FloatValue*>(to) =
       std::move(*reinterpret_cast<value::FloatValue*>(&args->at(0))) *
       std::move(*reinterpret_cast<value::FloatValue*>(&args->at(1)));
 }
 
+void MultiplyAnyImpl::Evaluate(ArgsContainer* args, ValueHolder* to) {
+  // NB: Arguments are moved out of their holders, which are not destroyed
+  const value::Value lhs =
+      std::move(*reinterpret_cast<value::Value*>(&args->at(0)));
+  const value::Value rhs =
+      std::move(*reinterpret_cast<value::Value*>(&args->at(1)));
+  new (reinterpret_cast<value::Value*>(to)) value::Value(cache_.Call(lhs, rhs));
+}
+
 }  // namespace magl::functions::library
@@ -1,17 +1,46 @@
 #pragma once
 
 #include <functions/function-factory.hpp>
+#include <functions/utils/inline-cache.hpp>
+#include <value/value.hpp>
 
 namespace magl::functions::library {
 
+/// Multiplies values of type Any
+value::Value MultiplyAny(const value::Value& lhs, const value::Value& rhs);
+
+/// Returns the typed kernel of MultiplyAny for the runtime types of the
+/// operands
+utils::BinaryInlineCache::Kernel FindMultiplyKernel(const value::Value& lhs,
+                                                    const value::Value& rhs);
+
 struct MultiplyIntImpl : IEvaluatable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override;
 };
 
+/// Fused Multiply(X, const) for integers
+class MultiplyIntConstImpl : public IEvaluatable {
+ public:
+  MultiplyIntConstImpl(int64_t constant) : constant_(constant) {}
+
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+
+ private:
+  const int64_t constant_;
+};
+
 struct MultiplyFloatImpl : IEvaluatable {
   void Evaluate(ArgsContainer* args, ValueHolder* to) override;
 };
 
+class MultiplyAnyImpl : public IEvaluatable {
+ public:
+  void Evaluate(ArgsContainer* args, ValueHolder* to) override;
+
+ private:
+  utils::BinaryInlineCache cache_{&FindMultiplyKernel, &MultiplyAny};
+};
+
 class Multiply : public PolymorphicFunctionFactory {
   // X -> X -> X
   const static Type kType;
@@ -25,6 +54,10 @@ class Multiply : public PolymorphicFunctionFactory {
         Type{FunctionType{{IntegerType{}},
                           FunctionType{{IntegerType{}}, IntegerType{}}}}) {
       return std::make_unique<MultiplyIntImpl>();
+    } else if (specific_type ==
+               Type{FunctionType{{AnyType{}},
+                                 FunctionType{{AnyType{}}, AnyType{}}}}) {
+      return std::make_unique<MultiplyAnyImpl>();
     }
     // TODO: support Add for float and string
     throw UnsupportedType(
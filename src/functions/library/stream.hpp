@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functions/evaluatable.hpp>
+#include <value/value.hpp>
+
+namespace magl::functions::library {
+
+/// Receives the items of a list one by one as they are produced, e.g. to
+/// serialize them without building the list, see IStreamable
+struct IItemSink {
+  virtual ~IItemSink() = default;
+
+  virtual void Accept(value::IntegerValue item) = 0;
+  virtual void Accept(value::FloatValue item) = 0;
+  virtual void Accept(value::BoolValue item) = 0;
+  virtual void Accept(const value::StringValue& item) = 0;
+  virtual void Accept(value::NullValue item) = 0;
+  virtual void Accept(const value::ArrayValue& item) = 0;
+  virtual void Accept(const value::ObjectValue& item) = 0;
+  virtual void Accept(const value::Value& item) = 0;
+};
+
+/// Evaluatable that returns a list and can pass its items to a sink instead
+struct IStreamable : IEvaluatable {
+  /// Same as Evaluate, but the items are passed to `sink` and are not kept.
+  /// `scratch` is a holder for an item
+  virtual void EvaluateTo(ArgsContainer* args, ValueHolder* scratch,
+                          IItemSink* sink) = 0;
+};
+
+}  // namespace magl::functions::library
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <executer/evaluate.hpp>
+#include <executer/term.hpp>
+#include <functions/evaluatable.hpp>
+
+namespace magl::functions::library {
+
+/// Lazy arguments (see PolymorphicFunctionFactory::IsLazyArgument) are passed
+/// as a pointer to an unevaluated subtree
+using Thunk = executer::EvaluationTree*;
+
+/// Evaluates a lazy argument into `to`
+inline void Force(ValueHolder* thunk, ValueHolder* to) {
+  executer::EvaluateTerm(**reinterpret_cast<Thunk*>(thunk), to);
+}
+
+}  // namespace magl::functions::library
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functions/evaluatable.hpp>
+#include <functions/utils/value-type.hpp>
+
+#include <memory>
+
+namespace magl::functions::library {
+
+/// Location of a variable that owns its value (a let definition or a lambda
+/// argument). The value is kept until it is replaced or the slot is destroyed.
+/// It is destroyed with `destroy` and moved into the slot with `relocate`, see
+/// utils::GetValueDestroyer and utils::GetValueRelocator
+class VariableSlot {
+ public:
+  explicit VariableSlot(utils::ValueDestroyer destroy,
+                        utils::ValueRelocator relocate = nullptr)
+      : holder_(std::make_unique<ValueHolder>()),
+        destroy_(destroy),
+        relocate_(relocate) {}
+
+  VariableSlot(const VariableSlot&) = delete;
+  VariableSlot& operator=(const VariableSlot&) = delete;
+
+  ~VariableSlot() { Destroy(); }
+
+  const ValueHolder* GetLocation() const { return holder_.get(); }
+
+  /// Destroys the held value and constructs the next one with
+  /// `construct(ValueHolder*)`
+  template <typename F>
+  void Assign(F construct) {
+    Destroy();
+    construct(holder_.get());
+    holds_value_ = true;
+  }
+
+  /// Destroys the held value and moves the one in `from` to the slot
+  void Relocate(ValueHolder* from) {
+    Assign([this, from](ValueHolder* location) {
+      if (relocate_) {
+        relocate_(from, location);
+      } else {
+        *location = *from;
+      }
+    });
+  }
+
+ private:
+  void Destroy() {
+    if (holds_value_ && destroy_) {
+      destroy_(holder_.get());
+    }
+    holds_value_ = false;
+  }
+
+  std::unique_ptr<ValueHolder> holder_;
+  utils::ValueDestroyer destroy_;
+  utils::ValueRelocator relocate_;
+  bool holds_value_ = false;
+};
+
+}  // namespace magl::functions::library
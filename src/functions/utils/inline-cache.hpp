@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <value/value.hpp>
+
+namespace magl::functions::utils {
+
+/// Per-call-site cache of a binary operation on values of type Any. Records
+/// the runtime types of the operands seen at the call site (Value::which()) and
+/// calls the typed kernel for them directly instead of dispatching on both
+/// operands.
+class BinaryInlineCache {
+ public:
+  using Kernel = value::Value (*)(const value::Value& lhs,
+                                  const value::Value& rhs);
+  /// Returns the typed kernel for the runtime types of the operands or nullptr
+  /// if there is none
+  using KernelLookup = Kernel (*)(const value::Value& lhs,
+                                  const value::Value& rhs);
+
+  /// `generic` handles operands without a typed kernel, e.g. throws
+  BinaryInlineCache(KernelLookup lookup, Kernel generic)
+      : lookup_(lookup), generic_(generic) {}
+
+  value::Value Call(const value::Value& lhs, const value::Value& rhs) {
+    const uint32_t key = MakeKey(lhs, rhs);
+    for (size_t i = 0; i < size_; ++i) {
+      if (entries_[i].key == key) {
+        return entries_[i].kernel(lhs, rhs);
+      }
+    }
+    return Miss(lhs, rhs, key);
+  }
+
+ private:
+  // Polymorphic call sites are rare: data is usually of a single shape
+  static constexpr size_t kMaxEntries = 4;
+
+  struct Entry {
+    uint32_t key;
+    Kernel kernel;
+  };
+
+  static uint32_t MakeKey(const value::Value& lhs, const value::Value& rhs) {
+    return static_cast<uint32_t>(lhs.which()) << 16 |
+           static_cast<uint32_t>(rhs.which());
+  }
+
+  value::Value Miss(const value::Value& lhs, const value::Value& rhs,
+                    uint32_t key) {
+    const Kernel kernel = lookup_(lhs, rhs);
+    if (!kernel) {
+      return generic_(lhs, rhs);
+    }
+    // NB: Megamorphic call sites look up the kernel each time
+    if (size_ < kMaxEntries) {
+      entries_[size_++] = Entry{key, kernel};
+    }
+    return kernel(lhs, rhs);
+  }
+
+ private:
+  const KernelLookup lookup_;
+  const Kernel generic_;
+
+  std::array<Entry, kMaxEntries> entries_{};
+  size_t size_ = 0;
+};
+
+}  // namespace magl::functions::utils
@@ -0,0 +1,53 @@
+#include <functions/utils/type-description.hpp>
+
+#include <stdexcept>
+
+namespace magl::functions::utils {
+
+Type ParseTypeDescription(const value::Value& v) {
+  if (const auto* name = boost::get<value::StringValue>(&v)) {
+    if (*name == "Int") {
+      return IntegerType{};
+    }
+    if (*name == "Float") {
+      return DoubleType{};
+    }
+    if (*name == "Bool") {
+      return BoolType{};
+    }
+    if (*name == "String") {
+      return StringType{};
+    }
+    if (*name == "Null") {
+      return NullType{};
+    }
+    if (*name == "Any") {
+      return AnyType{};
+    }
+    throw std::invalid_argument("Unknown type " + *name);
+  }
+  if (const auto* list = boost::get<value::ArrayValue>(&v)) {
+    if (list->size() != 1) {
+      throw std::invalid_argument("A list type has one item type");
+    }
+    return ListType{ParseTypeDescription(list->front())};
+  }
+  if (const auto* object = boost::get<value::ObjectValue>(&v)) {
+    const auto find_any_key = object->find("*");
+    if (find_any_key != object->end()) {
+      if (object->size() != 1) {
+        throw std::invalid_argument("A dict type has only the key \"*\"");
+      }
+      return DictType{ParseTypeDescription(find_any_key->second)};
+    }
+    SchemaType result;
+    for (const auto& [key, field] : *object) {
+      result.values.emplace(key, ParseTypeDescription(field));
+    }
+    return result;
+  }
+  throw std::invalid_argument("Type is described by a string, a list or an "
+                              "object");
+}
+
+}  // namespace magl::functions::utils
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <functions/type.hpp>
+#include <value/value.hpp>
+
+namespace magl::functions::utils {
+
+/// Parses a type described by a value: "Int", "Float", "Bool", "String",
+/// "Null" or "Any" for scalars, [T] for List[T], {"*": T} for Dict[T] and
+/// {"key": T, ...} for a Schema.
+///
+/// Throws std::invalid_argument if the value does not describe a type.
+Type ParseTypeDescription(const value::Value& v);
+
+}  // namespace magl::functions::utils
@@ -36,4 +36,38 @@ Type GetType(const value::Value& value) {
   return boost::apply_visitor(GetTypeVisitor{}, value);
 }
 
+bool IsTriviallyCopied(const Type& type) {
+  return boost::get<IntegerType>(&type) || boost::get<DoubleType>(&type) ||
+         boost::get<BoolType>(&type) || boost::get<NullType>(&type) ||
+         boost::get<FunctionType>(&type);
+}
+
+ValueDestroyer GetValueDestroyer(const Type& type) {
+  return VisitValueType(type, [](auto v) -> ValueDestroyer {
+    using V = typename decltype(v)::type;
+    if constexpr (std::is_trivially_destructible_v<V>) {
+      return nullptr;
+    } else {
+      return [](ValueHolder* holder) {
+        std::destroy_at(reinterpret_cast<V*>(holder));
+      };
+    }
+  });
+}
+
+ValueRelocator GetValueRelocator(const Type& type) {
+  return VisitValueType(type, [](auto v) -> ValueRelocator {
+    using V = typename decltype(v)::type;
+    if constexpr (std::is_trivially_copyable_v<V>) {
+      return nullptr;
+    } else {
+      return [](ValueHolder* from, ValueHolder* to) {
+        V* value = reinterpret_cast<V*>(from);
+        new (reinterpret_cast<V*>(to)) V(std::move(*value));
+        std::destroy_at(value);
+      };
+    }
+  });
+}
+
 }  // namespace magl::functions::utils
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <type_traits>
+
+#include <functions/evaluatable.hpp>
+#include <functions/function-factory.hpp>
 #include <functions/type.hpp>
 #include <value/value.hpp>
 
@@ -7,4 +12,94 @@ namespace magl::functions::utils {
 
 Type GetType(const value::Value& value);
 
+namespace impl {
+
+template <typename F>
+struct VisitValueTypeVisitor
+    : boost::static_visitor<
+          std::invoke_result_t<F, std::type_identity<value::IntegerValue>>> {
+  VisitValueTypeVisitor(F* f) : f_(f) {}
+
+  using Result =
+      std::invoke_result_t<F, std::type_identity<value::IntegerValue>>;
+
+  Result operator()(const TypeVariable& tau) const {
+    throw UnsupportedType(std::format(
+        "Value representation of Variable(uid={}) is unknown.", tau.uid));
+  }
+  Result operator()(const FunctionType&) const {
+    return (*f_)(std::type_identity<value::LambdaValue>{});
+  }
+  Result operator()(const IntegerType&) const {
+    return (*f_)(std::type_identity<value::IntegerValue>{});
+  }
+  Result operator()(const DoubleType&) const {
+    return (*f_)(std::type_identity<value::FloatValue>{});
+  }
+  Result operator()(const BoolType&) const {
+    return (*f_)(std::type_identity<value::BoolValue>{});
+  }
+  Result operator()(const StringType&) const {
+    return (*f_)(std::type_identity<value::StringValue>{});
+  }
+  Result operator()(const NullType&) const {
+    return (*f_)(std::type_identity<value::NullValue>{});
+  }
+  Result operator()(const AnyType&) const {
+    return (*f_)(std::type_identity<value::Value>{});
+  }
+  Result operator()(const ListType&) const {
+    return (*f_)(std::type_identity<value::ArrayValue>{});
+  }
+  Result operator()(const DictType&) const {
+    return (*f_)(std::type_identity<value::ObjectValue>{});
+  }
+  Result operator()(const SchemaType&) const {
+    return (*f_)(std::type_identity<value::ObjectValue>{});
+  }
+
+ private:
+  F* f_;
+};
+
+}  // namespace impl
+
+/// Calls f(std::type_identity<V>{}) where V is the runtime representation of
+/// values of type `type`
+template <typename F>
+auto VisitValueType(const Type& type, F f) {
+  return boost::apply_visitor(impl::VisitValueTypeVisitor<F>{&f}, type);
 }
+
+/// Instantiates Impl<V> where V is the runtime representation of values of
+/// type `type`
+template <template <typename> class Impl, typename... Args>
+std::unique_ptr<IEvaluatable> MakeForValueType(const Type& type,
+                                               Args&&... args) {
+  return VisitValueType(
+      type, [&](auto v) -> std::unique_ptr<IEvaluatable> {
+        return std::make_unique<Impl<typename decltype(v)::type>>(
+            std::forward<Args>(args)...);
+      });
+}
+
+/// Whether values of type `type` are cheaper to copy than to borrow
+bool IsTriviallyCopied(const Type& type);
+
+/// Destroys a value constructed in a holder
+using ValueDestroyer = void (*)(ValueHolder*);
+
+/// Moves a value constructed in holder `from` to holder `to`, the value is
+/// destroyed in `from`
+using ValueRelocator = void (*)(ValueHolder* from, ValueHolder* to);
+
+/// Destroyer of values of type `type`, nullptr if they are trivially
+/// destructible
+ValueDestroyer GetValueDestroyer(const Type& type);
+
+/// Relocator of values of type `type`, nullptr if they are trivially copyable
+/// and are relocated by copying the holder. NB: Values such as std::string may
+/// point into themselves and can not be relocated by copying the bytes
+ValueRelocator GetValueRelocator(const Type& type);
+
+}  // namespace magl::functions::utils
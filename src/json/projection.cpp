@@ -0,0 +1,45 @@
+#include <json/projection.hpp>
+
+namespace magl::json {
+
+Projection::Projection(std::span<const std::vector<std::string>> paths) {
+  for (const std::vector<std::string>& path : paths) {
+    Add(path);
+  }
+}
+
+Projection Projection::All() {
+  Projection result;
+  result.all_ = true;
+  return result;
+}
+
+void Projection::Add(std::span<const std::string> path) {
+  if (all_) {
+    return;
+  }
+  if (path.empty()) {
+    all_ = true;
+    fields_.clear();
+    return;
+  }
+
+  for (auto& [key, field] : fields_) {
+    if (key == path.front()) {
+      field.Add(path.subspan(1));
+      return;
+    }
+  }
+  fields_.emplace_back(path.front(), Projection{}).second.Add(path.subspan(1));
+}
+
+const Projection* Projection::Find(std::string_view key) const {
+  for (const auto& [field_key, field] : fields_) {
+    if (field_key == key) {
+      return &field;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace magl::json
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace magl::json {
+
+/// Fields of a document that are read: a tree of object keys whose leaves are
+/// read whole. Other fields of objects are skipped by the reader without
+/// building their values, values that are not objects are read whole
+class Projection {
+ public:
+  /// Reads nothing but the values that are not objects
+  Projection() = default;
+  /// Reads the values at `paths`, see Add
+  explicit Projection(std::span<const std::vector<std::string>> paths);
+
+  /// Reads the whole document
+  static Projection All();
+
+  /// Reads the value at `path` of object keys, the whole document if `path`
+  /// is empty
+  void Add(std::span<const std::string> path);
+
+  /// Whether the whole value is read
+  bool IsAll() const { return all_; }
+
+  /// Returns the projection of the field `key` or nullptr if it is skipped
+  const Projection* Find(std::string_view key) const;
+
+  const std::vector<std::pair<std::string, Projection>>& GetFields() const {
+    return fields_;
+  }
+
+ private:
+  bool all_ = false;
+  // NB: A rule reads a handful of fields, a linear search is the fastest
+  std::vector<std::pair<std::string, Projection>> fields_;
+};
+
+}  // namespace magl::json
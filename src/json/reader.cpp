@@ -0,0 +1,613 @@
+#include <json/reader.hpp>
+
+#include <charconv>
+#include <format>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace magl::json {
+
+namespace {
+
+// Deeper documents are rejected instead of overflowing the stack
+constexpr size_t kMaxDepth = 1024;
+
+bool IsScalarChar(char c) {
+  switch (c) {
+    case '"':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      return false;
+    default:
+      return true;
+  }
+}
+
+/// Checks -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool IsNumber(std::string_view token, bool* is_integer) {
+  size_t i = 0;
+  auto digits = [&token, &i]() {
+    const size_t begin = i;
+    while (i < token.size() && token[i] >= '0' && token[i] <= '9') {
+      ++i;
+    }
+    return i - begin;
+  };
+
+  if (i < token.size() && token[i] == '-') {
+    ++i;
+  }
+  const size_t int_begin = i;
+  const size_t int_digits = digits();
+  if (int_digits == 0 || (int_digits > 1 && token[int_begin] == '0')) {
+    return false;
+  }
+  *is_integer = true;
+  if (i < token.size() && token[i] == '.') {
+    ++i;
+    *is_integer = false;
+    if (digits() == 0) {
+      return false;
+    }
+  }
+  if (i < token.size() && (token[i] == 'e' || token[i] == 'E')) {
+    ++i;
+    *is_integer = false;
+    if (i < token.size() && (token[i] == '+' || token[i] == '-')) {
+      ++i;
+    }
+    if (digits() == 0) {
+      return false;
+    }
+  }
+  return i == token.size();
+}
+
+void AppendUtf8(uint32_t code_point, std::string* to) {
+  if (code_point < 0x80) {
+    to->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    to->push_back(static_cast<char>(0xC0 | code_point >> 6));
+    to->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    to->push_back(static_cast<char>(0xE0 | code_point >> 12));
+    to->push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+    to->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    to->push_back(static_cast<char>(0xF0 | code_point >> 18));
+    to->push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3F)));
+    to->push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+    to->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+/// Replaces `*to` by `v`. Unlike the assignment of boost::variant, does not
+/// make a temporary value::Value: a moved value::Value that holds a container
+/// allocates a new recursive_wrapper
+template <typename T>
+T& Emplace(value::Value* to, T v) {
+  std::destroy_at(to);
+  try {
+    new (to) value::Value(std::move(v));
+  } catch (...) {
+    new (to) value::Value();
+    throw;
+  }
+  return boost::get<T>(*to);
+}
+
+/// Throws std::invalid_argument if values of `type` can not be read
+void CheckReadable(const functions::Type& type) {
+  if (boost::get<functions::FunctionType>(&type) ||
+      boost::get<functions::TypeVariable>(&type)) {
+    throw std::invalid_argument(std::format(
+        "Values of type {} can not be read from JSON.", ToString(type)));
+  }
+  if (const auto* list = boost::get<functions::ListType>(&type)) {
+    CheckReadable(list->value_type);
+  }
+  if (const auto* dict = boost::get<functions::DictType>(&type)) {
+    CheckReadable(dict->value_type);
+  }
+  if (const auto* schema = boost::get<functions::SchemaType>(&type)) {
+    for (const auto& [key, field_type] : schema->values) {
+      CheckReadable(field_type);
+    }
+  }
+}
+
+/// Stage 2: builds values walking the positions found by FindStructurals
+class Reader {
+ public:
+  explicit Reader(std::string_view json)
+      : json_(json), structurals_(FindStructurals(json)) {}
+
+  value::Value ParseDocument(const functions::Type* type,
+                             const Projection* projection) {
+    if (projection && projection->IsAll()) {
+      projection = nullptr;
+    }
+    value::Value result;
+    if (type) {
+      ParseTyped(*type, 0, &result, projection);
+    } else {
+      ParseAny(0, &result, projection);
+    }
+    if (next_ != structurals_.size()) {
+      Throw(structurals_[next_], "unexpected characters after the document");
+    }
+    return result;
+  }
+
+ private:
+  // NB: Values are built in place, see Emplace. Fields of objects that are not
+  // in `projection` are skipped, nullptr reads the whole value
+  void ParseAny(size_t depth, value::Value* to,
+                const Projection* projection = nullptr);
+  void ParseTyped(const functions::Type& type, size_t depth, value::Value* to,
+                  const Projection* projection = nullptr);
+
+  /// Calls `parse_item(key, depth + 1)` for each item of an object. `key` is
+  /// valid until the call returns
+  template <typename F>
+  void ParseObject(size_t depth, F parse_item);
+  /// Calls `parse_item(depth + 1)` for each item of an array
+  template <typename F>
+  void ParseArray(size_t depth, F parse_item);
+
+  /// Skips the next value checking only that its brackets are balanced
+  void Skip();
+
+  /// Returns whether the field `key` of an object read with `projection` is
+  /// read and sets `*field` to the projection of the field
+  static bool SelectField(const Projection* projection, std::string_view key,
+                          const Projection** field) {
+    *field = nullptr;
+    if (!projection) {
+      return true;
+    }
+    const Projection* selected = projection->Find(key);
+    if (!selected) {
+      return false;
+    }
+    if (!selected->IsAll()) {
+      *field = selected;
+    }
+    return true;
+  }
+
+  value::StringValue ParseString();
+  /// Reads the next string. Returns a view of the document if the string has
+  /// no escapes, otherwise decodes it into `*buffer`
+  std::string_view ReadString(std::string* buffer);
+  value::Value ParseScalar();
+  /// Reads the next number as an integer or a double
+  value::Value ParseNumber(bool as_float);
+
+  /// Position of the next structural
+  uint32_t Peek() const {
+    if (next_ == structurals_.size()) {
+      Throw(json_.size(), "unexpected end of the document");
+    }
+    return structurals_[next_];
+  }
+  char PeekChar() const { return json_[Peek()]; }
+
+  uint32_t Next() {
+    const uint32_t position = Peek();
+    ++next_;
+    return position;
+  }
+
+  void Expect(char c) {
+    const uint32_t position = Next();
+    if (json_[position] != c) {
+      Throw(position, std::format("expected '{}'", c));
+    }
+  }
+
+  std::string_view ScalarToken(uint32_t position) const {
+    size_t end = position;
+    while (end < json_.size() && IsScalarChar(json_[end])) {
+      ++end;
+    }
+    return json_.substr(position, end - position);
+  }
+
+  void CheckDepth(size_t depth) const {
+    if (depth > kMaxDepth) {
+      Throw(Peek(), "the document is nested too deeply");
+    }
+  }
+
+  [[noreturn]] void Throw(size_t position, std::string_view message) const {
+    throw ParsingError(
+        std::format("JSON parsing failed at position {}: {}", position,
+                    message));
+  }
+
+ private:
+  std::string_view json_;
+  std::vector<uint32_t> structurals_;
+  size_t next_ = 0;
+  // Closing brackets expected by Skip
+  std::string closing_;
+};
+
+void Reader::ParseAny(size_t depth, value::Value* to,
+                      const Projection* projection) {
+  CheckDepth(depth);
+  switch (PeekChar()) {
+    case '{': {
+      auto& result = Emplace(to, value::ObjectValue{});
+      ParseObject(depth, [&](std::string_view key, size_t item_depth) {
+        const Projection* field = nullptr;
+        if (!SelectField(projection, key, &field)) {
+          Skip();
+          return;
+        }
+        ParseAny(item_depth, &result[std::string(key)], field);
+      });
+      return;
+    }
+    case '[': {
+      auto& result = Emplace(to, value::ArrayValue{});
+      ParseArray(depth, [&](size_t item_depth) {
+        ParseAny(item_depth, &result.emplace_back());
+      });
+      return;
+    }
+    case '"':
+      *to = ParseString();
+      return;
+    default:
+      *to = ParseScalar();
+  }
+}
+
+void Reader::ParseTyped(const functions::Type& type, size_t depth,
+                        value::Value* to, const Projection* projection) {
+  CheckDepth(depth);
+  if (boost::get<functions::AnyType>(&type)) {
+    ParseAny(depth, to, projection);
+    return;
+  }
+  if (boost::get<functions::IntegerType>(&type)) {
+    const uint32_t position = Peek();
+    *to = ParseNumber(/*as_float=*/false);
+    if (!boost::get<value::IntegerValue>(to)) {
+      Throw(position, "expected an integer");
+    }
+    return;
+  }
+  if (boost::get<functions::DoubleType>(&type)) {
+    *to = ParseNumber(/*as_float=*/true);
+    return;
+  }
+  if (boost::get<functions::StringType>(&type)) {
+    if (PeekChar() != '"') {
+      Throw(Peek(), "expected a string");
+    }
+    *to = ParseString();
+    return;
+  }
+  if (boost::get<functions::BoolType>(&type)) {
+    const uint32_t position = Peek();
+    *to = ParseScalar();
+    if (!boost::get<value::BoolValue>(to)) {
+      Throw(position, "expected true or false");
+    }
+    return;
+  }
+  if (boost::get<functions::NullType>(&type)) {
+    const uint32_t position = Peek();
+    *to = ParseScalar();
+    if (!boost::get<value::NullValue>(to)) {
+      Throw(position, "expected null");
+    }
+    return;
+  }
+  if (const auto* list = boost::get<functions::ListType>(&type)) {
+    auto& result = Emplace(to, value::ArrayValue{});
+    ParseArray(depth, [&](size_t item_depth) {
+      ParseTyped(list->value_type, item_depth, &result.emplace_back());
+    });
+    return;
+  }
+  if (const auto* dict = boost::get<functions::DictType>(&type)) {
+    auto& result = Emplace(to, value::ObjectValue{});
+    ParseObject(depth, [&](std::string_view key, size_t item_depth) {
+      const Projection* field = nullptr;
+      if (!SelectField(projection, key, &field)) {
+        Skip();
+        return;
+      }
+      ParseTyped(dict->value_type, item_depth, &result[std::string(key)],
+                 field);
+    });
+    return;
+  }
+  if (const auto* schema = boost::get<functions::SchemaType>(&type)) {
+    const uint32_t position = Peek();
+    auto& result = Emplace(to, value::ObjectValue{});
+    result.reserve(projection ? projection->GetFields().size()
+                              : schema->values.size());
+    ParseObject(depth, [&](std::string_view key, size_t item_depth) {
+      const auto find_field = schema->values.find(std::string(key));
+      const Projection* field = nullptr;
+      if (find_field == schema->values.end() ||
+          !SelectField(projection, key, &field)) {
+        Skip();
+        return;
+      }
+      ParseTyped(find_field->second, item_depth, &result[std::string(key)],
+                 field);
+    });
+    if (projection) {
+      // Only the fields that are read must be present
+      for (const auto& [key, field] : projection->GetFields()) {
+        if (schema->values.contains(key) && !result.contains(key)) {
+          Throw(position, std::format("field {} is missing", key));
+        }
+      }
+    } else if (result.size() != schema->values.size()) {
+      for (const auto& [key, field_type] : schema->values) {
+        if (!result.contains(key)) {
+          Throw(position, std::format("field {} is missing", key));
+        }
+      }
+    }
+    return;
+  }
+  // Checked by CheckReadable
+  Throw(Peek(), std::format("values of type {} can not be read",
+                            ToString(type)));
+}
+
+template <typename F>
+void Reader::ParseObject(size_t depth, F parse_item) {
+  Expect('{');
+  if (PeekChar() == '}') {
+    Next();
+    return;
+  }
+  // Keys with escapes are decoded here
+  std::string key_buffer;
+  while (true) {
+    if (PeekChar() != '"') {
+      Throw(Peek(), "expected a string key");
+    }
+    const std::string_view key = ReadString(&key_buffer);
+    Expect(':');
+    parse_item(key, depth + 1);
+
+    const uint32_t position = Next();
+    if (json_[position] == '}') {
+      return;
+    }
+    if (json_[position] != ',') {
+      Throw(position, "expected ',' or '}'");
+    }
+  }
+}
+
+template <typename F>
+void Reader::ParseArray(size_t depth, F parse_item) {
+  Expect('[');
+  if (PeekChar() == ']') {
+    Next();
+    return;
+  }
+  while (true) {
+    parse_item(depth + 1);
+
+    const uint32_t position = Next();
+    if (json_[position] == ']') {
+      return;
+    }
+    if (json_[position] != ',') {
+      Throw(position, "expected ',' or ']'");
+    }
+  }
+}
+
+void Reader::Skip() {
+  // NB: Reused by the calls, no allocations after the deepest skipped value
+  closing_.clear();
+  if (PeekChar() == ',' || PeekChar() == ':') {
+    Throw(Peek(), "expected a value");
+  }
+  do {
+    const uint32_t position = Next();
+    switch (json_[position]) {
+      case '{':
+        closing_.push_back('}');
+        break;
+      case '[':
+        closing_.push_back(']');
+        break;
+      case '}':
+      case ']':
+        if (closing_.empty() || closing_.back() != json_[position]) {
+          Throw(position, "unexpected bracket");
+        }
+        closing_.pop_back();
+        break;
+    }
+  } while (!closing_.empty());
+}
+
+value::StringValue Reader::ParseString() {
+  std::string buffer;
+  const std::string_view result = ReadString(&buffer);
+  if (result.data() == buffer.data()) {
+    return buffer;
+  }
+  return value::StringValue{result};
+}
+
+std::string_view Reader::ReadString(std::string* buffer) {
+  const uint32_t position = Next();
+  if (json_[position] != '"') {
+    Throw(position, "expected a string");
+  }
+
+  // Fast path: a string without escapes is a part of the document
+  const size_t begin = position + 1;
+  size_t i = begin;
+  // NB: Stage 1 guarantees that the string is closed
+  while (json_[i] != '"' && json_[i] != '\\') {
+    if (static_cast<unsigned char>(json_[i]) < 0x20) {
+      Throw(i, "control character in a string");
+    }
+    ++i;
+  }
+  if (json_[i] == '"') {
+    return json_.substr(begin, i - begin);
+  }
+  std::string& result = *buffer;
+  result.assign(json_.substr(begin, i - begin));
+
+  auto read_hex = [this](size_t at) -> uint32_t {
+    uint32_t result = 0;
+    if (at + 4 > json_.size() ||
+        std::from_chars(json_.data() + at, json_.data() + at + 4, result, 16)
+                .ptr != json_.data() + at + 4) {
+      Throw(at, "invalid \\u escape");
+    }
+    return result;
+  };
+
+  while (json_[i] != '"') {
+    const char c = json_[i];
+    if (static_cast<unsigned char>(c) < 0x20) {
+      Throw(i, "control character in a string");
+    }
+    if (c != '\\') {
+      result.push_back(c);
+      ++i;
+      continue;
+    }
+
+    const char escaped = json_[i + 1];
+    i += 2;
+    switch (escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        result.push_back(escaped);
+        break;
+      case 'b':
+        result.push_back('\b');
+        break;
+      case 'f':
+        result.push_back('\f');
+        break;
+      case 'n':
+        result.push_back('\n');
+        break;
+      case 'r':
+        result.push_back('\r');
+        break;
+      case 't':
+        result.push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code_point = read_hex(i);
+        i += 4;
+        if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+          Throw(i - 6, "unpaired surrogate");
+        }
+        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+          // Surrogate pair
+          if (json_.substr(i, 2) != "\\u") {
+            Throw(i - 6, "unpaired surrogate");
+          }
+          const uint32_t low = read_hex(i + 2);
+          if (low < 0xDC00 || low > 0xDFFF) {
+            Throw(i, "unpaired surrogate");
+          }
+          code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+          i += 6;
+        }
+        AppendUtf8(code_point, &result);
+        break;
+      }
+      default:
+        Throw(i - 2, "invalid escape");
+    }
+  }
+  return result;
+}
+
+value::Value Reader::ParseScalar() {
+  const uint32_t position = Peek();
+  const std::string_view token = ScalarToken(position);
+  if (token == "true" || token == "false" || token == "null") {
+    Next();
+    if (token == "null") {
+      return value::NullValue{};
+    }
+    return value::BoolValue{token == "true"};
+  }
+  return ParseNumber(/*as_float=*/false);
+}
+
+value::Value Reader::ParseNumber(bool as_float) {
+  const uint32_t position = Next();
+  const std::string_view token = ScalarToken(position);
+  bool is_integer = false;
+  if (token.empty() || !IsNumber(token, &is_integer)) {
+    Throw(position, "expected a number");
+  }
+  const char* begin = token.data();
+  const char* end = token.data() + token.size();
+
+  if (is_integer && !as_float) {
+    value::IntegerValue result = 0;
+    const auto [ptr, error] = std::from_chars(begin, end, result);
+    if (error == std::errc{} && ptr == end) {
+      return result;
+    }
+    // Out of the range of int64_t: read as a double
+  }
+
+  value::FloatValue result = 0;
+  const auto [ptr, error] = std::from_chars(begin, end, result);
+  if (error != std::errc{} || ptr != end) {
+    Throw(position, "number is out of range");
+  }
+  return result;
+}
+
+}  // namespace
+
+value::Value Parse(std::string_view json) {
+  return Reader{json}.ParseDocument(nullptr, nullptr);
+}
+
+value::Value Parse(std::string_view json, const functions::Type& type) {
+  CheckReadable(type);
+  return Reader{json}.ParseDocument(&type, nullptr);
+}
+
+value::Value Parse(std::string_view json, const Projection& projection) {
+  return Reader{json}.ParseDocument(nullptr, &projection);
+}
+
+value::Value Parse(std::string_view json, const functions::Type& type,
+                   const Projection& projection) {
+  CheckReadable(type);
+  return Reader{json}.ParseDocument(&type, &projection);
+}
+
+}  // namespace magl::json
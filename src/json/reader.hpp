@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string_view>
+
+#include <functions/type.hpp>
+#include <json/projection.hpp>
+#include <json/structural-index.hpp>
+#include <value/value.hpp>
+
+namespace magl::json {
+
+/// Reads a JSON document. Integers that fit in int64_t are read as
+/// IntegerValue, other numbers as FloatValue. Throws ParsingError if the
+/// document is malformed
+value::Value Parse(std::string_view json);
+
+/// Reads a JSON document as a value of `type` in the representation the
+/// executer expects for it (see functions/utils/value-type.hpp), so no
+/// conversion is needed before evaluation:
+/// - numbers of type Float are read as FloatValue even if they are integers,
+/// - fields of a Schema that are not declared are dropped, declared fields
+///   must be present.
+/// Throws ParsingError if the document is malformed or does not match `type`,
+/// and std::invalid_argument if values of `type` can not be read from JSON
+value::Value Parse(std::string_view json, const functions::Type& type);
+
+/// Reads only the fields of `projection`: skipped values are not built and are
+/// only checked for balanced brackets. With a Schema type only the declared
+/// fields that are read must be present
+value::Value Parse(std::string_view json, const Projection& projection);
+value::Value Parse(std::string_view json, const functions::Type& type,
+                   const Projection& projection);
+
+}  // namespace magl::json
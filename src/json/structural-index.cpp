@@ -0,0 +1,270 @@
+#include <json/structural-index.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace magl::json {
+
+namespace {
+
+constexpr size_t kBlockSize = 64;
+
+/// Bit i is set if byte i of a block is of the class
+struct BlockMasks {
+  uint64_t quote = 0;
+  uint64_t backslash = 0;
+  // {}[]:,
+  uint64_t op = 0;
+  uint64_t whitespace = 0;
+};
+
+#if defined(__SSE2__)
+
+uint64_t MoveMask(__m128i bytes) {
+  return static_cast<uint16_t>(_mm_movemask_epi8(bytes));
+}
+
+BlockMasks Classify(const char* block) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i opening = _mm_set1_epi8('{');
+  const __m128i closing = _mm_set1_epi8('}');
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i line_feed = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+
+  BlockMasks result;
+  for (size_t i = 0; i < kBlockSize / 16; ++i) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+    // NB: '[' | 0x20 == '{' and ']' | 0x20 == '}', so brackets take two
+    // comparisons instead of four
+    const __m128i lowered = _mm_or_si128(bytes, case_bit);
+    const __m128i op = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(lowered, opening),
+                     _mm_cmpeq_epi8(lowered, closing)),
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, colon),
+                     _mm_cmpeq_epi8(bytes, comma)));
+    const __m128i whitespace = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, line_feed),
+                     _mm_cmpeq_epi8(bytes, carriage_return)));
+
+    const size_t shift = 16 * i;
+    result.quote |= MoveMask(_mm_cmpeq_epi8(bytes, quote)) << shift;
+    result.backslash |= MoveMask(_mm_cmpeq_epi8(bytes, backslash)) << shift;
+    result.op |= MoveMask(op) << shift;
+    result.whitespace |= MoveMask(whitespace) << shift;
+  }
+  return result;
+}
+
+#else
+
+BlockMasks Classify(const char* block) {
+  BlockMasks result;
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    const uint64_t bit = uint64_t{1} << i;
+    switch (block[i]) {
+      case '"':
+        result.quote |= bit;
+        break;
+      case '\\':
+        result.backslash |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        result.op |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        result.whitespace |= bit;
+        break;
+    }
+  }
+  return result;
+}
+
+#endif
+
+/// Returns characters escaped by a backslash: the ones after a series of
+/// backslashes of odd length. `prev_odd` is 1 if the previous block ends with
+/// such a series
+uint64_t FindEscaped(uint64_t backslash, uint64_t* prev_odd) {
+  constexpr uint64_t kEvenBits = 0x5555555555555555ULL;
+  constexpr uint64_t kOddBits = ~kEvenBits;
+
+  const uint64_t starts = backslash & ~(backslash << 1);
+  // A series that continues the previous one starts at an odd position
+  const uint64_t even_start_mask = kEvenBits ^ *prev_odd;
+  const uint64_t even_starts = starts & even_start_mask;
+  const uint64_t odd_starts = starts & ~even_start_mask;
+
+  // Adding the start of a series to it carries a bit to its end
+  const uint64_t even_carries = backslash + even_starts;
+  uint64_t odd_carries = 0;
+  const bool ends_odd =
+      __builtin_add_overflow(backslash, odd_starts, &odd_carries);
+  odd_carries |= *prev_odd;
+  *prev_odd = ends_odd ? 1 : 0;
+
+  const uint64_t even_ends = even_carries & ~backslash;
+  const uint64_t odd_ends = odd_carries & ~backslash;
+  // A series is of odd length if its start and its end differ in parity
+  return (even_ends & kOddBits) | (odd_ends & kEvenBits);
+}
+
+/// Bit i of the result is the xor of bits 0..i: set between an opening quote
+/// (inclusive) and a closing quote (exclusive)
+uint64_t PrefixXor(uint64_t bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+void CheckSize(std::string_view json) {
+  if (json.size() > std::numeric_limits<uint32_t>::max()) {
+    throw ParsingError(
+        std::format("JSON document of {} bytes is too large", json.size()));
+  }
+}
+
+}  // namespace
+
+std::vector<uint32_t> FindStructurals(std::string_view json) {
+  CheckSize(json);
+
+  // NB: Positions are written without push_back: a block has at most 64 of
+  // them, so capacity is checked once per block
+  std::vector<uint32_t> result(std::max(kBlockSize, json.size() / 4));
+  size_t size = 0;
+  // Carried over from the previous block
+  uint64_t prev_odd_backslash = 0;
+  uint64_t prev_in_string = 0;
+  uint64_t prev_scalar = 0;
+
+  // NB: The last block is padded with whitespace, which is never structural
+  char padded[kBlockSize];
+  for (size_t offset = 0; offset < json.size(); offset += kBlockSize) {
+    const char* block = json.data() + offset;
+    if (json.size() - offset < kBlockSize) {
+      std::memset(padded, ' ', kBlockSize);
+      std::memcpy(padded, block, json.size() - offset);
+      block = padded;
+    }
+
+    const BlockMasks masks = Classify(block);
+    const uint64_t escaped = FindEscaped(masks.backslash, &prev_odd_backslash);
+    const uint64_t quote = masks.quote & ~escaped;
+    const uint64_t in_string = PrefixXor(quote) ^ prev_in_string;
+    prev_in_string =
+        static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+    // Characters of numbers and literals
+    const uint64_t scalar =
+        ~(masks.op | masks.whitespace | quote | in_string);
+    const uint64_t scalar_starts = scalar & ~(scalar << 1 | prev_scalar);
+    prev_scalar = scalar >> 63;
+
+    uint64_t structurals =
+        (masks.op & ~in_string) | (quote & in_string) | scalar_starts;
+    if (size + kBlockSize > result.size()) {
+      result.resize(2 * result.size());
+    }
+    uint32_t* out = result.data() + size;
+    const int count = __builtin_popcountll(structurals);
+    for (int i = 0; i < count; ++i) {
+      out[i] = static_cast<uint32_t>(offset) +
+               static_cast<uint32_t>(__builtin_ctzll(structurals));
+      structurals &= structurals - 1;
+    }
+    size += static_cast<size_t>(count);
+  }
+
+  if (prev_in_string) {
+    throw ParsingError("JSON string is not closed");
+  }
+  result.resize(size);
+  return result;
+}
+
+namespace impl {
+
+std::vector<uint32_t> FindStructuralsScalar(std::string_view json) {
+  CheckSize(json);
+
+  std::vector<uint32_t> result;
+  bool in_string = false;
+  bool escape = false;
+  bool in_scalar = false;
+  for (size_t i = 0; i < json.size(); ++i) {
+    const char c = json[i];
+    if (in_string) {
+      if (escape) {
+        escape = false;
+      } else if (c == '\\') {
+        escape = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+
+    switch (c) {
+      case '"':
+        in_string = true;
+        in_scalar = false;
+        result.push_back(static_cast<uint32_t>(i));
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        in_scalar = false;
+        result.push_back(static_cast<uint32_t>(i));
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        in_scalar = false;
+        break;
+      default:
+        if (!in_scalar) {
+          result.push_back(static_cast<uint32_t>(i));
+        }
+        in_scalar = true;
+    }
+  }
+
+  if (in_string) {
+    throw ParsingError("JSON string is not closed");
+  }
+  return result;
+}
+
+}  // namespace impl
+
+}  // namespace magl::json
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace magl::json {
+
+struct ParsingError : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+// Stage 1 of the reader: the document is classified by blocks of 64 bytes into
+// bitmasks (one bit per byte) with SIMD instructions, and strings are found
+// with bitwise arithmetic on the masks instead of a byte-by-byte state machine.
+// Stage 2 (reader.hpp) only visits the structural positions.
+
+/// Returns ascending positions of
+/// - structural characters `{`, `}`, `[`, `]`, `:`, `,` outside strings,
+/// - opening quotes of strings,
+/// - first characters of other tokens (numbers, true, false, null).
+/// Throws ParsingError if a string is not closed
+std::vector<uint32_t> FindStructurals(std::string_view json);
+
+namespace impl {
+
+/// Byte-by-byte reference implementation of FindStructurals
+std::vector<uint32_t> FindStructuralsScalar(std::string_view json);
+
+}  // namespace impl
+
+}  // namespace magl::json
@@ -0,0 +1,263 @@
+#include <json/writer.hpp>
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace magl::json {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+/// Appends the escape sequence of a character that can not be written as is
+void AppendEscape(char c, std::string* to) {
+  switch (c) {
+    case '"':
+      to->append("\\\"");
+      return;
+    case '\\':
+      to->append("\\\\");
+      return;
+    case '\b':
+      to->append("\\b");
+      return;
+    case '\f':
+      to->append("\\f");
+      return;
+    case '\n':
+      to->append("\\n");
+      return;
+    case '\r':
+      to->append("\\r");
+      return;
+    case '\t':
+      to->append("\\t");
+      return;
+    default:
+      to->append("\\u00");
+      to->push_back(kHexDigits[static_cast<unsigned char>(c) >> 4]);
+      to->push_back(kHexDigits[static_cast<unsigned char>(c) & 0xF]);
+  }
+}
+
+bool NeedsEscape(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+}  // namespace
+
+namespace impl {
+
+void AppendEscaped(std::string_view s, std::string* to) {
+  to->push_back('"');
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i max_control = _mm_set1_epi8(0x1F);
+  // Characters are copied by runs between the ones that need escaping, which
+  // are found 16 bytes at a time
+  while (i + 16 <= s.size()) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data() + i));
+    // NB: max(c, 0x1F) == 0x1F iff c <= 0x1F as an unsigned byte
+    const __m128i escaped = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                     _mm_cmpeq_epi8(bytes, backslash)),
+        _mm_cmpeq_epi8(_mm_max_epu8(bytes, max_control), max_control));
+    const int mask = _mm_movemask_epi8(escaped);
+    if (mask == 0) {
+      to->append(s.data() + i, 16);
+      i += 16;
+      continue;
+    }
+    const int run = __builtin_ctz(mask);
+    to->append(s.data() + i, run);
+    AppendEscape(s[i + run], to);
+    i += run + 1;
+  }
+#endif
+  size_t run_begin = i;
+  for (; i < s.size(); ++i) {
+    if (NeedsEscape(s[i])) {
+      to->append(s.data() + run_begin, i - run_begin);
+      AppendEscape(s[i], to);
+      run_begin = i + 1;
+    }
+  }
+  to->append(s.data() + run_begin, s.size() - run_begin);
+  to->push_back('"');
+}
+
+void AppendEscapedScalar(std::string_view s, std::string* to) {
+  to->push_back('"');
+  for (const char c : s) {
+    if (NeedsEscape(c)) {
+      AppendEscape(c, to);
+    } else {
+      to->push_back(c);
+    }
+  }
+  to->push_back('"');
+}
+
+}  // namespace impl
+
+Writer::Writer(std::string* buffer) : out_(buffer) {}
+
+Writer::Writer(int fd) : out_(&buffer_), fd_(fd) {}
+
+Writer::~Writer() {
+  try {
+    Flush();
+  } catch (const std::system_error&) {
+  }
+}
+
+void Writer::Write(const value::Value& v) {
+  boost::apply_visitor(
+      [this](const auto& alternative) {
+        using V = std::decay_t<decltype(alternative)>;
+        if constexpr (std::is_same_v<V, value::StringValue>) {
+          WriteString(alternative);
+        } else if constexpr (std::is_same_v<V, value::LambdaValue>) {
+          throw std::invalid_argument("Lambdas can not be written as JSON.");
+        } else {
+          Write(alternative);
+        }
+      },
+      v);
+}
+
+void Writer::Write(value::IntegerValue v) {
+  BeginValue();
+  char buffer[24];
+  const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), v);
+  out_->append(buffer, end);
+  MaybeFlush();
+}
+
+void Writer::Write(value::FloatValue v) {
+  if (!std::isfinite(v)) {
+    throw std::invalid_argument(
+        std::format("{} can not be written as JSON.", v));
+  }
+  BeginValue();
+  char buffer[32];
+  // Shortest representation that reads back the same double
+  const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), v);
+  const std::string_view written{buffer, end};
+  out_->append(written);
+  if (written.find_first_of(".e") == std::string_view::npos) {
+    out_->append(".0");
+  }
+  MaybeFlush();
+}
+
+void Writer::Write(value::BoolValue v) {
+  BeginValue();
+  out_->append(v ? "true" : "false");
+  MaybeFlush();
+}
+
+void Writer::Write(value::NullValue) {
+  BeginValue();
+  out_->append("null");
+  MaybeFlush();
+}
+
+void Writer::Write(const value::ArrayValue& v) {
+  BeginArray();
+  for (const value::Value& item : v) {
+    Write(item);
+  }
+  EndArray();
+}
+
+void Writer::Write(const value::ObjectValue& v) {
+  BeginObject();
+  for (const auto& [key, item] : v) {
+    Key(key);
+    Write(item);
+  }
+  EndObject();
+}
+
+void Writer::WriteString(std::string_view v) {
+  BeginValue();
+  impl::AppendEscaped(v, out_);
+  MaybeFlush();
+}
+
+void Writer::BeginArray() {
+  BeginValue();
+  out_->push_back('[');
+  need_comma_ = false;
+}
+
+void Writer::EndArray() {
+  out_->push_back(']');
+  need_comma_ = true;
+  MaybeFlush();
+}
+
+void Writer::BeginObject() {
+  BeginValue();
+  out_->push_back('{');
+  need_comma_ = false;
+}
+
+void Writer::Key(std::string_view key) {
+  BeginValue();
+  impl::AppendEscaped(key, out_);
+  out_->push_back(':');
+  // The value follows the key without a comma
+  need_comma_ = false;
+}
+
+void Writer::EndObject() {
+  out_->push_back('}');
+  need_comma_ = true;
+  MaybeFlush();
+}
+
+void Writer::Flush() {
+  if (fd_ < 0) {
+    return;
+  }
+  size_t written = 0;
+  while (written < buffer_.size()) {
+    const ssize_t result =
+        ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+    if (result < 0) {
+      const int error = errno;
+      if (error == EINTR) {
+        continue;
+      }
+      buffer_.erase(0, written);
+      throw std::system_error(error, std::generic_category(),
+                              "JSON writer failed");
+    }
+    written += static_cast<size_t>(result);
+  }
+  buffer_.clear();
+}
+
+std::string Serialize(const value::Value& v) {
+  std::string result;
+  Writer{&result}.Write(v);
+  return result;
+}
+
+}  // namespace magl::json
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <functions/library/stream.hpp>
+#include <value/value.hpp>
+
+namespace magl::json {
+
+/// Serializes values as JSON straight into a growable buffer or a file
+/// descriptor. Values are written as they come, so a list can be streamed item
+/// by item between BeginArray and EndArray. Floats are written in the shortest
+/// form that reads back the same double, always with a fraction or an exponent
+/// so that they are read back as FloatValue (see reader.hpp).
+/// Throws std::invalid_argument for values that JSON can not represent:
+/// lambdas, NaN and infinities
+class Writer : public functions::library::IItemSink {
+ public:
+  /// Appends to `buffer`
+  explicit Writer(std::string* buffer);
+  /// Writes to `fd` through an internal buffer that is flushed when it grows
+  /// over kFlushSize and by Flush. Throws std::system_error if writing fails
+  explicit Writer(int fd);
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  /// Flushes the internal buffer, errors are ignored
+  ~Writer() override;
+
+  void Write(const value::Value& v);
+  void Write(value::IntegerValue v);
+  void Write(value::FloatValue v);
+  void Write(value::BoolValue v);
+  void Write(value::NullValue);
+  void Write(const value::ArrayValue& v);
+  void Write(const value::ObjectValue& v);
+  // NB: Not an overload of Write: a string literal would convert to bool
+  void WriteString(std::string_view v);
+
+  // Separators are inserted automatically
+  void BeginArray();
+  void EndArray();
+  void BeginObject();
+  /// Writes the key of the next value of an object
+  void Key(std::string_view key);
+  void EndObject();
+
+  /// Writes the internal buffer to the file descriptor
+  void Flush();
+
+  void Accept(value::IntegerValue item) override { Write(item); }
+  void Accept(value::FloatValue item) override { Write(item); }
+  void Accept(value::BoolValue item) override { Write(item); }
+  void Accept(const value::StringValue& item) override { WriteString(item); }
+  void Accept(value::NullValue item) override { Write(item); }
+  void Accept(const value::ArrayValue& item) override { Write(item); }
+  void Accept(const value::ObjectValue& item) override { Write(item); }
+  void Accept(const value::Value& item) override { Write(item); }
+
+  static constexpr size_t kFlushSize = 64 * 1024;
+
+ private:
+  /// Starts a value: writes a separator if needed
+  void BeginValue() {
+    if (need_comma_) {
+      out_->push_back(',');
+    }
+    need_comma_ = true;
+  }
+
+  /// Flushes the internal buffer if it is over kFlushSize
+  void MaybeFlush() {
+    if (fd_ >= 0 && out_->size() >= kFlushSize) {
+      Flush();
+    }
+  }
+
+ private:
+  std::string* out_;
+  // Set if writing to a file descriptor
+  int fd_ = -1;
+  std::string buffer_;
+  // Whether the next value or key is preceded by ','
+  bool need_comma_ = false;
+};
+
+/// Returns `v` serialized as JSON
+std::string Serialize(const value::Value& v);
+
+namespace impl {
+
+/// Appends `s` quoted and escaped to `to`
+void AppendEscaped(std::string_view s, std::string* to);
+
+/// Byte-by-byte reference implementation of AppendEscaped
+void AppendEscapedScalar(std::string_view s, std::string* to);
+
+}  // namespace impl
+
+}  // namespace magl::json
@@ -0,0 +1,118 @@
+#include <parser/compile-stats.hpp>
+
+#include <algorithm>
+#include <utility>
+
+#include <json/writer.hpp>
+
+namespace magl::parser {
+
+namespace {
+
+value::FloatValue ToMicroseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void WriteEvent(std::string_view name, std::chrono::nanoseconds start,
+                std::chrono::nanoseconds duration, json::Writer* writer) {
+  writer->Key("name");
+  writer->WriteString(name);
+  writer->Key("cat");
+  writer->WriteString("compile");
+  writer->Key("ph");
+  writer->WriteString("X");
+  writer->Key("ts");
+  writer->Write(ToMicroseconds(start));
+  writer->Key("dur");
+  writer->Write(ToMicroseconds(duration));
+  writer->Key("pid");
+  writer->Write(value::IntegerValue{0});
+  writer->Key("tid");
+  writer->Write(value::IntegerValue{0});
+}
+
+void WriteCounter(std::string_view key, size_t count, json::Writer* writer) {
+  writer->Key(key);
+  writer->Write(static_cast<value::IntegerValue>(count));
+}
+
+}  // namespace
+
+std::chrono::nanoseconds CompileStats::GetDuration(
+    std::string_view stage) const {
+  std::chrono::nanoseconds result{};
+  for (const CompileStage& s : stages) {
+    if (s.name == stage) {
+      result += s.duration;
+    }
+  }
+  return result;
+}
+
+ScopedStage::ScopedStage(CompileStats* stats, std::string name)
+    : stats_(stats) {
+  if (stats_) {
+    name_ = std::move(name);
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedStage::~ScopedStage() {
+  if (stats_) {
+    stats_->stages.push_back({
+        .name = std::move(name_),
+        .start = start_,
+        .duration = std::chrono::steady_clock::now() - start_,
+    });
+  }
+}
+
+std::string ToChromeTrace(std::span<const CompileStats> compilations) {
+  std::chrono::steady_clock::time_point origin =
+      std::chrono::steady_clock::time_point::max();
+  for (const CompileStats& stats : compilations) {
+    for (const CompileStage& stage : stats.stages) {
+      origin = std::min(origin, stage.start);
+    }
+  }
+
+  std::string result;
+  json::Writer writer{&result};
+  writer.BeginObject();
+  writer.Key("traceEvents");
+  writer.BeginArray();
+  for (const CompileStats& stats : compilations) {
+    if (stats.stages.empty()) {
+      continue;
+    }
+    std::chrono::steady_clock::time_point end = stats.stages.front().start;
+    for (const CompileStage& stage : stats.stages) {
+      end = std::max(end, stage.start + stage.duration);
+    }
+    const std::chrono::steady_clock::time_point start =
+        stats.stages.front().start;
+
+    writer.BeginObject();
+    WriteEvent(stats.name, start - origin, end - start, &writer);
+    writer.Key("args");
+    writer.BeginObject();
+    WriteCounter("tokens", stats.tokens, &writer);
+    WriteCounter("syntax_nodes", stats.syntax_nodes, &writer);
+    WriteCounter("type_variables", stats.type_variables, &writer);
+    WriteCounter("unification_steps", stats.unification_steps, &writer);
+    WriteCounter("runtime_nodes", stats.runtime_nodes, &writer);
+    writer.EndObject();
+    writer.EndObject();
+
+    for (const CompileStage& stage : stats.stages) {
+      writer.BeginObject();
+      WriteEvent(stage.name, stage.start - origin, stage.duration, &writer);
+      writer.EndObject();
+    }
+  }
+  writer.EndArray();
+  writer.EndObject();
+  return result;
+}
+
+}  // namespace magl::parser
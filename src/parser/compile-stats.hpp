@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace magl::parser {
+
+/// Wall time of a stage of a compilation
+struct CompileStage {
+  // "tokenize", "syntax", "inference", "terms" or "lowering"
+  std::string name;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::nanoseconds duration{};
+};
+
+/// Stages of a compilation and the work done by them, see Parse and
+/// executer::ExpressionOptions::compile_stats
+struct CompileStats {
+  // E.g. the source or the rule template, the label of the trace event
+  std::string name;
+  // In the order they ran. The syntax parser drives its own tokenizer, so
+  // "syntax" includes the time of "tokenize", which is a separate pass that
+  // only counts the tokens
+  std::vector<CompileStage> stages;
+  size_t tokens = 0;
+  size_t syntax_nodes = 0;
+  // Made by the type inference for unknown types and instances of polymorphic
+  // functions
+  size_t type_variables = 0;
+  // Type equations solved by the unification
+  size_t unification_steps = 0;
+  // Nodes of the tree the expression is lowered to including the bodies of
+  // lambdas, 0 for the other backends
+  size_t runtime_nodes = 0;
+
+  /// Returns the total time of the stages named `stage`
+  std::chrono::nanoseconds GetDuration(std::string_view stage) const;
+};
+
+/// Appends a stage to `stats` that lasts from construction to destruction.
+/// Does nothing without stats
+class ScopedStage {
+ public:
+  ScopedStage(CompileStats* stats, std::string name);
+  ~ScopedStage();
+
+  ScopedStage(const ScopedStage&) = delete;
+  ScopedStage& operator=(const ScopedStage&) = delete;
+
+ private:
+  CompileStats* stats_;
+  std::string name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// Renders compilations in the Chrome trace event format (chrome://tracing,
+/// Perfetto): a complete event per compilation with the counters as args and
+/// its stages nested in it. Timestamps are microseconds from the earliest
+/// stage
+std::string ToChromeTrace(std::span<const CompileStats> compilations);
+
+}  // namespace magl::parser
@@ -10,15 +10,56 @@
 
 namespace magl::parser {
 
-terms::SemanticGraph Parse(std::string_view code) {
+namespace {
+
+syntax::SyntaxTree ParseSyntax(std::string_view code) {
   // FIXME: Unnecessary copy
   std::istringstream ss(std::string{code});
   tokenizer::Tokenizer tokenizer{ss};
 
   const syntax::SyntaxParser parser;
-  const syntax::SyntaxTree syntax_tree = parser.Parse(&tokenizer);
+  return parser.Parse(&tokenizer);
+}
+
+/// The syntax parser pulls tokens as it goes, so they are counted by a
+/// separate pass
+size_t CountTokens(std::string_view code) {
+  std::istringstream ss(std::string{code});
+  tokenizer::Tokenizer tokenizer{ss};
+  size_t result = 0;
+  for (tokenizer::tokens::Token token = tokenizer.NextToken();
+       !boost::get<tokenizer::tokens::EofToken>(&token);
+       token = tokenizer.NextToken()) {
+    ++result;
+  }
+  return result;
+}
+
+}  // namespace
+
+terms::SemanticGraph Parse(std::string_view code,
+                           const terms::InputSchema& inputs,
+                           terms::InputSchema* placeholders,
+                           CompileStats* stats) {
+  if (!stats) {
+    return terms::Compile(ParseSyntax(code), inputs, placeholders);
+  }
+
+  {
+    const ScopedStage stage{stats, "tokenize"};
+    stats->tokens += CountTokens(code);
+  }
+  syntax::SyntaxTree syntax;
+  {
+    const ScopedStage stage{stats, "syntax"};
+    syntax = ParseSyntax(code);
+  }
+  stats->syntax_nodes += syntax::CountNodes(syntax);
+  return terms::Compile(syntax, inputs, placeholders, stats);
+}
 
-  return terms::Compile(syntax_tree);
+terms::InputSchema ParsePlaceholders(std::string_view code) {
+  return terms::CollectPlaceholders(ParseSyntax(code));
 }
 
 }  // namespace magl::parser
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <parser/compile-stats.hpp>
+#include <parser/terms/input-schema.hpp>
 #include <parser/terms/semantic-graph.hpp>
 
 #include <string>
 
 namespace magl::parser {
 
-terms::SemanticGraph Parse(std::string_view code);
+/// Placeholders of `code` become inputs after `inputs` and are appended to
+/// `placeholders` if it is set, see terms/input-schema.hpp. The stages and
+/// their counters are recorded in `stats` if it is set
+terms::SemanticGraph Parse(std::string_view code,
+                           const terms::InputSchema& inputs = {},
+                           terms::InputSchema* placeholders = nullptr,
+                           CompileStats* stats = nullptr);
+
+/// Returns placeholders of `code` without type inference
+terms::InputSchema ParsePlaceholders(std::string_view code);
 
 }
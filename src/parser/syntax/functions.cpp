@@ -12,6 +12,7 @@ static const std::set<std::string> functions = {
     "Divide",     //
     "Or",         //
     "And",        //
+    "If",         //
     "Map",        //
     "ToString",   //
     "GetAnyOne",  //
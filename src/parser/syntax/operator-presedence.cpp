@@ -43,6 +43,12 @@ std::optional<OperatorPresedence> GetOperatorPresedence(
           [](const CommaToken&) -> Opt {
             return OperatorPresedence::kPunctuation;
           },
+          [](const KeywordToken& t) -> Opt {
+            if (t == KeywordToken::kIn) {
+              return OperatorPresedence::kPunctuation;
+            }
+            return std::nullopt;
+          },
           [](const EofToken&) -> Opt {
             return OperatorPresedence::kPunctuation;
           },
@@ -2,6 +2,8 @@
 
 #include <cassert>
 #include <format>
+#include <optional>
+#include <unordered_map>
 
 #include <parser/syntax/functions.hpp>
 #include <parser/syntax/validation.hpp>
@@ -13,6 +15,20 @@ namespace {
 
 namespace tokens = tokenizer::tokens;
 
+std::optional<functions::Type> GetTypeByName(const std::string& name) {
+  static const std::unordered_map<std::string, functions::Type> kTypes = {
+      {"Int", functions::IntegerType{}}, {"Float", functions::DoubleType{}},
+      {"Bool", functions::BoolType{}},   {"String", functions::StringType{}},
+      {"Null", functions::NullType{}},   {"Any", functions::AnyType{}},
+  };
+
+  const auto find_type = kTypes.find(name);
+  if (find_type == kTypes.end()) {
+    return std::nullopt;
+  }
+  return find_type->second;
+}
+
 }  // namespace
 
 SyntaxParser::SyntaxParser() {
@@ -119,6 +135,10 @@ Term SyntaxParser::NextSimplestTerm(Stream* in) const {
             const tokens::NameToken name =
                 boost::get<tokens::NameToken>(in->Next());
 
+            if (name.value.starts_with('$')) {
+              return NextPlaceholder(in, name.value);
+            }
+
             auto maybe_function = GetFunction(name);
             if (maybe_function.has_value()) {
               return Term{maybe_function.value()};
@@ -259,6 +279,48 @@ Term SyntaxParser::NextSimplestTerm(Stream* in) const {
 
             return result;
           },
+          [in, this](const tokens::KeywordToken&) -> Term {
+            const tokens::KeywordToken keyword =
+                boost::get<tokens::KeywordToken>(in->Next());
+
+            if (keyword != tokens::KeywordToken::kLet) {
+              ThrowParsingError("Unexpected keyword 'in'.");
+            }
+
+            LetTerm result;
+
+            tokens::Token variable = in->Next();
+            if (!boost::get<tokens::NameToken>(&variable)) {
+              ThrowParsingError(
+                  "Expected a name token for variable name, got something "
+                  "else.");
+            }
+            if (!IsValidVariableName(
+                    boost::get<tokens::NameToken>(variable).value)) {
+              ThrowParsingError(
+                  std::format("Invalid variable name: {}",
+                              boost::get<tokens::NameToken>(variable).value));
+            }
+            result.variable = VariableTerm{
+                std::move(boost::get<tokens::NameToken>(variable).value)};
+
+            const tokens::Token assign = in->Next();
+            if (!boost::get<tokens::AssignToken>(&assign)) {
+              ThrowParsingError("Expected symbol '=', got something else.");
+            }
+
+            result.definition =
+                NextNode(in, OperatorPresedence::kBeforePunctuation);
+
+            const tokens::Token in_keyword = in->Next();
+            if (in_keyword != tokens::Token{tokens::KeywordToken::kIn}) {
+              ThrowParsingError("Expected keyword 'in', got something else.");
+            }
+
+            result.body = NextNode(in, OperatorPresedence::kBeforePunctuation);
+
+            return result;
+          },
           [this](const tokens::ColonToken&) -> Term {
             ThrowParsingError("Unexpected symbol ':'.");
           },
@@ -266,6 +328,26 @@ Term SyntaxParser::NextSimplestTerm(Stream* in) const {
       *in->Peek());
 }
 
+Term SyntaxParser::NextPlaceholder(Stream* in, std::string name) const {
+  PlaceholderTerm result{.name = std::move(name), .type = std::nullopt};
+  if (!boost::get<tokens::ColonToken>(in->Peek())) {
+    return result;
+  }
+  in->Next();
+
+  const tokens::Token type_name = in->Next();
+  if (!boost::get<tokens::NameToken>(&type_name)) {
+    ThrowParsingError("Expected a type name, got something else.");
+  }
+  const std::string& type = boost::get<tokens::NameToken>(type_name).value;
+  result.type = GetTypeByName(type);
+  if (!result.type) {
+    ThrowParsingError(std::format("Unknown type {} of placeholder {}", type,
+                                  result.name));
+  }
+  return result;
+}
+
 void SyntaxParser::ThrowParsingError(std::string message) const {
   // TODO: add position to the error message
   throw ParsingError(std::format("Parsing failed: {}", std::move(message)));
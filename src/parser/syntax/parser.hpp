@@ -30,6 +30,9 @@ class SyntaxParser {
 
   Term NextSimplestTerm(Stream* in) const;
 
+  /// `$name` or `$name: Type` after the name token
+  Term NextPlaceholder(Stream* in, std::string name) const;
+
   [[noreturn]] void ThrowParsingError(
       std::string message = "<no message>") const;
 
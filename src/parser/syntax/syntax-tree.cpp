@@ -1,3 +1,42 @@
 #include <parser/syntax/syntax-tree.hpp>
 
-namespace magl::parser::syntax {}  // namespace magl::parser::syntax
+#include <parser/utils/overloaded.hpp>
+
+namespace magl::parser::syntax {
+
+size_t CountNodes(const Term& t) {
+  return 1 + boost::apply_visitor(
+                 utils::overloaded{
+                     [](const LambdaTerm& lambda) {
+                       return CountNodes(lambda.body);
+                     },
+                     [](const LetTerm& let) {
+                       return CountNodes(let.definition) + CountNodes(let.body);
+                     },
+                     [](const ApplicationTerm& application) {
+                       size_t result = CountNodes(application.function);
+                       for (const Term& argument : application.arguments) {
+                         result += CountNodes(argument);
+                       }
+                       return result;
+                     },
+                     [](const ArrayTerm& array) {
+                       size_t result = 0;
+                       for (const Term& item : array.items) {
+                         result += CountNodes(item);
+                       }
+                       return result;
+                     },
+                     [](const ObjectTerm& object) {
+                       size_t result = 0;
+                       for (const auto& [key, item] : object.items) {
+                         result += CountNodes(item);
+                       }
+                       return result;
+                     },
+                     [](const auto&) -> size_t { return 0; },
+                 },
+                 t);
+}
+
+}  // namespace magl::parser::syntax
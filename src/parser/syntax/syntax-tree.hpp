@@ -2,6 +2,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <variant>
 #include <vector>
@@ -13,14 +14,17 @@
 /**
  * t := Func
  *    | x
+ *    | $x | $x: type
  *    | value
  *    | lambda x . t
+ *    | let x = t in t
  *    | t t
  *    | array(t, ..., t)
  *    | object(key: t, ..., key: t)
  * key := string
  * Func is one of predefined functions such as Map, Add, SchemaToDict
  * value := int | double | string | bool | none
+ * type := Int | Float | Bool | String | Null | Any
  *
  * SyntaxTree := t
  */
@@ -60,23 +64,41 @@ struct FunctionTerm {
   std::string name;
 };
 
+/// Value bound per evaluation, see parser/terms/input-schema.hpp. The type is
+/// declared by at least one occurrence of the placeholder
+struct PlaceholderTerm {
+  // Including the leading '$'
+  std::string name;
+  std::optional<functions::Type> type;
+};
+
 struct LambdaTerm;
+struct LetTerm;
 struct ApplicationTerm;
 struct ArrayTerm;
 struct ObjectTerm;
 
 using Term =
     boost::variant<VariableTerm, boost::recursive_wrapper<LambdaTerm>,
+                   boost::recursive_wrapper<LetTerm>,
                    boost::recursive_wrapper<ApplicationTerm>,
                    boost::recursive_wrapper<FunctionTerm>,
                    boost::recursive_wrapper<ArrayTerm>,
-                   boost::recursive_wrapper<ObjectTerm>, FundamentalTerm>;
+                   boost::recursive_wrapper<ObjectTerm>, FundamentalTerm,
+                   PlaceholderTerm>;
 
 struct LambdaTerm {
   VariableTerm argument;
   Term body;
 };
 
+/// Non-recursive binding: `variable` is visible in `body` only
+struct LetTerm {
+  VariableTerm variable;
+  Term definition;
+  Term body;
+};
+
 struct ApplicationTerm {
   Term function;
   std::vector<Term> arguments;
@@ -92,6 +114,9 @@ struct ObjectTerm {
 
 using SyntaxTree = Term;
 
+/// Returns the number of terms in `t` including itself
+size_t CountNodes(const Term& t);
+
 // Comparators
 
 /*
@@ -9,6 +9,8 @@
 #include <algorithm>
 #include <format>
 #include <iostream>
+#include <optional>
+#include <unordered_map>
 
 namespace magl::parser::terms {
 
@@ -43,9 +45,89 @@ const auto kGetValueVisitor = utils::overloaded{
     [](const syntax::BoolTerm& t) -> value::Value { return t.value; },
 };
 
+const auto kGetTypeVisitor = utils::overloaded{
+    [](const auto& t) -> functions::Type { return t.type; },
+};
+
+class CollectPlaceholdersVisitor : boost::static_visitor<void> {
+ public:
+  CollectPlaceholdersVisitor() = default;
+
+  void operator()(const syntax::PlaceholderTerm& t) {
+    const auto [it, inserted] = types_.emplace(t.name, t.type);
+    if (inserted) {
+      order_.push_back(t.name);
+      return;
+    }
+    if (!t.type) {
+      return;
+    }
+    if (it->second && !(*it->second == *t.type)) {
+      throw std::invalid_argument(
+          std::format("Placeholder {} is declared as {} and {}", t.name,
+                      ToString(*it->second), ToString(*t.type)));
+    }
+    it->second = t.type;
+  }
+
+  void operator()(const syntax::LambdaTerm& t) {
+    boost::apply_visitor(*this, t.body);
+  }
+
+  void operator()(const syntax::LetTerm& t) {
+    boost::apply_visitor(*this, t.definition);
+    boost::apply_visitor(*this, t.body);
+  }
+
+  void operator()(const syntax::ApplicationTerm& t) {
+    boost::apply_visitor(*this, t.function);
+    for (const syntax::Term& argument : t.arguments) {
+      boost::apply_visitor(*this, argument);
+    }
+  }
+
+  void operator()(const syntax::ArrayTerm& t) {
+    for (const syntax::Term& item : t.items) {
+      boost::apply_visitor(*this, item);
+    }
+  }
+
+  void operator()(const syntax::ObjectTerm& t) {
+    for (const auto& [key, item] : t.items) {
+      boost::apply_visitor(*this, item);
+    }
+  }
+
+  void operator()(const syntax::VariableTerm&) {}
+  void operator()(const syntax::FunctionTerm&) {}
+  void operator()(const syntax::FundamentalTerm&) {}
+
+  InputSchema GetResult() const {
+    InputSchema result;
+    for (const std::string& name : order_) {
+      const std::optional<functions::Type>& type = types_.at(name);
+      if (!type) {
+        throw std::invalid_argument(
+            std::format("Type of placeholder {} is not declared", name));
+      }
+      result.push_back({.name = name, .type = *type});
+    }
+    return result;
+  }
+
+ private:
+  std::unordered_map<std::string, std::optional<functions::Type>> types_;
+  std::vector<std::string> order_;
+};
+
 class CompileVisitor : boost::static_visitor<Term> {
  public:
-  CompileVisitor() {}
+  CompileVisitor(const InputSchema& inputs)
+      : variable_uid_gen_(inputs.size()) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      variables_.emplace(inputs[i].name, i);
+    }
+  }
 
   result_type operator()(const inference::FundamentalTerm& t) {
     value::Value value = boost::apply_visitor(kGetValueVisitor, t.value);
@@ -69,7 +151,7 @@ class CompileVisitor : boost::static_visitor<Term> {
             kGetValueVisitor,
             boost::get<inference::FundamentalTerm>(item).value));
       }
-      return ValueTerm{.value = value::ArrayValue{std::move(items)},
+      return ValueTerm{.value = value::ArrayValue(std::move(items)),
                        .type = t.type};
     }
 
@@ -207,6 +289,27 @@ class CompileVisitor : boost::static_visitor<Term> {
     };
   }
 
+  result_type operator()(const inference::LetTerm& t) {
+    // Compiled before the variable is introduced: let is non-recursive
+    Term definition = boost::apply_visitor(*this, t.definition);
+    functions::Type definition_type =
+        boost::apply_visitor(kGetTypeVisitor, definition);
+
+    const ScopedVariable var{&variables_, t.variable_name,
+                             variable_uid_gen_.GetUniqueID()};
+
+    return LetTerm{
+        .variable =
+            VariableTerm{
+                .uid = var.GetUID(),
+                .type = std::move(definition_type),
+            },
+        .definition = std::move(definition),
+        .body = boost::apply_visitor(*this, t.body),
+        .type = t.type,
+    };
+  }
+
  private:
   class ScopedVariable {
    public:
@@ -217,7 +320,8 @@ class CompileVisitor : boost::static_visitor<Term> {
       if (find_var != variables_->end()) {
         old_uid_ = find_var->second;
       }
-      variables_->emplace_hint(find_var, var_name_, var_uid_);
+      // NB: Shadows a variable with the same name, if any
+      variables_->insert_or_assign(var_name_, var_uid_);
     }
 
     const std::string& GetName() const { return var_name_; }
@@ -226,7 +330,7 @@ class CompileVisitor : boost::static_visitor<Term> {
 
     ~ScopedVariable() {
       if (old_uid_) {
-        variables_->emplace(var_name_, old_uid_.value());
+        variables_->insert_or_assign(var_name_, old_uid_.value());
       } else {
         variables_->erase(var_name_);
       }
@@ -247,12 +351,41 @@ class CompileVisitor : boost::static_visitor<Term> {
 
 }  // namespace
 
-SemanticGraph Compile(const syntax::SyntaxTree& syntax) {
+InputSchema CollectPlaceholders(const syntax::SyntaxTree& syntax) {
+  CollectPlaceholdersVisitor visitor;
+  boost::apply_visitor(visitor, syntax);
+  return visitor.GetResult();
+}
+
+SemanticGraph Compile(const syntax::SyntaxTree& syntax,
+                      const InputSchema& declared_inputs,
+                      InputSchema* placeholders, CompileStats* stats) {
+  std::optional<ScopedStage> inference_stage{std::in_place, stats,
+                                             "inference"};
+  InputSchema inputs = declared_inputs;
+  const InputSchema found_placeholders = CollectPlaceholders(syntax);
+  inputs.insert(inputs.end(), found_placeholders.begin(),
+                found_placeholders.end());
+  if (placeholders) {
+    placeholders->insert(placeholders->end(), found_placeholders.begin(),
+                         found_placeholders.end());
+  }
+
   inference::Grammar grammar = MakeGrammar(functions::MakeDefaultLibrary());
+  for (const InputVariable& input : inputs) {
+    const bool inserted = grammar.emplace(input.name, input.type).second;
+    if (!inserted) {
+      throw std::invalid_argument(
+          std::format("Input {} is declared twice or is a function.",
+                      input.name));
+    }
+  }
   const inference::TypeResolvedSyntaxTree resolved_syntax =
-      inference::InferTypes(syntax, std::move(grammar));
+      inference::InferTypes(syntax, std::move(grammar), stats);
+  inference_stage.reset();
 
-  return boost::apply_visitor(CompileVisitor{}, resolved_syntax);
+  const ScopedStage terms_stage{stats, "terms"};
+  return boost::apply_visitor(CompileVisitor{inputs}, resolved_syntax);
 }
 
 }  // namespace magl::parser::terms
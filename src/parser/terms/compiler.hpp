@@ -1,10 +1,24 @@
 #pragma once
 
+#include <parser/compile-stats.hpp>
 #include <parser/syntax/syntax-tree.hpp>
+#include <parser/terms/input-schema.hpp>
 #include <parser/terms/semantic-graph.hpp>
 
 namespace magl::parser::terms {
 
-SemanticGraph Compile(const syntax::SyntaxTree& syntax);
+/// Returns placeholders of `syntax` in the order of their first occurrence.
+/// Throws std::invalid_argument if the type of a placeholder is not declared
+/// or is declared differently
+InputSchema CollectPlaceholders(const syntax::SyntaxTree& syntax);
+
+/// Inputs are typed by the schema and are visible in the whole expression.
+/// Placeholders become inputs after `inputs` and are appended to
+/// `placeholders` if it is set. The "inference" and "terms" stages are
+/// recorded in `stats` if it is set
+SemanticGraph Compile(const syntax::SyntaxTree& syntax,
+                      const InputSchema& inputs = {},
+                      InputSchema* placeholders = nullptr,
+                      CompileStats* stats = nullptr);
 
 }
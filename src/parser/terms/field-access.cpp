@@ -0,0 +1,144 @@
+#include <parser/terms/field-access.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+
+namespace magl::parser::terms {
+
+namespace {
+
+/// Value reached from an input through constant keys
+struct Access {
+  size_t input;
+  FieldPath path;
+};
+
+class CollectFieldPathsVisitor : public boost::static_visitor<void> {
+ public:
+  explicit CollectFieldPathsVisitor(size_t inputs_count)
+      : result_(inputs_count) {}
+
+  /// Visits the root of a graph. Uids of let variables are unique only within
+  /// a graph, so the aliases of the previous one are dropped
+  void VisitGraph(const SemanticGraph& graph) {
+    aliases_.clear();
+    Visit(graph);
+  }
+
+  void Visit(const Term& t) {
+    if (std::optional<Access> access = GetAccess(t)) {
+      result_[access->input].push_back(std::move(access->path));
+      return;
+    }
+    boost::apply_visitor(*this, t);
+  }
+
+  void operator()(const LambdaTerm& t) { Visit(t.body); }
+
+  void operator()(const LetTerm& t) {
+    // The variable is an alias: its uses access the fields
+    if (std::optional<Access> access = GetAccess(t.definition)) {
+      aliases_.emplace(t.variable.uid, std::move(*access));
+    } else {
+      Visit(t.definition);
+    }
+    Visit(t.body);
+  }
+
+  void operator()(const ApplicationTerm& t) {
+    Visit(t.executable);
+    for (const Term& argument : t.arguments) {
+      Visit(argument);
+    }
+  }
+
+  // Not an input, see GetAccess
+  void operator()(const VariableTerm&) {}
+  void operator()(const FunctionTerm&) {}
+  void operator()(const ValueTerm&) {}
+
+  std::vector<std::vector<FieldPath>> GetResult() && {
+    for (std::vector<FieldPath>& paths : result_) {
+      std::sort(paths.begin(), paths.end());
+      // NB: A prefix is sorted before the paths it covers
+      std::vector<FieldPath> pruned;
+      for (FieldPath& path : paths) {
+        if (pruned.empty() || !IsPrefix(pruned.back(), path)) {
+          pruned.push_back(std::move(path));
+        }
+      }
+      paths = std::move(pruned);
+    }
+    return std::move(result_);
+  }
+
+ private:
+  std::optional<Access> GetAccess(const Term& t) const {
+    if (const auto* variable = boost::get<VariableTerm>(&t)) {
+      if (variable->uid < result_.size()) {
+        return Access{.input = variable->uid, .path = {}};
+      }
+      const auto find_alias = aliases_.find(variable->uid);
+      if (find_alias != aliases_.end()) {
+        return find_alias->second;
+      }
+      return std::nullopt;
+    }
+
+    const auto* application = boost::get<ApplicationTerm>(&t);
+    const auto* function =
+        application ? boost::get<FunctionTerm>(&application->executable)
+                    : nullptr;
+    if (!function) {
+      return std::nullopt;
+    }
+    if (function->name == "GetVar" && application->arguments.size() == 1) {
+      return GetAccess(application->arguments[0]);
+    }
+    if (function->name != "VarMapAt" || application->arguments.size() != 2) {
+      return std::nullopt;
+    }
+    const auto* key = boost::get<ValueTerm>(&application->arguments[1]);
+    const auto* key_string =
+        key ? boost::get<value::StringValue>(&key->value) : nullptr;
+    if (!key_string) {
+      return std::nullopt;
+    }
+    std::optional<Access> result = GetAccess(application->arguments[0]);
+    if (result) {
+      result->path.push_back(*key_string);
+    }
+    return result;
+  }
+
+  static bool IsPrefix(const FieldPath& prefix, const FieldPath& path) {
+    return prefix.size() <= path.size() &&
+           std::equal(prefix.begin(), prefix.end(), path.begin());
+  }
+
+ private:
+  std::vector<std::vector<FieldPath>> result_;
+  // Let variables defined by an access
+  std::unordered_map<size_t, Access> aliases_;
+};
+
+}  // namespace
+
+std::vector<std::vector<FieldPath>> CollectFieldPaths(
+    const SemanticGraph& graph, size_t inputs_count) {
+  CollectFieldPathsVisitor visitor{inputs_count};
+  visitor.VisitGraph(graph);
+  return std::move(visitor).GetResult();
+}
+
+std::vector<std::vector<FieldPath>> CollectFieldPaths(
+    std::span<const SemanticGraph> graphs, size_t inputs_count) {
+  CollectFieldPathsVisitor visitor{inputs_count};
+  for (const SemanticGraph& graph : graphs) {
+    visitor.VisitGraph(graph);
+  }
+  return std::move(visitor).GetResult();
+}
+
+}  // namespace magl::parser::terms
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include <parser/terms/semantic-graph.hpp>
+
+namespace magl::parser::terms {
+
+/// Object keys from the root of an input to an accessed value
+using FieldPath = std::vector<std::string>;
+
+/// Returns, for each of the first `inputs_count` inputs (see input-schema.hpp),
+/// the fields the graph can access: the paths of VarMapAt chains with constant
+/// keys, followed through let variables and GetVar. A chain used otherwise
+/// (e.g. an argument of a function or a lambda, VarMapAt with a computed key)
+/// accesses its whole value, an empty path stands for the whole input. Paths
+/// are sorted and none is a prefix of another. An unused input has no paths
+std::vector<std::vector<FieldPath>> CollectFieldPaths(
+    const SemanticGraph& graph, size_t inputs_count);
+
+/// Returns the fields any of `graphs` can access, which share the inputs
+std::vector<std::vector<FieldPath>> CollectFieldPaths(
+    std::span<const SemanticGraph> graphs, size_t inputs_count);
+
+}  // namespace magl::parser::terms
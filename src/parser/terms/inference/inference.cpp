@@ -4,6 +4,7 @@
 #include <boost/variant/static_visitor.hpp>
 #include <format>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -104,14 +105,19 @@ functions::Type ApplySubstitution(
 
 class Environment {
  public:
-  Environment(Grammar g) : next_id_(1000), grammar_(std::move(g)) {}
+  Environment(Grammar g) : next_id_(kFirstID), grammar_(std::move(g)) {}
 
   std::size_t MakeUniqueID() { return next_id_++; }
 
+  /// Number of IDs made by MakeUniqueID
+  std::size_t CountUniqueIDs() const { return next_id_ - kFirstID; }
+
   Grammar& GetGrammar() { return grammar_; }
   const Grammar& GetGrammar() const { return grammar_; }
 
  private:
+  static constexpr std::size_t kFirstID = 1000;
+
   std::size_t next_id_;
   Grammar grammar_;
 };
@@ -256,6 +262,13 @@ class ApplySubstitutionToSyntaxTreeVisitor : boost::static_visitor<void> {
     boost::apply_visitor(*this, t.body);
   }
 
+  result_type operator()(LetTerm& t) {
+    t.type =
+        boost::apply_visitor(ApplySubstitutionVisitor{*substitution_}, t.type);
+    boost::apply_visitor(*this, t.definition);
+    boost::apply_visitor(*this, t.body);
+  }
+
  private:
   const std::unordered_map<functions::TypeVariable, functions::Type>*
       substitution_;
@@ -317,7 +330,8 @@ class InferVisitor
       try {
         // type(l[0]) = type(l[i])
         // FIXME: Substitutions may be broken after aborting with an exception
-        Unify(front_type, argument_types[i], substitution_);
+        Unify(front_type, argument_types[i], substitution_,
+              &unification_steps_);
       } catch (const TypeMismatch&) {
         // List contains items of different types
         const functions::Type result_type =
@@ -362,7 +376,8 @@ class InferVisitor
       try {
         // type(l[0]) = type(l[i])
         // FIXME: Substitutions may be broken after aborting with an exception
-        Unify(front_type, value_types[it->first], substitution_);
+        Unify(front_type, value_types[it->first], substitution_,
+              &unification_steps_);
       } catch (const TypeMismatch&) {
         // List contains items of different types
         // TODO: Infer undecided Dict[Any]|Schema[T1, T2, ..., Tn]
@@ -397,6 +412,11 @@ class InferVisitor
     return {variable_type, VariableTerm{.type = variable_type, .name = t.name}};
   }
 
+  result_type operator()(const syntax::PlaceholderTerm& t) {
+    // Placeholders are inputs, see CollectPlaceholders
+    return (*this)(syntax::VariableTerm{.name = t.name});
+  }
+
   result_type operator()(const syntax::FunctionTerm& t) {
     if (!env_.GetGrammar().contains(t.name)) {
       throw std::runtime_error(std::format("Underfined symbol {}", t.name));
@@ -430,12 +450,20 @@ class InferVisitor
       auto [arg_type, resolved_arg] = boost::apply_visitor(*this, arg);
       result.arguments.push_back(resolved_arg);
 
+      if (result.arguments.size() == 1) {
+        if (auto field_access = GetSchemaFieldAccessType(app, arg_type)) {
+          // Replaces the instance of Dict[X] -> String -> X
+          result_type = *field_access;
+          boost::get<FunctionTerm>(result.function).type = *field_access;
+        }
+      }
+
       // std::clog << "inferencer(apply): calling unique_id" << std::endl;
       auto x = functions::TypeVariable{env_.MakeUniqueID()};
       auto lhs = functions::FunctionType{arg_type, x};
 
       // (arg_type -> x) = function_type
-      Unify(lhs, result_type, substitution_);
+      Unify(lhs, result_type, substitution_, &unification_steps_);
 
       // return x
       result_type = DereferenceVariable(substitution_, x);
@@ -463,7 +491,8 @@ class InferVisitor
     // std::clog << "inferencer(lambda): calling unique_id" << std::endl;
     auto x = functions::TypeVariable{env_.MakeUniqueID()};
     // x =~= (arg_type -> body_type)
-    Unify(x, functions::FunctionType{arg_type, body_type}, substitution_);
+    Unify(x, functions::FunctionType{arg_type, body_type}, substitution_,
+          &unification_steps_);
 
     result_type result = {
         DereferenceVariable(substitution_, x),
@@ -478,16 +507,31 @@ class InferVisitor
   }
 
   /// Non-recursive let
-  /* result_type operator()(const syntax::let& let) {
-    auto defn_type = boost::apply_visitor(*this, let.definition());
+  result_type operator()(const syntax::LetTerm& let) {
+    auto [definition_type, resolved_definition] =
+        boost::apply_visitor(*this, let.definition);
 
-    // introduce a scope with a generic variable
-    auto s = ScopedGenericVariable(this, let.name, defn_type);
+    // NB: The variable is not generalized. A bound value is evaluated once and
+    // kept in a single slot, so it cannot be instantiated with different types
+    const functions::TypeVariable variable_type{env_.MakeUniqueID()};
+    Unify(variable_type, definition_type, substitution_, &unification_steps_);
 
-    auto result = boost::apply_visitor(*this, let.body());
+    // introduce a scope with a non-generic variable
+    auto s = ScopedVariable(non_generic_variables_, env_, let.variable.name,
+                            variable_type);
 
-    return result;
-  } */
+    auto [body_type, resolved_body] = boost::apply_visitor(*this, let.body);
+
+    return {
+        body_type,
+        LetTerm{
+            .type = body_type,
+            .variable_name = let.variable.name,
+            .definition = std::move(resolved_definition),
+            .body = std::move(resolved_body),
+        },
+    };
+  }
 
   /// Recursive let
   /* result_type operator()(const syntax::letrec& letrec) {
@@ -512,6 +556,10 @@ class InferVisitor
     return substitution_;
   }
 
+  const Environment& GetEnvironment() const { return env_; }
+
+  std::size_t GetUnificationSteps() const { return unification_steps_; }
+
   class ScopedGenericVariable {
    public:
     ScopedGenericVariable(Environment& env, const std::string& variable_name,
@@ -521,13 +569,15 @@ class InferVisitor
       if (find_type != env.GetGrammar().end()) {
         old_type_ = std::move(find_type->second);
       }
-      env.GetGrammar().emplace_hint(find_type, variable_name,
-                                    std::move(variable_type));
+      // NB: Shadows a symbol with the same name, if any
+      env.GetGrammar().insert_or_assign(variable_name,
+                                        std::move(variable_type));
     }
 
     ~ScopedGenericVariable() {
       if (old_type_.has_value()) {
-        env_.GetGrammar().emplace(variable_name_, std::move(old_type_.value()));
+        env_.GetGrammar().insert_or_assign(variable_name_,
+                                           std::move(old_type_.value()));
       } else {
         env_.GetGrammar().erase(variable_name_);
       }
@@ -591,14 +641,51 @@ class InferVisitor
     return true;
   }
 
+  /// VarMapAt(x, "key") where x is a schema is typed by the field:
+  /// Schema{..., key: T, ...} -> String -> T
+  std::optional<functions::Type> GetSchemaFieldAccessType(
+      const syntax::ApplicationTerm& app, functions::Type object_type) const {
+    const auto* function = boost::get<syntax::FunctionTerm>(&app.function);
+    if (!function || function->name != "VarMapAt" ||
+        app.arguments.size() != 2) {
+      return std::nullopt;
+    }
+    const auto* fundamental =
+        boost::get<syntax::FundamentalTerm>(&app.arguments[1]);
+    const auto* key =
+        fundamental ? boost::get<syntax::StringTerm>(fundamental) : nullptr;
+    if (!key) {
+      return std::nullopt;
+    }
+
+    if (const auto* tau = boost::get<functions::TypeVariable>(&object_type)) {
+      object_type = DereferenceVariable(substitution_, *tau);
+    }
+    const auto* schema = boost::get<functions::SchemaType>(&object_type);
+    if (!schema) {
+      return std::nullopt;
+    }
+
+    const auto find_field = schema->values.find(key->value);
+    if (find_field == schema->values.end()) {
+      throw std::runtime_error(std::format("{} has no field {}",
+                                           ToString(object_type), key->value));
+    }
+    return functions::FunctionType{
+        object_type,
+        functions::FunctionType{functions::StringType{}, find_field->second}};
+  }
+
  private:
   Environment env_;
 
   std::unordered_set<functions::TypeVariable> non_generic_variables_;
   std::unordered_map<functions::TypeVariable, functions::Type> substitution_;
+  std::size_t unification_steps_ = 0;
 };
 
-TypeResolvedSyntaxTree InferTypes(const syntax::Term& t, Grammar g) {
+TypeResolvedSyntaxTree InferTypes(const syntax::Term& t, Grammar g,
+                                  CompileStats* stats) {
   Environment env{std::move(g)};
   InferVisitor inferer{std::move(env)};
 
@@ -609,6 +696,10 @@ TypeResolvedSyntaxTree InferTypes(const syntax::Term& t, Grammar g) {
   boost::apply_visitor(
       ApplySubstitutionToSyntaxTreeVisitor{&inferer.GetSubstitution()}, result);
 
+  if (stats) {
+    stats->type_variables += inferer.GetEnvironment().CountUniqueIDs();
+    stats->unification_steps += inferer.GetUnificationSteps();
+  }
   return result;
 }
 
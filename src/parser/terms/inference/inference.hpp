@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 
+#include <parser/compile-stats.hpp>
 #include <parser/syntax/syntax-tree.hpp>
 #include <parser/terms/inference/syntax-tree-types.hpp>
 
@@ -10,6 +11,8 @@ namespace magl::parser::terms::inference {
 using Grammar =
     std::unordered_map<std::string /*variable_name*/, functions::Type>;
 
-TypeResolvedSyntaxTree InferTypes(const syntax::Term& t, Grammar g);
+/// Adds the type variables and unification steps to `stats` if it is set
+TypeResolvedSyntaxTree InferTypes(const syntax::Term& t, Grammar g,
+                                  CompileStats* stats = nullptr);
 
 }  // namespace magl::parser::terms::inference
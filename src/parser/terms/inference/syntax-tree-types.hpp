@@ -29,12 +29,14 @@ struct FunctionTerm {
 };
 
 struct LambdaTerm;
+struct LetTerm;
 struct ApplicationTerm;
 struct ArrayTerm;
 struct ObjectTerm;
 
 using TypeResolvedTerm =
     boost::variant<VariableTerm, boost::recursive_wrapper<LambdaTerm>,
+                   boost::recursive_wrapper<LetTerm>,
                    boost::recursive_wrapper<ApplicationTerm>,
                    boost::recursive_wrapper<FunctionTerm>,
                    boost::recursive_wrapper<ArrayTerm>,
@@ -46,6 +48,13 @@ struct LambdaTerm {
   TypeResolvedTerm body;
 };
 
+struct LetTerm {
+  functions::Type type;
+  std::string variable_name;
+  TypeResolvedTerm definition;
+  TypeResolvedTerm body;
+};
+
 struct ApplicationTerm {
   functions::Type type;
   TypeResolvedTerm function;
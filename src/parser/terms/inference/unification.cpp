@@ -252,9 +252,11 @@ class UnifyVisitor : public boost::static_visitor<void> {
 
   UnifyVisitor(std::vector<Constraint> constraints,
                std::unordered_map<functions::TypeVariable, functions::Type>&
-                   substitution)
+                   substitution,
+               size_t* steps)
       : unification_stack_(std::move(constraints)),
-        substitution_(substitution) {
+        substitution_(substitution),
+        steps_(steps) {
     // add the current substitution to the stack
     // XXX this step might be unnecessary
     /* unification_stack_.insert(unification_stack_.end(),
@@ -266,6 +268,9 @@ class UnifyVisitor : public boost::static_visitor<void> {
       functions::Type x = std::move(unification_stack_.back().first);
       functions::Type y = std::move(unification_stack_.back().second);
       unification_stack_.pop_back();
+      if (steps_) {
+        ++*steps_;
+      }
 
       boost::apply_visitor(*this, x, y);
     }
@@ -302,6 +307,8 @@ class UnifyVisitor : public boost::static_visitor<void> {
  private:
   std::vector<Constraint> unification_stack_;
   std::unordered_map<functions::TypeVariable, functions::Type>& substitution_;
+  // Set if the solved constraints are counted
+  size_t* steps_;
 };
 
 }  // namespace
@@ -320,23 +327,26 @@ void ReplaceVariable(functions::Type& t,
 template <typename Iterator>
 void Unify(Iterator first_constraint, Iterator last_constraint,
            std::unordered_map<functions::TypeVariable, functions::Type>&
-               substitution) {
-  UnifyVisitor u({first_constraint, last_constraint}, substitution);
+               substitution,
+           size_t* steps = nullptr) {
+  UnifyVisitor u({first_constraint, last_constraint}, substitution, steps);
   u.Unify();
 }
 
 template <typename Range>
 void Unify(const Range& rng,
            std::unordered_map<functions::TypeVariable, functions::Type>&
-               substitution) {
-  return Unify(rng.begin(), rng.end(), substitution);
+               substitution,
+           size_t* steps = nullptr) {
+  return Unify(rng.begin(), rng.end(), substitution, steps);
 }
 
 void Unify(const functions::Type& x, const functions::Type& y,
            std::unordered_map<functions::TypeVariable, functions::Type>&
-               substitution) {
+               substitution,
+           size_t* steps) {
   auto c = Constraint(x, y);
-  return Unify(&c, &c + 1, substitution);
+  return Unify(&c, &c + 1, substitution, steps);
 }
 
 template <typename Range>
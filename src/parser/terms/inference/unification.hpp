@@ -42,8 +42,10 @@ void ReplaceVariable(functions::Type& t,
                      const functions::TypeVariable& replace_me,
                      const functions::Type& replacement);
 
+/// Counts the solved constraints in `steps` if it is set
 void Unify(
     const functions::Type& x, const functions::Type& y,
-    std::unordered_map<functions::TypeVariable, functions::Type>& substitution);
+    std::unordered_map<functions::TypeVariable, functions::Type>& substitution,
+    size_t* steps = nullptr);
 
 }  // namespace magl::parser::terms::inference
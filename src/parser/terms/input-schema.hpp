@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <functions/type.hpp>
+
+namespace magl::parser::terms {
+
+/// Root variable of an expression whose value is bound at evaluation time
+struct InputVariable {
+  std::string name;
+  functions::Type type;
+};
+
+/// Declared inputs of an expression. Input i is the variable with uid i in the
+/// semantic graph and the value i of EvaluationContext::inputs. Placeholders
+/// of the source (`$name: Type`) follow the declared inputs in the order of
+/// their first occurrence
+using InputSchema = std::vector<InputVariable>;
+
+}  // namespace magl::parser::terms
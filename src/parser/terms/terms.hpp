@@ -38,10 +38,14 @@ struct FunctionTerm {
 /// Defines a reusable function
 struct LambdaTerm;
 
+/// Binds a value to a variable within a body
+struct LetTerm;
+
 /// Evaluation point of a function or a lambda
 struct ApplicationTerm;
 
 using Term = boost::variant<VariableTerm, boost::recursive_wrapper<LambdaTerm>,
+                            boost::recursive_wrapper<LetTerm>,
                             boost::recursive_wrapper<ApplicationTerm>,
                             FunctionTerm, ValueTerm>;
 
@@ -52,6 +56,14 @@ struct LambdaTerm {
   functions::Type type;
 };
 
+struct LetTerm {
+  VariableTerm variable;
+  Term definition;
+  Term body;
+
+  functions::Type type;
+};
+
 struct ApplicationTerm {
   // Possible values:
   // - function
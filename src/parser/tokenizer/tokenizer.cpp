@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <format>
+#include <string_view>
 
 namespace magl::parser::tokenizer {
 
@@ -30,7 +31,12 @@ bool IsNameMiddleChar(unsigned char c) {
          c == '_';
 }
 
-bool IsValidNameToken(const std::string& buf) {
+bool IsValidNameToken(std::string_view buf) {
+  // Placeholders are names prefixed with '$'
+  if (!buf.empty() && buf.front() == '$') {
+    buf.remove_prefix(1);
+  }
+
   // [a-zA-Z_]
   if (buf.empty() ||
       !(buf.front() >= 'a' && buf.front() <= 'z' ||
@@ -100,14 +106,15 @@ tokens::Token Tokenizer::NextToken() {
           state = ParsingState::kString;
           break;
         }
-        if (c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c == '_') {
+        if (c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c == '_' ||
+            c == '$') {
           buf.push_back(NextChar());
           state = ParsingState::kName;
           break;
         }
         if (c == '+' || c == '*' || c == '|' || c == '&' || c == '[' ||
             c == ']' || c == '{' || c == '}' || c == '(' || c == ')' ||
-            c == ':' || c == ',') {
+            c == ':' || c == ',' || c == '=') {
           buf.push_back(NextChar());
           got_result = true;
           break;
@@ -137,7 +144,7 @@ tokens::Token Tokenizer::NextToken() {
         got_result = true;
         break;
       case ParsingState::kFalse:
-        static const std::string kFalse = "true";
+        static const std::string kFalse = "false";
 
         if (buf.size() >= kFalse.size()) {
           got_result = true;
@@ -277,6 +284,8 @@ tokens::Token Tokenizer::NextToken() {
           return tokens::ColonToken{};
         case ',':
           return tokens::CommaToken{};
+        case '=':
+          return tokens::AssignToken{};
         case '[':
           return tokens::SquareBracketToken::kOpened;
         case ']':
@@ -294,17 +303,20 @@ tokens::Token Tokenizer::NextToken() {
       }
     case ParsingState::kTrue:
       if (buf != "true") {
-        ThrowParsingError();
+        // A strict prefix of the keyword is an ordinary name
+        return ReadNameToken(buf);
       }
       return tokens::BoolToken{true};
     case ParsingState::kFalse:
       if (buf != "false") {
-        ThrowParsingError();
+        // A strict prefix of the keyword is an ordinary name
+        return ReadNameToken(buf);
       }
-      return tokens::BoolToken{true};
+      return tokens::BoolToken{false};
     case ParsingState::kLambda:
       if (buf != "lambda") {
-        ThrowParsingError();
+        // A strict prefix of the keyword is an ordinary name
+        return ReadNameToken(buf);
       }
       return tokens::LambdaToken{};
     case ParsingState::kMinus:
@@ -342,15 +354,26 @@ tokens::Token Tokenizer::NextToken() {
     case ParsingState::kStringEscape:
       ThrowParsingError();
     case ParsingState::kName:
-      if (!IsValidNameToken(buf)) {
-        ThrowParsingError();
-      }
-      return tokens::NameToken{buf};
+      return ReadNameToken(buf);
   }
 
   ThrowParsingError();
 }
 
+tokens::Token Tokenizer::ReadNameToken(const std::string& buf) const {
+  if (!IsValidNameToken(buf)) {
+    ThrowParsingError();
+  }
+  // Keywords without a dedicated parsing state
+  if (buf == "let") {
+    return tokens::KeywordToken::kLet;
+  }
+  if (buf == "in") {
+    return tokens::KeywordToken::kIn;
+  }
+  return tokens::NameToken{buf};
+}
+
 bool Tokenizer::IsEnd() const { return is_eof_; }
 
 size_t Tokenizer::SkipSpaces() {
@@ -25,6 +25,8 @@ class Tokenizer {
  private:
   size_t SkipSpaces();
 
+  Token ReadNameToken(const std::string& buf) const;
+
   [[noreturn]] void ThrowParsingError() const;
 
   unsigned char NextChar();
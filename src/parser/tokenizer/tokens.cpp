@@ -22,6 +22,7 @@ bool operator==(OrToken, OrToken) { return true; }
 bool operator==(AndToken, AndToken) { return true; }
 bool operator==(CommaToken, CommaToken) { return true; }
 bool operator==(LambdaToken, LambdaToken) { return true; }
+bool operator==(AssignToken, AssignToken) { return true; }
 bool operator==(ColonToken, ColonToken) { return true; }
 bool operator==(EofToken, EofToken) { return true; }
 
@@ -73,6 +74,20 @@ std::ostream& operator<<(std::ostream& Str, LambdaToken const&) {
   return Str << "Lambda";
 }
 
+std::ostream& operator<<(std::ostream& Str, KeywordToken const& v) {
+  switch (v) {
+    case KeywordToken::kLet:
+      return Str << "Let";
+    case KeywordToken::kIn:
+      return Str << "In";
+  }
+  return Str << "Keyword";
+}
+
+std::ostream& operator<<(std::ostream& Str, AssignToken const&) {
+  return Str << "Assign";
+}
+
 std::ostream& operator<<(std::ostream& Str, ColonToken const&) {
   return Str << "Colon";
 }
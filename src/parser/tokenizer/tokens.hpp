@@ -14,7 +14,9 @@
  * Double: -?[0-9]+.[0-9]+
  * String: ".*?"
  * Bool: (true|false)
+ * Keywords: lambda, let, in
  * Name: [a-zA-Z_][a-zA-Z_0]*
+ * Placeholder: $[a-zA-Z_][a-zA-Z_0]*, a name token with the leading '$'
  *
  *
  * Examples:
@@ -65,6 +67,10 @@ enum class RoundBracketToken { kOpened = 0, kClosed = 1 };
 
 struct CommaToken {};
 struct LambdaToken {};
+// NB: boost::variant is limited to 20 alternatives, so keywords without a
+// dedicated parsing state share a single token type
+enum class KeywordToken { kLet = 0, kIn = 1 };
+struct AssignToken {};
 struct ColonToken {};
 // struct DotToken {};
 
@@ -74,7 +80,8 @@ using Token = boost::variant<IntToken, DoubleToken, StringToken, NameToken,
                              PlusToken, MinusToken, MultToken, DivToken,
                              OrToken, AndToken, BoolToken, SquareBracketToken,
                              CurlyBracketToken, RoundBracketToken, CommaToken,
-                             LambdaToken, ColonToken, EofToken>;
+                             LambdaToken, KeywordToken, AssignToken,
+                             ColonToken, EofToken>;
 
 // Comparators
 
@@ -92,6 +99,7 @@ bool operator==(OrToken, OrToken);
 bool operator==(AndToken, AndToken);
 bool operator==(CommaToken, CommaToken);
 bool operator==(LambdaToken, LambdaToken);
+bool operator==(AssignToken, AssignToken);
 bool operator==(ColonToken, ColonToken);
 bool operator==(EofToken, EofToken);
 
@@ -116,6 +124,8 @@ std::ostream& operator<<(std::ostream& Str, OrToken const& v);
 std::ostream& operator<<(std::ostream& Str, AndToken const& v);
 std::ostream& operator<<(std::ostream& Str, CommaToken const& v);
 std::ostream& operator<<(std::ostream& Str, LambdaToken const& v);
+std::ostream& operator<<(std::ostream& Str, KeywordToken const& v);
+std::ostream& operator<<(std::ostream& Str, AssignToken const& v);
 std::ostream& operator<<(std::ostream& Str, ColonToken const& v);
 std::ostream& operator<<(std::ostream& Str, EofToken const& v);
 
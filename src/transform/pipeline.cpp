@@ -0,0 +1,327 @@
+#include <transform/pipeline.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <executer/expression.hpp>
+#include <json/reader.hpp>
+#include <json/writer.hpp>
+#include <transform/queue.hpp>
+
+namespace magl::transform {
+
+namespace {
+
+[[noreturn]] void ThrowSystemError(std::string_view what) {
+  throw std::system_error(errno, std::generic_category(), std::string(what));
+}
+
+/// Whole lines of the input
+struct Batch {
+  size_t index = 0;
+  // Number of the first line in the input, from 1
+  size_t first_line = 1;
+  // Set if the input is mapped, otherwise the lines are in `storage`
+  std::string_view mapped{};
+  std::string storage{};
+
+  std::string_view GetText() const {
+    return mapped.data() ? mapped : std::string_view{storage};
+  }
+};
+
+/// NDJSON results of a batch
+struct Output {
+  size_t index = 0;
+  std::string text{};
+  size_t records = 0;
+  size_t failed_records = 0;
+};
+
+/// Splits the input into batches of whole lines: a regular file is mapped,
+/// other inputs (pipes, terminals) are read
+class Input {
+ public:
+  explicit Input(int fd) : fd_(fd) {
+    struct stat status;
+    if (fstat(fd_, &status) != 0) {
+      ThrowSystemError("Can not stat the input");
+    }
+    if (!S_ISREG(status.st_mode) || status.st_size == 0) {
+      return;
+    }
+    const size_t size = static_cast<size_t>(status.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapped == MAP_FAILED) {
+      // Read instead, e.g. from a file system that does not support mmap
+      return;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    mapped_ = {static_cast<const char*>(mapped), size};
+  }
+
+  Input(const Input&) = delete;
+  Input& operator=(const Input&) = delete;
+
+  ~Input() {
+    if (mapped_.data()) {
+      munmap(const_cast<char*>(mapped_.data()), mapped_.size());
+    }
+  }
+
+  /// Returns false at the end of the input
+  bool Next(size_t batch_bytes, Batch* batch) {
+    batch->first_line = next_line_;
+    if (mapped_.data()) {
+      NextMapped(batch_bytes, batch);
+    } else {
+      NextRead(batch_bytes, batch);
+    }
+    const std::string_view text = batch->GetText();
+    next_line_ += static_cast<size_t>(
+        std::count(text.begin(), text.end(), '\n'));
+    return !text.empty();
+  }
+
+ private:
+  void NextMapped(size_t batch_bytes, Batch* batch) {
+    size_t end = std::min(offset_ + batch_bytes, mapped_.size());
+    if (end < mapped_.size()) {
+      const size_t line_end = mapped_.find('\n', end);
+      end = line_end == std::string_view::npos ? mapped_.size() : line_end + 1;
+    }
+    batch->mapped = mapped_.substr(offset_, end - offset_);
+    offset_ = end;
+  }
+
+  void NextRead(size_t batch_bytes, Batch* batch) {
+    std::string& storage = batch->storage;
+    storage = std::move(tail_);
+    tail_.clear();
+    // Reads at least one whole line unless the input ends
+    bool has_line_end = storage.find('\n') != std::string::npos;
+    while (!end_of_input_ && (storage.size() < batch_bytes || !has_line_end)) {
+      const size_t size = storage.size();
+      storage.resize(size + std::max(kReadSize, batch_bytes));
+      const ssize_t read_bytes =
+          read(fd_, storage.data() + size, storage.size() - size);
+      if (read_bytes < 0) {
+        storage.resize(size);
+        if (errno == EINTR) {
+          continue;
+        }
+        ThrowSystemError("Can not read the input");
+      }
+      storage.resize(size + static_cast<size_t>(read_bytes));
+      end_of_input_ = read_bytes == 0;
+      has_line_end = has_line_end ||
+                     std::memchr(storage.data() + size, '\n',
+                                 static_cast<size_t>(read_bytes)) != nullptr;
+    }
+    if (end_of_input_) {
+      return;
+    }
+    // The incomplete last line goes to the next batch
+    const size_t last_line_end = storage.rfind('\n');
+    tail_.assign(storage, last_line_end + 1);
+    storage.resize(last_line_end + 1);
+  }
+
+ private:
+  static constexpr size_t kReadSize = 64 * 1024;
+
+  const int fd_;
+  std::string_view mapped_;
+  size_t offset_ = 0;
+  // Read after the last complete line
+  std::string tail_;
+  bool end_of_input_ = false;
+  size_t next_line_ = 1;
+};
+
+void WriteAll(int fd, std::string_view text) {
+  while (!text.empty()) {
+    const ssize_t written = write(fd, text.data(), text.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ThrowSystemError("Can not write the output");
+    }
+    text.remove_prefix(static_cast<size_t>(written));
+  }
+}
+
+/// Evaluates the records of a batch
+class Worker {
+ public:
+  explicit Worker(const PipelineOptions& options)
+      : record_type_(options.record_type),
+        expression_(std::string_view{options.expression},
+                    executer::ExpressionOptions{
+                        .inputs = {{.name = "record", .type = record_type_}},
+                    }),
+        // Only the fields the expression reads are parsed
+        projection_(expression_.GetFieldPaths(0)) {}
+
+  Output Process(const Batch& batch) {
+    Output result{.index = batch.index};
+    std::string_view text = batch.GetText();
+    for (size_t line = batch.first_line; !text.empty(); ++line) {
+      const size_t line_end = text.find('\n');
+      std::string_view record = text.substr(0, line_end);
+      text.remove_prefix(line_end == std::string_view::npos ? text.size()
+                                                            : line_end + 1);
+      if (!record.empty() && record.back() == '\r') {
+        record.remove_suffix(1);
+      }
+      if (record.find_first_not_of(" \t") == std::string_view::npos) {
+        continue;
+      }
+
+      ++result.records;
+      const size_t size = result.text.size();
+      try {
+        const value::Value value =
+            json::Parse(record, record_type_, projection_);
+        const value::Value* inputs[] = {&value};
+        json::Writer writer{&result.text};
+        expression_.EvaluateTo({.inputs = inputs}, &writer);
+      } catch (const std::exception& e) {
+        ++result.failed_records;
+        result.text.resize(size);
+        result.text.append("null");
+        // NB: A single write is not interleaved with other workers
+        std::cerr << std::format("Line {}: {}\n", line, e.what());
+      }
+      result.text.push_back('\n');
+    }
+    return result;
+  }
+
+ private:
+  const functions::Type record_type_;
+  executer::Expression expression_;
+  const json::Projection projection_;
+};
+
+}  // namespace
+
+PipelineResult RunPipeline(const PipelineOptions& options, int input_fd,
+                           int output_fd) {
+  const size_t threads = std::max<size_t>(options.threads, 1);
+  const size_t max_batches = options.max_batches_in_flight > 0
+                                 ? options.max_batches_in_flight
+                                 : 4 * threads;
+
+  // NB: Compiled before the threads start, so that errors are thrown here.
+  // Expression::Evaluate is not thread-safe, each worker has its own
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (size_t i = 0; i < threads; ++i) {
+    workers.push_back(std::make_unique<Worker>(options));
+  }
+  Input input{input_fd};
+
+  BoundedQueue<Batch> batches{threads};
+  BoundedQueue<Output> outputs{max_batches};
+  // A token per batch that is read and not written yet. Bounds the batches
+  // that wait in the queues and for the ones before them to be written
+  BoundedQueue<bool> in_flight{max_batches};
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto fail = [&](std::exception_ptr e) {
+    {
+      std::lock_guard lock{error_mutex};
+      if (!error) {
+        error = e;
+      }
+    }
+    batches.Close();
+    outputs.Close();
+    in_flight.Close();
+  };
+
+  std::thread reader([&] {
+    try {
+      for (size_t index = 0;; ++index) {
+        Batch batch{.index = index};
+        if (!input.Next(options.batch_bytes, &batch)) {
+          break;
+        }
+        if (!in_flight.Push(true) || !batches.Push(std::move(batch))) {
+          break;
+        }
+      }
+      batches.Close();
+    } catch (...) {
+      fail(std::current_exception());
+    }
+  });
+
+  std::atomic<size_t> running_workers = threads;
+  std::vector<std::thread> worker_threads;
+  for (const std::unique_ptr<Worker>& worker : workers) {
+    worker_threads.emplace_back([&, worker = worker.get()] {
+      try {
+        while (std::optional<Batch> batch = batches.Pop()) {
+          if (!outputs.Push(worker->Process(*batch))) {
+            break;
+          }
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+      if (--running_workers == 0) {
+        outputs.Close();
+      }
+    });
+  }
+
+  // Writes the outputs in the order of the batches
+  PipelineResult result;
+  try {
+    std::map<size_t, Output> pending;
+    size_t next = 0;
+    while (std::optional<Output> output = outputs.Pop()) {
+      pending.emplace(output->index, std::move(*output));
+      for (auto it = pending.begin();
+           it != pending.end() && it->first == next; it = pending.begin()) {
+        WriteAll(output_fd, it->second.text);
+        result.records += it->second.records;
+        result.failed_records += it->second.failed_records;
+        pending.erase(it);
+        in_flight.Pop();
+        ++next;
+      }
+    }
+  } catch (...) {
+    fail(std::current_exception());
+  }
+
+  reader.join();
+  for (std::thread& worker : worker_threads) {
+    worker.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return result;
+}
+
+}  // namespace magl::transform
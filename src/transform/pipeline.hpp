@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <functions/type.hpp>
+
+namespace magl::transform {
+
+struct PipelineOptions {
+  // MAGL-T source evaluated once per record. The record is bound to the
+  // input `record`
+  std::string expression;
+  functions::Type record_type = functions::DictType{functions::AnyType{}};
+  size_t threads = 1;
+  // Records are read, evaluated and written by batches of about this size
+  size_t batch_bytes = 256 * 1024;
+  // Batches between reading and writing, bounds the memory of the pipeline
+  size_t max_batches_in_flight = 0;
+};
+
+struct PipelineResult {
+  size_t records = 0;
+  size_t failed_records = 0;
+};
+
+/// Reads newline-delimited JSON records from `input_fd`, evaluates the
+/// expression for each of them on `options.threads` workers and writes the
+/// results to `output_fd` as NDJSON in the input order. A record that fails is
+/// reported to stderr and written as null. Regular files are mapped with mmap
+/// instead of being read. Throws if the expression does not compile or if
+/// reading or writing fails
+PipelineResult RunPipeline(const PipelineOptions& options, int input_fd,
+                           int output_fd);
+
+}  // namespace magl::transform
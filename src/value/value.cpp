@@ -2,6 +2,10 @@
 
 namespace magl::value {
 
+PrehashedKey MakePrehashedKey(std::string_view key) {
+  return {.key = key, .hash = StringHash{}(key)};
+}
+
 bool IsPrimitive(const Value& value) {
   return boost::get<LambdaValue>(&value) == nullptr;
 }
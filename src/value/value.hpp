@@ -1,8 +1,11 @@
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -28,12 +31,53 @@ struct NullValue {};
 // Non-owning pointer to an evaluatable
 using LambdaValue = functions::IEvaluatable*;
 
+/// Object key with a hash computed ahead of lookup
+struct PrehashedKey {
+  std::string_view key;
+  size_t hash;
+};
+
+PrehashedKey MakePrehashedKey(std::string_view key);
+
+/// Transparent hash for object keys: lookups by std::string_view or by
+/// PrehashedKey do not construct a std::string
+struct StringHash {
+  using is_transparent = void;
+
+  size_t operator()(std::string_view key) const {
+    return std::hash<std::string_view>{}(key);
+  }
+  size_t operator()(const std::string& key) const {
+    return std::hash<std::string_view>{}(key);
+  }
+  size_t operator()(const char* key) const {
+    return std::hash<std::string_view>{}(key);
+  }
+  size_t operator()(const PrehashedKey& key) const { return key.hash; }
+};
+
+struct StringEqual {
+  using is_transparent = void;
+
+  bool operator()(std::string_view lhs, std::string_view rhs) const {
+    return lhs == rhs;
+  }
+  bool operator()(std::string_view lhs, const PrehashedKey& rhs) const {
+    return lhs == rhs.key;
+  }
+  bool operator()(const PrehashedKey& lhs, std::string_view rhs) const {
+    return lhs.key == rhs;
+  }
+};
+
 using Value = boost::make_recursive_variant<
     IntegerValue, FloatValue, BoolValue, StringValue, NullValue, LambdaValue,
     std::vector<boost::recursive_variant_>,
-    std::unordered_map<std::string, boost::recursive_variant_> >::type;
+    std::unordered_map<std::string, boost::recursive_variant_, StringHash,
+                       StringEqual> >::type;
 
-using ObjectValue = std::unordered_map<std::string, Value>;
+using ObjectValue = std::unordered_map<std::string, Value, StringHash,
+                                       StringEqual>;
 // TODO: Consider making value types for array of Integer, Float, etc. directly
 // TODO: Same for Object
 using ArrayValue = std::vector<Value>;
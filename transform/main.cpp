@@ -0,0 +1,108 @@
+// Evaluates a MAGL-T expression for each record of newline-delimited JSON.
+// The expression is read from <expression-file>.
+//
+// Usage: magl-transform [-j threads] [-t type] <expression-file> [input.ndjson]
+//
+// Records are read from the input file (mapped with mmap) or from stdin and
+// are bound to the input `record`. Results are written to stdout as NDJSON in
+// the input order. A record that fails is reported to stderr and is written as
+// null, the exit code is 1 then.
+//
+// The type of the records is described in JSON: "Int", "Float", "Bool",
+// "String", "Null" or "Any" for scalars, [T] for List[T], {"*": T} for
+// Dict[T] and {"key": T, ...} for a Schema. It is {"*": "Any"} by default.
+
+#include <transform/pipeline.hpp>
+
+#include <functions/utils/type-description.hpp>
+#include <json/reader.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+void PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program
+            << " [-j threads] [-t type] <expression-file> [input.ndjson]"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  magl::transform::PipelineOptions options;
+  options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+  int i = 1;
+  try {
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+      const std::string_view flag = argv[i];
+      const std::string_view argument = argv[i + 1];
+      if (flag == "-j") {
+        const char* end = argument.data() + argument.size();
+        const auto [ptr, error] =
+            std::from_chars(argument.data(), end, options.threads);
+        if (error != std::errc{} || ptr != end ||
+            options.threads == 0) {
+          throw std::invalid_argument("Invalid number of threads");
+        }
+      } else if (flag == "-t") {
+        options.record_type =
+            magl::functions::utils::ParseTypeDescription(
+                magl::json::Parse(argument));
+      } else {
+        throw std::invalid_argument("Unknown flag " + std::string(flag));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    PrintUsage(argv[0]);
+    return 2;
+  }
+  if (argc - i < 1 || argc - i > 2) {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+
+  std::ifstream expression{argv[i]};
+  if (!expression) {
+    std::cerr << "Can not open " << argv[i] << std::endl;
+    return 1;
+  }
+  std::stringstream source;
+  source << expression.rdbuf();
+  options.expression = source.str();
+
+  int input_fd = STDIN_FILENO;
+  if (argc - i == 2) {
+    input_fd = open(argv[i + 1], O_RDONLY);
+    if (input_fd < 0) {
+      std::cerr << "Can not open " << argv[i + 1] << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    const magl::transform::PipelineResult result =
+        magl::transform::RunPipeline(options, input_fd, STDOUT_FILENO);
+    if (result.failed_records > 0) {
+      std::cerr << result.failed_records << " of " << result.records
+                << " records failed" << std::endl;
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
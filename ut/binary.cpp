@@ -0,0 +1,199 @@
+#include <binary/encoder.hpp>
+#include <binary/mapped.hpp>
+#include <binary/view.hpp>
+#include <json/reader.hpp>
+
+#include <library/cpp/testing/gtest/gtest.h>
+
+#include <cstdio>
+#include <format>
+#include <limits>
+#include <string>
+#include <system_error>
+
+using namespace magl;
+
+TEST(Binary, RoundTrip) {
+  const value::Value values[] = {
+      value::NullValue{},
+      value::BoolValue{true},
+      value::BoolValue{false},
+      value::IntegerValue{0},
+      value::IntegerValue{-1},
+      value::IntegerValue{std::numeric_limits<int64_t>::min()},
+      value::IntegerValue{std::numeric_limits<int64_t>::max()},
+      value::FloatValue{-2.5},
+      value::StringValue{},
+      value::StringValue{std::string{"with\0zero", 9}},
+      value::ArrayValue{},
+      value::ObjectValue{},
+      json::Parse(R"({
+        "name": "magl",
+        "ids": [1, -2, 300000000000],
+        "scores": [0.5, 1e300],
+        "mixed": [1, 2.5, "three", null, [true], {"x": {}}]
+      })"),
+  };
+  for (const value::Value& v : values) {
+    EXPECT_TRUE(binary::Decode(binary::Encode(v)) == v);
+  }
+
+  EXPECT_THROW(binary::Encode(value::LambdaValue{nullptr}),
+               std::invalid_argument);
+}
+
+TEST(Binary, PackedArrays) {
+  value::ArrayValue integers;
+  for (int64_t i = 0; i < 100; ++i) {
+    integers.emplace_back(i * i - 50);
+  }
+  const std::string encoded = binary::Encode(integers);
+  // Tag, varint count, item size and the items in 2 bytes each
+  EXPECT_EQ(encoded.size(), 1 + 1 + 1 + 100 * sizeof(int16_t));
+
+  const binary::ArrayView view = binary::View(encoded).GetArray();
+  EXPECT_TRUE(view.IsPacked());
+  ASSERT_EQ(view.size(), 100u);
+  EXPECT_EQ(view.At(7).GetInteger(), 7 * 7 - 50);
+  EXPECT_THROW(view.At(100), std::out_of_range);
+  int64_t i = 0;
+  for (const binary::ValueView item : view) {
+    EXPECT_EQ(item.GetInteger(), i * i - 50);
+    ++i;
+  }
+  EXPECT_EQ(i, 100);
+
+  for (const int64_t bound :
+       {int64_t{-128}, int64_t{127}, int64_t{-129}, int64_t{32768},
+        int64_t{-2147483648}, int64_t{2147483648},
+        std::numeric_limits<int64_t>::min()}) {
+    const value::Value v =
+        value::ArrayValue{value::IntegerValue{0}, value::IntegerValue{bound}};
+    const std::string bound_encoded = binary::Encode(v);
+    EXPECT_TRUE(binary::Decode(bound_encoded) == v) << bound;
+    EXPECT_EQ(binary::View(bound_encoded).GetArray().At(1).GetInteger(),
+              bound);
+  }
+
+  const value::Value floats = value::ArrayValue{value::FloatValue{0.5},
+                                                value::FloatValue{-1.0}};
+  const std::string floats_encoded = binary::Encode(floats);
+  const binary::ArrayView float_view =
+      binary::View(floats_encoded).GetArray();
+  EXPECT_TRUE(float_view.IsPacked());
+  EXPECT_EQ(float_view.At(1).GetFloat(), -1.0);
+
+  // Integers and floats are not mixed in a packed array
+  const value::Value mixed = value::ArrayValue{value::IntegerValue{1},
+                                               value::FloatValue{1.0}};
+  const std::string mixed_encoded = binary::Encode(mixed);
+  EXPECT_FALSE(binary::View(mixed_encoded).GetArray().IsPacked());
+  EXPECT_TRUE(binary::Decode(mixed_encoded) == mixed);
+}
+
+TEST(Binary, Views) {
+  const std::string encoded = binary::Encode(json::Parse(R"({
+    "name": "a string that is longer than a small string",
+    "tags": ["a", {"b": [1]}, "c"],
+    "count": 3
+  })"));
+  const binary::ValueView root = binary::View(encoded);
+  ASSERT_EQ(root.GetKind(), binary::ValueView::Kind::kObject);
+  const binary::ObjectView object = root.GetObject();
+  EXPECT_EQ(object.size(), 3u);
+
+  // Strings are borrowed from the buffer
+  const std::string_view name = object.Find("name")->GetString();
+  EXPECT_EQ(name, "a string that is longer than a small string");
+  EXPECT_GE(name.data(), encoded.data());
+  EXPECT_LE(name.data() + name.size(), encoded.data() + encoded.size());
+
+  const binary::ArrayView tags = object.Find("tags")->GetArray();
+  EXPECT_FALSE(tags.IsPacked());
+  EXPECT_EQ(tags.At(2).GetString(), "c");
+  EXPECT_TRUE(tags.At(1).Materialize() == json::Parse(R"({"b": [1]})"));
+  EXPECT_EQ(object.Find("count")->GetInteger(), 3);
+  EXPECT_FALSE(object.Find("missing").has_value());
+  EXPECT_THROW(object.Find("count")->GetString(), std::invalid_argument);
+
+  size_t keys = 0;
+  for (const auto& [key, item] : object) {
+    EXPECT_TRUE(object.Find(key).has_value());
+    keys += item.GetKind() != binary::ValueView::Kind::kNull;
+  }
+  EXPECT_EQ(keys, 3u);
+}
+
+TEST(Binary, Malformed) {
+  const std::string encoded = binary::Encode(
+      json::Parse(R"({"a": [1, "two", [3.5, 4.5]], "b": {"c": null}})"));
+  // Every prefix is incomplete
+  for (size_t size = 0; size < encoded.size(); ++size) {
+    EXPECT_THROW(binary::Decode(encoded.substr(0, size)),
+                 binary::DecodingError)
+        << size;
+  }
+  EXPECT_THROW(binary::Decode(encoded + '\0'), binary::DecodingError);
+  EXPECT_THROW(binary::Decode("\x7F"), binary::DecodingError);
+  // A varint of 11 bytes
+  EXPECT_THROW(binary::Decode(std::string{"\x03"} + std::string(10, '\xFF') +
+                              '\x01'),
+               binary::DecodingError);
+  // A packed array that claims more items than there are bytes
+  EXPECT_THROW(binary::Decode("\x08\xFF\xFF\xFF\xFF\x0F"),
+               binary::DecodingError);
+
+  value::Value deep = value::NullValue{};
+  for (size_t i = 0; i < 2000; ++i) {
+    deep = value::ArrayValue{deep};
+  }
+  EXPECT_THROW(binary::Decode(binary::Encode(deep)), binary::DecodingError);
+}
+
+TEST(Binary, IndexedObjects) {
+  value::ObjectValue table;
+  for (int64_t i = 0; i < 1000; ++i) {
+    table.emplace(std::format("key-{}", i), value::IntegerValue{i});
+  }
+  const std::string encoded = binary::Encode(table);
+  EXPECT_TRUE(binary::Decode(encoded) == value::Value{table});
+
+  const binary::ObjectView view = binary::View(encoded).GetObject();
+  EXPECT_TRUE(view.IsIndexed());
+  for (int64_t i = 0; i < 1000; ++i) {
+    const std::optional<binary::ValueView> item =
+        view.Find(std::format("key-{}", i));
+    ASSERT_TRUE(item.has_value()) << i;
+    EXPECT_EQ(item->GetInteger(), i);
+  }
+  EXPECT_FALSE(view.Find("key-1000").has_value());
+  EXPECT_FALSE(view.Find("").has_value());
+
+  // Small objects are not indexed
+  const std::string small = binary::Encode(json::Parse(R"({"a": 1})"));
+  EXPECT_FALSE(binary::View(small).GetObject().IsIndexed());
+
+  // The count of slots is the last 4 bytes of an indexed object
+  std::string corrupted = encoded;
+  corrupted[corrupted.size() - 1] = '\x7F';
+  EXPECT_THROW(binary::View(corrupted), binary::DecodingError);
+}
+
+TEST(Binary, MappedValue) {
+  const std::string path = ::testing::TempDir() + "binary-mapped-value";
+  value::ObjectValue table;
+  for (int64_t i = 0; i < 100; ++i) {
+    table.emplace(std::format("key-{}", i),
+                  value::ArrayValue{value::IntegerValue{i}});
+  }
+  binary::EncodeToFile(table, path);
+
+  const binary::MappedValue mapped{path};
+  const binary::ArrayView item =
+      mapped.View().GetObject().Find("key-42")->GetArray();
+  EXPECT_EQ(item.At(0).GetInteger(), 42);
+  EXPECT_TRUE(mapped.View().Materialize() == value::Value{table});
+  std::remove(path.c_str());
+
+  EXPECT_THROW(binary::MappedValue{path}, std::system_error);
+}
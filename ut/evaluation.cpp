@@ -1,8 +1,19 @@
+#include <binary/mapped.hpp>
+#include <codegen/generator.hpp>
 #include <executer/expression.hpp>
+#include <executer/precompiled.hpp>
+#include <functions/library/add.hpp>
+#include <functions/library/multiply.hpp>
+#include <json/reader.hpp>
 #include <parser/parser.hpp>
 
 #include <library/cpp/testing/gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <thread>
+
 using namespace magl;
 
 TEST(Evaluation, Value) {
@@ -65,6 +76,843 @@ TEST(Evaluation, Lambda) {
   }
 }
 
+TEST(Evaluation, Let) {
+  {
+    executer::Expression ex{
+        parser::Parse("let y = 2 + 3 in GetVar(y) * GetVar(y)")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue(25)}));
+  }
+
+  {
+    // Non-recursive: the inner definition refers to the outer variable
+    executer::Expression ex{
+        parser::Parse("let x = 1 in let x = GetVar(x) + 10 in GetVar(x)")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue(11)}));
+  }
+
+  {
+    executer::Expression ex{parser::Parse(
+        "let f = lambda x: GetVar(x) * 2 in (lambda y: GetVar(y) + 1)(5)")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue(6)}));
+  }
+}
+
+TEST(Evaluation, ApplyLet) {
+  {
+    executer::Expression ex{
+        parser::Parse("(let x = 1 in lambda y: y + x)(2)")};
+    for (size_t i = 0; i < 2; ++i) {
+      EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue(3)}));
+    }
+  }
+
+  {
+    // Nested lets and a definition that is not trivially destructible
+    executer::Expression ex{parser::Parse(R"EOF(
+        (let s = "a string that does not fit in SSO buffer" in
+            let n = 2 in lambda y: [s, y])("y")
+    )EOF")};
+    for (size_t i = 0; i < 2; ++i) {
+      const value::Value result = ex.Evaluate({});
+      const auto& list = boost::get<value::ArrayValue>(result);
+      ASSERT_EQ(list.size(), 2);
+      EXPECT_TRUE((list[1] == value::Value{value::StringValue("y")}));
+    }
+  }
+}
+
+TEST(Evaluation, LetDestroysValues) {
+  // The value of the previous evaluation is destroyed, run under ASan to see
+  // leaks
+  {
+    executer::Expression ex{parser::Parse(R"EOF(
+        let s = "a string that does not fit in SSO buffer" in [s, s]
+    )EOF")};
+    for (size_t i = 0; i < 100; ++i) {
+      const value::Value result = ex.Evaluate({});
+      ASSERT_EQ(boost::get<value::ArrayValue>(result).size(), 2);
+    }
+  }
+
+  {
+    executer::Expression ex{parser::Parse(R"EOF(
+        let d = {"k": "a string that does not fit in SSO buffer"} in
+            VarMapAt(d, "k")
+    )EOF")};
+    for (size_t i = 0; i < 100; ++i) {
+      EXPECT_TRUE((ex.Evaluate({}) ==
+                   value::Value{value::StringValue(
+                       "a string that does not fit in SSO buffer")}));
+    }
+  }
+
+  {
+    // Destroyed with the expression if it is never evaluated again
+    executer::Expression ex{parser::Parse(R"EOF(let l = [1, 2, 3] in l)EOF")};
+    ex.Evaluate({});
+  }
+}
+
+TEST(Evaluation, Borrowed) {
+  {
+    // Variables are borrowed and copied only when the result escapes
+    executer::Expression ex{parser::Parse("(lambda x: x + 1)(1)")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue(2)}));
+  }
+
+  {
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda x: VarMapAt(VarMapAt(x, "inner"), "name"))(
+            {"inner": {"name": "abacaba"}}
+        )
+    )EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::StringValue("abacaba")}));
+  }
+
+  {
+    // Borrowed let definition
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda x: let s = VarMapAt(x, "name") in {"a": s, "b": GetVar(s)})(
+            {"name": "abacaba"}
+        )
+    )EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) ==
+                 value::Value{value::ObjectValue{
+                     {"a", value::StringValue{"abacaba"}},
+                     {"b", value::StringValue{"abacaba"}}}}));
+  }
+
+  {
+    // Borrowed argument is lent from a temporary
+    executer::Expression ex{
+        parser::Parse(R"EOF(VarMapAt({"a": "x", "b": "y"}, "b"))EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::StringValue("y")}));
+  }
+}
+
+TEST(Evaluation, VarMapAtKey) {
+  {
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda x: VarMapAt(x, "b") * 10)({"a": 1, "b": 2})
+    )EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue(20)}));
+  }
+
+  {
+    // Key is not a constant
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda k: VarMapAt({"a": "x", "b": "y"}, k))("a")
+    )EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::StringValue("x")}));
+  }
+
+  {
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda x: VarMapAt(x, "c"))({"a": 1, "b": 2})
+    )EOF")};
+    EXPECT_THROW(ex.Evaluate({}), std::out_of_range);
+  }
+}
+
+TEST(Evaluation, Logic) {
+  {
+    executer::Expression ex{parser::Parse("true & false")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::BoolValue{false}}));
+  }
+
+  {
+    executer::Expression ex{parser::Parse("false | true")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::BoolValue{true}}));
+  }
+
+  {
+    // Right-hand side is not evaluated: it would throw
+    executer::Expression ex{
+        parser::Parse(R"EOF(false & VarMapAt({"a": true}, "b"))EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::BoolValue{false}}));
+  }
+
+  {
+    executer::Expression ex{
+        parser::Parse(R"EOF(true | VarMapAt({"a": true}, "b"))EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::BoolValue{true}}));
+  }
+
+  {
+    executer::Expression ex{
+        parser::Parse(R"EOF(true & VarMapAt({"a": true}, "b"))EOF")};
+    EXPECT_THROW(ex.Evaluate({}), std::out_of_range);
+  }
+}
+
+TEST(Evaluation, If) {
+  {
+    executer::Expression ex{
+        parser::Parse(R"EOF(If(true, 1, VarMapAt({"a": 1}, "b")))EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue{1}}));
+  }
+
+  {
+    executer::Expression ex{parser::Parse(R"EOF(If(false, "x", "y"))EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::StringValue{"y"}}));
+  }
+
+  {
+    executer::Expression ex{
+        parser::Parse("(lambda x: If(x, 1, 2) * 10)(false)")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue{20}}));
+  }
+}
+
+TEST(Evaluation, FusedNodes) {
+  {
+    // Apply(FetchVariable)
+    executer::Expression ex{
+        parser::Parse("(lambda f: f(2) + f(3))(lambda x: x * 10)")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue{50}}));
+  }
+
+  {
+    // VarMapAt(x, const) and Add(X, const)
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda x: 1 + VarMapAt(x, "a") + (VarMapAt(x, "b") * 3))(
+            {"a": 10, "b": 20}
+        )
+    )EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue{71}}));
+  }
+
+  {
+    // Lazy arguments follow the fused one
+    executer::Expression ex{parser::Parse(R"EOF(
+        (lambda x: If(x, 1 + 1, VarMapAt({"a": 1}, "b")))(true)
+    )EOF")};
+    EXPECT_TRUE((ex.Evaluate({}) == value::Value{value::IntegerValue{2}}));
+  }
+}
+
+TEST(Evaluation, ClosureBackend) {
+  const std::vector<std::string> expressions = {
+      "2 * (11 + 10)",
+      "GetAnyOne() + GetAnyOne()",
+      R"EOF({"key": 40 + 2})EOF",
+      "(lambda x: (GetVar(x) * GetVar(x)) + GetVar(x))(10)",
+      "let x = 1 in let x = GetVar(x) + 10 in GetVar(x)",
+      R"EOF(false | If(true, true & true, VarMapAt({"a": true}, "b")))EOF",
+      R"EOF(
+        Map(
+            lambda x: {
+                    "aaa": VarMapAt(x, "a") * 100,
+                    "bbb": VarMapAt(x, "b") * 100
+                },
+            [
+                {"a": 1, "b": 2},
+                {"a": 3, "b": 4}
+            ]
+        )
+      )EOF",
+      R"EOF(
+        (lambda x: let s = VarMapAt(VarMapAt(x, "inner"), "name") in [s, s])(
+            {"inner": {"name": "abacaba"}}
+        )
+      )EOF",
+  };
+
+  for (const std::string& expression : expressions) {
+    executer::Expression tree{parser::Parse(expression)};
+    executer::Expression closure{
+        parser::Parse(expression),
+        executer::ExpressionOptions{.backend = executer::Backend::kClosure}};
+    EXPECT_TRUE(tree.Evaluate({}) == closure.Evaluate({})) << expression;
+  }
+}
+
+TEST(Evaluation, AnyArithmetics) {
+  const std::vector<std::string> expressions = {
+      "GetAnyOne() * (GetAnyOne() + GetAnyOne())",
+      R"EOF({"any": GetAnyOne() + GetAnyOne()})EOF",
+      "[GetAnyOne(), GetAnyOne() * GetAnyOne()]",
+  };
+
+  for (const std::string& expression : expressions) {
+    executer::Expression tree{parser::Parse(expression)};
+    executer::Expression closure{
+        parser::Parse(expression),
+        executer::ExpressionOptions{.backend = executer::Backend::kClosure}};
+    const value::Value expected = closure.Evaluate({});
+    // Both the miss and the hit of inline caches
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_TRUE(tree.Evaluate({}) == expected) << expression;
+      EXPECT_TRUE(closure.Evaluate({}) == expected) << expression;
+    }
+  }
+
+  {
+    executer::Expression ex{
+        parser::Parse("GetAnyOne() * (GetAnyOne() + GetAnyOne())")};
+    EXPECT_TRUE(ex.Evaluate({}) == value::Value{value::IntegerValue{2}});
+  }
+}
+
+TEST(Evaluation, AnyArithmeticsCommuted) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "d", .type = functions::DictType{functions::AnyType{}}},
+  };
+  const value::Value d = value::ObjectValue{
+      {"a", value::FloatValue{1.5}},
+      {"b", value::IntegerValue{2}},
+      {"c", value::FloatValue{0.5}},
+      {"s", value::StringValue{"ab"}},
+      {"t", value::StringValue{"cd"}},
+  };
+  const std::vector<const value::Value*> bound = {&d};
+  const executer::EvaluationContext context{.inputs = bound};
+
+  const std::vector<std::pair<std::string_view, value::Value>> expected = {
+      {R"(VarMapAt(d, "b") * VarMapAt(d, "a"))", value::FloatValue{3.0}},
+      {R"(VarMapAt(d, "a") * VarMapAt(d, "b"))", value::FloatValue{3.0}},
+      {R"(VarMapAt(d, "a") * VarMapAt(d, "c"))", value::FloatValue{0.75}},
+      {R"(VarMapAt(d, "b") + VarMapAt(d, "a"))", value::FloatValue{3.5}},
+      {R"(VarMapAt(d, "a") + VarMapAt(d, "b"))", value::FloatValue{3.5}},
+      {R"(VarMapAt(d, "a") + VarMapAt(d, "c"))", value::FloatValue{2.0}},
+      {R"(VarMapAt(d, "s") + VarMapAt(d, "t"))", value::StringValue{"abcd"}},
+  };
+  const std::vector<std::string_view> unsupported = {
+      R"(VarMapAt(d, "s") + VarMapAt(d, "b"))",
+      R"(VarMapAt(d, "a") + VarMapAt(d, "s"))",
+      R"(VarMapAt(d, "s") * VarMapAt(d, "t"))",
+  };
+
+  const std::vector<executer::ExpressionOptions> backends = {
+      {.backend = executer::Backend::kTree, .inputs = inputs},
+      {.backend = executer::Backend::kClosure, .inputs = inputs},
+  };
+  for (const executer::ExpressionOptions& options : backends) {
+    for (const auto& [expression, value] : expected) {
+      executer::Expression ex{expression, options};
+      // Both the miss and the hit of inline caches
+      for (size_t i = 0; i < 2; ++i) {
+        EXPECT_TRUE(ex.Evaluate(context) == value) << expression;
+      }
+    }
+    for (const std::string_view expression : unsupported) {
+      executer::Expression ex{expression, options};
+      EXPECT_THROW(ex.Evaluate(context), std::invalid_argument) << expression;
+    }
+  }
+}
+
+TEST(Evaluation, AnyArithmeticsOperands) {
+  // Operands are copies of heap-allocated strings, run under ASan to see leaks
+  const parser::terms::InputSchema inputs = {
+      {.name = "d", .type = functions::DictType{functions::AnyType{}}},
+  };
+  const value::Value d = value::ObjectValue{
+      {"a", value::StringValue(100, 'a')},
+      {"b", value::StringValue(100, 'b')},
+  };
+  const std::vector<const value::Value*> bound = {&d};
+  const executer::EvaluationContext context{.inputs = bound};
+
+  constexpr std::string_view kAdd = R"(VarMapAt(d, "a") + VarMapAt(d, "b"))";
+  executer::Expression add{kAdd, executer::ExpressionOptions{.inputs = inputs}};
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(add.Evaluate(context) ==
+                value::Value{value::StringValue(100, 'a') +
+                             value::StringValue(100, 'b')});
+  }
+
+  // Also when the kernel throws
+  constexpr std::string_view kMultiply =
+      R"(VarMapAt(d, "a") * VarMapAt(d, "b"))";
+  executer::Expression multiply{kMultiply,
+                                executer::ExpressionOptions{.inputs = inputs}};
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_THROW(multiply.Evaluate(context), std::invalid_argument);
+  }
+}
+
+TEST(Evaluation, ClosureArithmeticOperands) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "x", .type = functions::IntegerType{}},
+      {.name = "y", .type = functions::DoubleType{}},
+  };
+  const value::Value x = value::IntegerValue{7};
+  const value::Value y = value::FloatValue{0.25};
+  const std::vector<const value::Value*> bound = {&x, &y};
+  const executer::EvaluationContext context{.inputs = bound};
+
+  // Constant, input and computed operands in both positions
+  const std::vector<std::pair<std::string_view, value::Value>> expected = {
+      {"x * 2", value::IntegerValue{14}},
+      {"3 + x", value::IntegerValue{10}},
+      {"x * x + x", value::IntegerValue{56}},
+      {"(x + 1) * (x + 2)", value::IntegerValue{72}},
+      {"let z = x + 1 in z * x", value::IntegerValue{56}},
+      {"y * 0.5 + y", value::FloatValue{0.375}},
+      {"2.0 * y", value::FloatValue{0.5}},
+  };
+  for (const auto& [expression, value] : expected) {
+    executer::Expression closure{expression,
+                                 executer::ExpressionOptions{
+                                     .backend = executer::Backend::kClosure,
+                                     .inputs = inputs,
+                                 }};
+    EXPECT_TRUE(closure.Evaluate(context) == value) << expression;
+  }
+
+  // Inputs read inline are still checked
+  constexpr std::string_view kExpression = "x * 2";
+  executer::Expression closure{kExpression,
+                               executer::ExpressionOptions{
+                                   .backend = executer::Backend::kClosure,
+                                   .inputs = inputs,
+                               }};
+  const std::vector<const value::Value*> wrong = {&y, &y};
+  EXPECT_THROW(closure.Evaluate({.inputs = wrong}), std::invalid_argument);
+}
+
+TEST(Evaluation, InlineCache) {
+  functions::utils::BinaryInlineCache cache{
+      &functions::library::FindAddKernel, &functions::library::AddAny};
+
+  const value::Value one = value::IntegerValue{1};
+  const value::Value half = value::FloatValue{0.5};
+  const value::Value text = value::StringValue{"text"};
+
+  for (size_t i = 0; i < 2; ++i) {
+    EXPECT_TRUE(cache.Call(one, one) == value::Value{value::IntegerValue{2}});
+    EXPECT_TRUE(cache.Call(one, half) == value::Value{value::FloatValue{1.5}});
+    EXPECT_TRUE(cache.Call(half, one) == value::Value{value::FloatValue{1.5}});
+    EXPECT_TRUE(cache.Call(text, text) ==
+                value::Value{value::StringValue{"texttext"}});
+    // No typed kernel: the generic path reports the error
+    EXPECT_THROW(cache.Call(one, text), std::invalid_argument);
+    EXPECT_THROW(cache.Call(text, half), std::invalid_argument);
+  }
+}
+
+TEST(Evaluation, Tiering) {
+  const std::vector<std::string> expressions = {
+      "2 * (11 + 10)",
+      R"EOF({"key": 40 + 2})EOF",
+      "let x = 1 in let x = GetVar(x) + 10 in GetVar(x)",
+      // Not folded: the key is missing
+      R"EOF(If(true, 1, VarMapAt({"a": 1}, "b")))EOF",
+      R"EOF(
+        Map(
+            lambda x: {"aaa": VarMapAt(x, "a") * 100},
+            [{"a": 1}, {"a": 3}]
+        )
+      )EOF",
+  };
+
+  for (const std::string& expression : expressions) {
+    executer::Expression reference{parser::Parse(expression)};
+    const value::Value expected = reference.Evaluate({});
+
+    executer::Expression ex{parser::Parse(expression),
+                            executer::ExpressionOptions{
+                                .tier_up_after = 2,
+                                .background_tier_up = false,
+                            }};
+    for (size_t i = 0; i < 2; ++i) {
+      EXPECT_TRUE(ex.Evaluate({}) == expected) << expression;
+      EXPECT_FALSE(ex.IsOptimized()) << expression;
+    }
+    EXPECT_TRUE(ex.Evaluate({}) == expected) << expression;
+    EXPECT_TRUE(ex.IsOptimized()) << expression;
+  }
+
+  {
+    executer::Expression ex{parser::Parse("2 * (11 + 10)"),
+                            executer::ExpressionOptions{.tier_up_after = 1}};
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_TRUE(ex.Evaluate({}) == value::Value{value::IntegerValue{42}});
+    }
+    ex.WaitForOptimization();
+    EXPECT_TRUE(ex.IsOptimized());
+    EXPECT_TRUE(ex.Evaluate({}) == value::Value{value::IntegerValue{42}});
+  }
+}
+
+TEST(Evaluation, Speculation) {
+  const std::vector<std::string> expressions = {
+      "GetAnyOne() * (GetAnyOne() + GetAnyOne())",
+      R"EOF(
+        let d = {"a": GetAnyOne(), "b": GetAnyOne() + GetAnyOne()} in
+        VarMapAt(d, "a") * VarMapAt(d, "b") + VarMapAt(d, "b")
+      )EOF",
+      "(lambda x: GetVar(x) + GetVar(x) * GetVar(x))(GetAnyOne())",
+  };
+
+  for (const std::string& expression : expressions) {
+    executer::Expression reference{parser::Parse(expression)};
+    const value::Value expected = reference.Evaluate({});
+
+    executer::Expression ex{parser::Parse(expression),
+                            executer::ExpressionOptions{
+                                .tier_up_after = 1,
+                                .background_tier_up = false,
+                                .speculate_after = 2,
+                            }};
+    for (size_t i = 0; i < 5; ++i) {
+      EXPECT_TRUE(ex.Evaluate({}) == expected) << expression;
+    }
+    EXPECT_TRUE(ex.IsSpeculative()) << expression;
+  }
+
+  {
+    // Profile that does not match the values
+    const parser::terms::SemanticGraph graph =
+        parser::Parse("GetAnyOne() + GetAnyOne()");
+    const auto& add = boost::get<parser::terms::ApplicationTerm>(graph);
+    executer::TypeProfile profile;
+    profile.AddSite(&graph)->Record(value::FloatValue{});
+    profile.AddSite(&add.arguments.at(0))->Record(value::IntegerValue{});
+    profile.AddSite(&add.arguments.at(1))->Record(value::FloatValue{});
+
+    executer::CompiledClosure speculative = executer::CompileClosure(
+        graph, executer::ClosureOptions{.speculate = &profile});
+    const executer::EvaluationContext context;
+    executer::Frame frame{.context = &context};
+    EXPECT_THROW(speculative(frame), executer::DeoptimizationError);
+  }
+}
+
+TEST(Evaluation, Inputs) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "n", .type = functions::IntegerType{}},
+      {.name = "user",
+       .type = functions::SchemaType{{
+           {"age", functions::IntegerType{}},
+           {"name", functions::StringType{}},
+       }}},
+      {.name = "x", .type = functions::AnyType{}},
+  };
+
+  // Field access on a schema is typed statically
+  const parser::terms::SemanticGraph field =
+      parser::Parse(R"(VarMapAt(user, "name"))", inputs);
+  EXPECT_TRUE(boost::get<parser::terms::ApplicationTerm>(field).type ==
+              functions::Type{functions::StringType{}});
+  EXPECT_THROW(parser::Parse(R"(VarMapAt(user, "email"))", inputs),
+               std::runtime_error);
+  EXPECT_THROW(parser::Parse("n", {inputs.front(), inputs.front()}),
+               std::invalid_argument);
+
+  const value::Value n = value::IntegerValue{40};
+  const value::Value user = value::ObjectValue{
+      {"age", value::IntegerValue{2}},
+      {"name", value::StringValue{"magl"}},
+  };
+  const value::Value x = value::IntegerValue{1};
+  const std::vector<const value::Value*> bound = {&n, &user, &x};
+  const executer::EvaluationContext context{.inputs = bound};
+
+  const std::vector<std::pair<std::string_view, value::Value>> expected = {
+      {"n + VarMapAt(user, \"age\")", value::IntegerValue{42}},
+      {"VarMapAt(user, \"name\")", value::StringValue{"magl"}},
+      {"x + x", value::IntegerValue{2}},
+  };
+
+  const std::vector<executer::ExpressionOptions> backends = {
+      {.backend = executer::Backend::kTree, .inputs = inputs},
+      {.backend = executer::Backend::kClosure, .inputs = inputs},
+      {.inputs = inputs, .tier_up_after = 1, .background_tier_up = false},
+  };
+  const value::Value wrong_n = value::StringValue{"40"};
+  const std::vector<const value::Value*> wrong = {&wrong_n, &user, &x};
+  for (const executer::ExpressionOptions& options : backends) {
+    for (const auto& [expression, value] : expected) {
+      executer::Expression ex{expression, options};
+      for (size_t i = 0; i < 3; ++i) {
+        EXPECT_TRUE(ex.Evaluate(context) == value) << expression;
+      }
+      EXPECT_THROW(ex.Evaluate({}), std::invalid_argument) << expression;
+    }
+
+    executer::Expression ex{expected.front().first, options};
+    EXPECT_THROW(ex.Evaluate({.inputs = wrong}), std::invalid_argument);
+  }
+}
+
+TEST(Evaluation, InputsDeoptimization) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "x", .type = functions::AnyType{}},
+      {.name = "y", .type = functions::AnyType{}},
+  };
+  constexpr std::string_view kExpression = "x + y";
+  executer::Expression ex{kExpression, executer::ExpressionOptions{
+                                           .inputs = inputs,
+                                           .tier_up_after = 1,
+                                           .background_tier_up = false,
+                                           .speculate_after = 2,
+                                       }};
+
+  const value::Value one = value::IntegerValue{1};
+  const value::Value two = value::IntegerValue{2};
+  const std::vector<const value::Value*> integers = {&one, &two};
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_TRUE(ex.Evaluate({.inputs = integers}) ==
+                value::Value{value::IntegerValue{3}});
+  }
+  EXPECT_TRUE(ex.IsSpeculative());
+
+  const value::Value half = value::FloatValue{0.5};
+  const std::vector<const value::Value*> mixed = {&one, &half};
+  EXPECT_TRUE(ex.Evaluate({.inputs = mixed}) ==
+              value::Value{value::FloatValue{1.5}});
+  EXPECT_FALSE(ex.IsSpeculative());
+}
+
+TEST(Evaluation, Placeholders) {
+  constexpr std::string_view kExpression =
+      R"EOF(VarMapAt(user, $key: String) * $scale: Int + $scale)EOF";
+  const parser::terms::InputSchema inputs = {
+      {.name = "user", .type = functions::DictType{functions::IntegerType{}}},
+  };
+
+  const value::Value user = value::ObjectValue{
+      {"a", value::IntegerValue{2}},
+      {"b", value::IntegerValue{3}},
+  };
+
+  const std::vector<executer::ExpressionOptions> backends = {
+      {.backend = executer::Backend::kTree, .inputs = inputs},
+      {.backend = executer::Backend::kClosure, .inputs = inputs},
+      {.inputs = inputs, .tier_up_after = 1, .background_tier_up = false},
+  };
+  for (const executer::ExpressionOptions& options : backends) {
+    // Compiled once and evaluated with different constants
+    executer::Expression ex{kExpression, options};
+    ASSERT_EQ(ex.GetInputs().size(), 3ull);
+    EXPECT_EQ(ex.GetInputIndex("user"), 0ull);
+    EXPECT_EQ(ex.GetInputIndex("$key"), 1ull);
+    EXPECT_EQ(ex.GetInputIndex("$scale"), 2ull);
+    EXPECT_THROW(ex.GetInputIndex("$missing"), std::invalid_argument);
+
+    const std::vector<std::tuple<std::string, int64_t, int64_t>> bindings = {
+        {"a", 10, 30},
+        {"b", 10, 40},
+        {"b", 1, 4},
+    };
+    for (const auto& [key, scale, expected] : bindings) {
+      const value::Value key_value = value::StringValue{key};
+      const value::Value scale_value = value::IntegerValue{scale};
+      const std::vector<const value::Value*> bound = {&user, &key_value,
+                                                      &scale_value};
+      EXPECT_TRUE(ex.Evaluate({.inputs = bound}) ==
+                  value::Value{value::IntegerValue{expected}});
+    }
+  }
+
+  // Types are declared once
+  EXPECT_THROW(parser::Parse("$a + 1"), std::invalid_argument);
+  EXPECT_THROW(parser::Parse("$a: Int + $a: Float"), std::invalid_argument);
+  EXPECT_THROW(parser::Parse("$a: String + 1"),
+               std::runtime_error);
+}
+
+TEST(Evaluation, FieldPaths) {
+  const functions::Type user_type = functions::SchemaType{{
+      {"age", functions::IntegerType{}},
+      {"name", functions::StringType{}},
+      {"address", functions::SchemaType{{
+                      {"city", functions::StringType{}},
+                      {"zip", functions::IntegerType{}},
+                  }}},
+      {"scores", functions::DictType{functions::IntegerType{}}},
+  }};
+  const parser::terms::InputSchema inputs = {
+      {.name = "user", .type = user_type},
+      {.name = "n", .type = functions::IntegerType{}},
+      {.name = "unused", .type = functions::IntegerType{}},
+  };
+  using Paths = std::vector<parser::terms::FieldPath>;
+
+  constexpr std::string_view kExpression = R"EOF(
+      let address = VarMapAt(user, "address") in
+      VarMapAt(user, "age") * n + VarMapAt(address, "zip") +
+      VarMapAt(VarMapAt(user, "scores"), VarMapAt(address, "city"))
+  )EOF";
+  executer::Expression ex{kExpression,
+                          executer::ExpressionOptions{.inputs = inputs}};
+  // The computed key reads the whole dict
+  EXPECT_EQ(ex.GetFieldPaths(0),
+            (Paths{{"address", "city"}, {"address", "zip"}, {"age"},
+                   {"scores"}}));
+  EXPECT_EQ(ex.GetFieldPaths(1), Paths{{}});
+  EXPECT_EQ(ex.GetFieldPaths(2), Paths{});
+
+  // Only the accessed fields are read
+  const json::Projection projection{ex.GetFieldPaths(0)};
+  const value::Value user = json::Parse(
+      R"({"name": "magl", "age": 2, "history": [{"a": 1}, {"b": 2}],
+          "address": {"city": "x", "zip": 10, "street": "y"},
+          "scores": {"x": 100, "y": 200}})",
+      user_type, projection);
+  EXPECT_FALSE(boost::get<value::ObjectValue>(user).contains("name"));
+  const value::Value n = value::IntegerValue{3};
+  const value::Value unused = value::IntegerValue{0};
+  const std::vector<const value::Value*> bound = {&user, &n, &unused};
+  EXPECT_TRUE(ex.Evaluate({.inputs = bound}) ==
+              value::Value{value::IntegerValue{116}});
+
+  // Used as a value: the whole input
+  constexpr std::string_view kWhole = R"EOF([user, user])EOF";
+  executer::Expression whole{kWhole,
+                             executer::ExpressionOptions{.inputs = inputs}};
+  EXPECT_EQ(whole.GetFieldPaths(0), Paths{{}});
+}
+
+TEST(Evaluation, Precompiled) {
+  constexpr std::string_view kSource = "20 + 20 + 2";
+  // Differs from the interpreted result to tell which one is used
+  EXPECT_TRUE(executer::RegisterPrecompiled(
+      kSource, [](const executer::EvaluationContext&) -> value::Value {
+        return value::IntegerValue{-42};
+      }));
+  EXPECT_FALSE(executer::RegisterPrecompiled(kSource, nullptr));
+
+  {
+    executer::Expression ex{kSource};
+    EXPECT_TRUE(ex.Evaluate({}) == value::Value{value::IntegerValue{-42}});
+  }
+
+  {
+    executer::Expression ex{
+        kSource, executer::ExpressionOptions{.use_precompiled = false}};
+    EXPECT_TRUE(ex.Evaluate({}) == value::Value{value::IntegerValue{42}});
+  }
+
+  {
+    // Not registered
+    executer::Expression ex{std::string_view{"20 + 22"}};
+    EXPECT_TRUE(ex.Evaluate({}) == value::Value{value::IntegerValue{42}});
+  }
+}
+
+TEST(Evaluation, PrecompiledInputs) {
+  constexpr std::string_view kSource = "x * 2";
+  const executer::PrecompiledFunction function =
+      [](const executer::EvaluationContext&) -> value::Value {
+    return value::IntegerValue{-42};
+  };
+  static constexpr executer::PrecompiledInput kInputs[] = {{"x", "INT"}};
+  EXPECT_TRUE(executer::RegisterPrecompiled(kSource, function, kInputs));
+  EXPECT_FALSE(executer::RegisterPrecompiled(kSource, nullptr, kInputs));
+  // The same source with other inputs is another function
+  static constexpr executer::PrecompiledInput kOtherInputs[] = {
+      {"x", "FLOAT"}};
+  EXPECT_TRUE(executer::RegisterPrecompiled(kSource, nullptr, kOtherInputs));
+
+  EXPECT_EQ(executer::FindPrecompiled(
+                kSource, {{.name = "x", .type = functions::IntegerType{}}}),
+            function);
+  EXPECT_EQ(executer::FindPrecompiled(
+                kSource, {{.name = "y", .type = functions::IntegerType{}}}),
+            nullptr);
+  EXPECT_EQ(executer::FindPrecompiled(kSource), nullptr);
+}
+
+TEST(Evaluation, PrecompiledWithDeclaredInputs) {
+  constexpr std::string_view kSource = "$n: Int * 2";
+  // As generated without declared inputs: the placeholder is input #0. Differs
+  // from the interpreted result to tell which one is used
+  EXPECT_TRUE(executer::RegisterPrecompiled(
+      kSource, [](const executer::EvaluationContext& context) -> value::Value {
+        return executer::GetInput<value::IntegerValue>(context, 0) * -2;
+      }));
+
+  const value::Value x = value::IntegerValue{1000};
+  const value::Value n = value::IntegerValue{21};
+  const std::vector<const value::Value*> bound = {&x, &n};
+  const parser::terms::InputSchema inputs = {
+      {.name = "x", .type = functions::IntegerType{}},
+  };
+  for (const bool use_precompiled : {true, false}) {
+    // The function is not used with other declared inputs
+    executer::Expression ex{kSource, executer::ExpressionOptions{
+                                         .inputs = inputs,
+                                         .use_precompiled = use_precompiled,
+                                     }};
+    EXPECT_TRUE(ex.Evaluate({.inputs = bound}) ==
+                value::Value{value::IntegerValue{42}})
+        << use_precompiled;
+  }
+
+  {
+    executer::Expression ex{kSource};
+    const std::vector<const value::Value*> placeholder = {&n};
+    EXPECT_TRUE(ex.Evaluate({.inputs = placeholder}) ==
+                value::Value{value::IntegerValue{-42}});
+  }
+
+  // As generated with `x` declared: the placeholder is input #1
+  static constexpr executer::PrecompiledInput kInputs[] = {{"x", "INT"}};
+  EXPECT_TRUE(executer::RegisterPrecompiled(
+      kSource,
+      [](const executer::EvaluationContext& context) -> value::Value {
+        return executer::GetInput<value::IntegerValue>(context, 1) * -2;
+      },
+      kInputs));
+  {
+    executer::Expression ex{kSource,
+                            executer::ExpressionOptions{.inputs = inputs}};
+    EXPECT_TRUE(ex.Evaluate({.inputs = bound}) ==
+                value::Value{value::IntegerValue{-42}});
+  }
+}
+
+TEST(Evaluation, PrecompiledGenerated) {
+  // ut/precompiled.magl, compiled by magl-codegen and linked into the test
+  constexpr std::string_view kSource =
+      "Map(lambda x: x + $k: Int, [1, 2, 3])\n";
+  ASSERT_NE(executer::FindPrecompiled(kSource), nullptr);
+
+  const value::Value k = value::IntegerValue{10};
+  const std::vector<const value::Value*> bound = {&k};
+  executer::Expression precompiled{kSource};
+  EXPECT_TRUE(precompiled.Explain().starts_with("PrecompiledFunction"));
+  executer::Expression tree{
+      kSource, executer::ExpressionOptions{.use_precompiled = false}};
+  const value::Value expected = value::ArrayValue{
+      value::IntegerValue{11}, value::IntegerValue{12}, value::IntegerValue{13}};
+  EXPECT_TRUE(precompiled.Evaluate({.inputs = bound}) == expected);
+  EXPECT_TRUE(tree.Evaluate({.inputs = bound}) == expected);
+}
+
+TEST(Evaluation, GenerateCpp) {
+  const std::string code = codegen::GenerateCpp(
+      R"EOF(let x = {"a": 1} in VarMapAt(x, "a") * 2)EOF",
+      codegen::GeneratorOptions{.function_name = "Double"});
+  EXPECT_NE(code.find("::magl::value::Value Double("),
+            std::string::npos);
+  EXPECT_NE(code.find(
+                "RegisterPrecompiled(kSource, &magl_generated::Double, kInputs)"),
+            std::string::npos);
+
+  const std::string with_inputs = codegen::GenerateCpp(
+      "n * 2", codegen::GeneratorOptions{
+                   .inputs = {{.name = "n", .type = functions::IntegerType{}}},
+               });
+  EXPECT_NE(
+      with_inputs.find("GetInput<::magl::value::IntegerValue>(context, 0)"),
+      std::string::npos);
+  // Registered with the declared inputs
+  EXPECT_NE(with_inputs.find(
+                R"EOF({std::string_view("n", 1), std::string_view("INT", 3)})EOF"),
+            std::string::npos);
+  const std::string with_placeholders = codegen::GenerateCpp("$n: Float * 2.0");
+  EXPECT_NE(
+      with_placeholders.find("GetInput<::magl::value::FloatValue>(context, 0)"),
+      std::string::npos);
+
+  EXPECT_THROW(codegen::GenerateCpp("lambda x: GetVar(x)"),
+               functions::UnsupportedType);
+}
+
 TEST(Evaluation, Debug) {
   {
     executer::Expression ex{parser::Parse("GetAnyOne()")};
@@ -115,3 +963,511 @@ TEST(Evaluation, AdvancedMap) {
                      value::ObjectValue{{"aaa", value::IntegerValue{300}},
                                         {"bbb", value::IntegerValue{400}}}}}));
 }
+
+TEST(Evaluation, EvaluateTo) {
+  constexpr std::string_view kMap = R"EOF(
+      Map(lambda x: {"a": VarMapAt(x, "a") * 2}, [{"a": 1}, {"a": 2}])
+  )EOF";
+
+  // Counts items passed by Map
+  class CountingWriter : public json::Writer {
+   public:
+    using json::Writer::Writer;
+
+    void Accept(const value::ObjectValue& item) override {
+      ++items;
+      json::Writer::Accept(item);
+    }
+
+    size_t items = 0;
+  };
+
+  const std::vector<executer::ExpressionOptions> backends = {
+      {.backend = executer::Backend::kTree},
+      {.backend = executer::Backend::kClosure},
+  };
+  for (const executer::ExpressionOptions& options : backends) {
+    executer::Expression ex{kMap, options};
+    std::string buffer;
+    CountingWriter writer{&buffer};
+    ex.EvaluateTo({}, &writer);
+    EXPECT_TRUE(json::Parse(buffer) == ex.Evaluate({})) << buffer;
+    // The tree interpreter streams the items
+    EXPECT_EQ(writer.items,
+              options.backend == executer::Backend::kTree ? 2u : 0u);
+  }
+
+  executer::Expression scalar{parser::Parse("2.5")};
+  std::string buffer;
+  json::Writer writer{&buffer};
+  scalar.EvaluateTo({}, &writer);
+  EXPECT_EQ(buffer, "2.5");
+}
+
+TEST(Evaluation, MappedInputs) {
+  const std::string path = ::testing::TempDir() + "evaluation-mapped-inputs";
+  value::ObjectValue products;
+  for (int64_t i = 0; i < 1000; ++i) {
+    products.emplace(std::format("sku-{}", i),
+                     value::ObjectValue{{"price", value::IntegerValue{i}}});
+  }
+  binary::EncodeToFile(products, path);
+  const binary::MappedValue mapped{path};
+
+  const parser::terms::InputSchema inputs = {
+      {.name = "products",
+       .type = functions::DictType{functions::SchemaType{{
+           {"price", functions::IntegerType{}},
+       }}}},
+      {.name = "sku", .type = functions::StringType{}},
+  };
+  const executer::ExpressionOptions options{
+      .inputs = inputs,
+      .mapped_inputs = {{.name = "products",
+                         .object = mapped.View().GetObject()}},
+  };
+  constexpr std::string_view kPrice =
+      R"(VarMapAt(VarMapAt(products, sku), "price") * 2)";
+  executer::Expression ex{kPrice, options};
+
+  for (const int64_t i : {0, 17, 999}) {
+    const value::Value sku = value::StringValue{std::format("sku-{}", i)};
+    // The mapped input is not bound
+    const value::Value* values[] = {nullptr, &sku};
+    EXPECT_TRUE(ex.Evaluate({.inputs = values}) ==
+                value::Value{value::IntegerValue{2 * i}});
+  }
+  const value::Value missing = value::StringValue{"sku-1000"};
+  const value::Value* values[] = {nullptr, &missing};
+  EXPECT_THROW(ex.Evaluate({.inputs = values}), std::out_of_range);
+
+  // The table is never built, so it can not be used as a whole
+  constexpr std::string_view kWhole = "products";
+  EXPECT_THROW((executer::Expression{kWhole, options}),
+               functions::UnsupportedType);
+  executer::ExpressionOptions closure = options;
+  closure.backend = executer::Backend::kClosure;
+  EXPECT_THROW((executer::Expression{kPrice, closure}), std::invalid_argument);
+
+  std::remove(path.c_str());
+}
+
+TEST(Evaluation, Incremental) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "doc",
+       .type = functions::SchemaType{{
+           {"a", functions::IntegerType{}},
+           {"b", functions::IntegerType{}},
+           {"items", functions::ListType{functions::IntegerType{}}},
+       }}},
+  };
+  const executer::ExpressionOptions options{.inputs = inputs,
+                                            .incremental = true};
+  auto make_doc = [](int64_t a, int64_t b) -> value::Value {
+    return value::ObjectValue{
+        {"a", value::IntegerValue{a}},
+        {"b", value::IntegerValue{b}},
+        {"items", value::ArrayValue{value::IntegerValue{1},
+                                    value::IntegerValue{2}}},
+    };
+  };
+  auto ints = [](std::vector<int64_t> items) -> value::Value {
+    return value::ArrayValue(items.begin(), items.end());
+  };
+  const executer::InputPath a{.input = 0, .path = {"a"}};
+  const executer::InputPath b{.input = 0, .path = {"b"}};
+  const executer::InputPath whole{.input = 0, .path = {}};
+
+  constexpr std::string_view kSource = R"EOF(
+      [VarMapAt(doc, "a") * 2, VarMapAt(doc, "b") * 3]
+  )EOF";
+  executer::Expression ex{kSource, options};
+  const value::Value v1 = make_doc(1, 2);
+  const value::Value* v1_inputs[] = {&v1};
+  EXPECT_TRUE(ex.Evaluate({.inputs = v1_inputs}) == ints({2, 6}));
+
+  // Only the changed paths are read again: the result of the unchanged one
+  // is kept even though the new version is another object
+  const value::Value v2 = make_doc(10, 20);
+  const value::Value* v2_inputs[] = {&v2};
+  EXPECT_TRUE(ex.Evaluate({.inputs = v2_inputs}, {{a}}) == ints({20, 6}));
+  EXPECT_TRUE(ex.Evaluate({.inputs = v2_inputs}, {{b}}) == ints({20, 60}));
+  EXPECT_TRUE(ex.Evaluate({.inputs = v1_inputs}, {{whole}}) == ints({2, 6}));
+  // A change inside a read path invalidates it too
+  const executer::InputPath inside_a{.input = 0, .path = {"a", "x"}};
+  EXPECT_TRUE(ex.Evaluate({.inputs = v2_inputs}, {{inside_a}}) ==
+              ints({20, 6}));
+  // Nothing is kept by a full evaluation
+  EXPECT_TRUE(ex.Evaluate({.inputs = v2_inputs}) == ints({20, 60}));
+  EXPECT_TRUE(ex.Evaluate({.inputs = v1_inputs}, {}) == ints({20, 60}));
+
+  // A subtree that does not depend on the argument of a lambda is kept across
+  // its calls too
+  constexpr std::string_view kMap = R"EOF(
+      Map(lambda x: x * (VarMapAt(doc, "a") + 1), VarMapAt(doc, "items"))
+  )EOF";
+  executer::Expression map{kMap, options};
+  EXPECT_TRUE(map.Evaluate({.inputs = v1_inputs}) == ints({2, 4}));
+  EXPECT_TRUE(map.Evaluate({.inputs = v2_inputs}, {{b}}) == ints({2, 4}));
+  EXPECT_TRUE(map.Evaluate({.inputs = v2_inputs}, {{a}}) == ints({11, 22}));
+
+  // Without memoization everything is recomputed
+  executer::Expression full{kSource, executer::ExpressionOptions{
+                                         .inputs = inputs}};
+  EXPECT_TRUE(full.Evaluate({.inputs = v1_inputs}) == ints({2, 6}));
+  EXPECT_TRUE(full.Evaluate({.inputs = v2_inputs}, {{a}}) == ints({20, 60}));
+
+  executer::ExpressionOptions closure = options;
+  closure.backend = executer::Backend::kClosure;
+  EXPECT_THROW((executer::Expression{kSource, closure}),
+               std::invalid_argument);
+}
+
+TEST(Evaluation, ExpressionSet) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "doc",
+       .type = functions::SchemaType{{
+           {"a", functions::IntegerType{}},
+           {"b", functions::IntegerType{}},
+           {"c", functions::IntegerType{}},
+           {"items", functions::ListType{functions::IntegerType{}}},
+       }}},
+  };
+  const std::string_view sources[] = {
+      R"(VarMapAt(doc, "a") * 2 + VarMapAt(doc, "b"))",
+      R"((VarMapAt(doc, "a") * 2 + VarMapAt(doc, "b")) * 10)",
+      R"(Map(lambda x: x * 3, VarMapAt(doc, "items")))",
+      // Equal to the previous one up to the name of the argument
+      R"(Map(lambda y: y * 3, VarMapAt(doc, "items")))",
+      // Invariant in the lambda
+      R"(Map(lambda x: x * (VarMapAt(doc, "a") * 2 + VarMapAt(doc, "b")),
+             VarMapAt(doc, "items")))",
+      // Reads the argument, so it is not shared
+      R"(Map(lambda x: x * 2 + 1, VarMapAt(doc, "items")))",
+      R"(Map(lambda x: x * 2 + 1, VarMapAt(doc, "items")))",
+  };
+  executer::ExpressionSet set{sources,
+                              executer::ExpressionOptions{.inputs = inputs}};
+  ASSERT_EQ(set.Size(), std::size(sources));
+  // a * 2 + b and the Map by 3. The one by 2 + 1 is its own class too
+  EXPECT_EQ(set.GetSharedCount(), 3);
+  EXPECT_EQ(set.GetFieldPaths(0),
+            (std::vector<parser::terms::FieldPath>{{"a"}, {"b"}, {"items"}}));
+
+  auto make_doc = [](int64_t a, int64_t b, std::vector<int64_t> items) {
+    return value::Value{value::ObjectValue{
+        {"a", value::IntegerValue{a}},
+        {"b", value::IntegerValue{b}},
+        {"c", value::IntegerValue{0}},
+        {"items", value::ArrayValue(items.begin(), items.end())},
+    }};
+  };
+  // Each document is evaluated from scratch and as separate expressions
+  for (const value::Value& doc :
+       {make_doc(1, 2, {1, 2}), make_doc(3, 4, {5}), make_doc(0, 0, {})}) {
+    const value::Value* doc_inputs[] = {&doc};
+    const std::vector<value::Value> results =
+        set.Evaluate({.inputs = doc_inputs});
+    ASSERT_EQ(results.size(), std::size(sources));
+    for (size_t i = 0; i < std::size(sources); ++i) {
+      executer::Expression ex{sources[i],
+                              executer::ExpressionOptions{.inputs = inputs}};
+      EXPECT_TRUE(results[i] == ex.Evaluate({.inputs = doc_inputs}))
+          << "Expression " << i;
+    }
+  }
+
+  const std::string_view with_placeholder[] = {"$x: Int + 1"};
+  EXPECT_THROW((executer::ExpressionSet{with_placeholder, {}}),
+               std::invalid_argument);
+  EXPECT_THROW(
+      (executer::ExpressionSet{
+          sources, executer::ExpressionOptions{
+                       .backend = executer::Backend::kClosure,
+                       .inputs = inputs,
+                   }}),
+      std::invalid_argument);
+}
+
+namespace {
+
+uint64_t allocated_bytes = 0;
+
+// Each read allocates 8 more bytes
+uint64_t CountAllocations() {
+  allocated_bytes += 8;
+  return allocated_bytes;
+}
+
+}  // namespace
+
+TEST(Evaluation, Profile) {
+  constexpr std::string_view kSource = "Map(lambda x: x * 3 + 1, [1, 2, 3])";
+  executer::Expression ex{kSource,
+                          executer::ExpressionOptions{
+                              .profile = true,
+                              .profile_allocations = &CountAllocations,
+                          }};
+  executer::Profiler* profiler = ex.GetProfiler();
+  ASSERT_NE(profiler, nullptr);
+  const value::Value expected = value::ArrayValue{
+      value::IntegerValue{4}, value::IntegerValue{7}, value::IntegerValue{10}};
+  EXPECT_TRUE(ex.Evaluate({}) == expected);
+  EXPECT_TRUE(ex.Evaluate({}) == expected);
+
+  // Call paths of the applications and the lambda body, the constant list is
+  // folded
+  const std::vector<executer::ProfileEntry> entries = profiler->GetEntries();
+  const std::string map = "Map: List[INT]";
+  const std::string lambda = "lambda: (INT) -> (INT)";
+  ASSERT_EQ(entries.size(), 4);
+  EXPECT_EQ(entries[0].stack, (std::vector<std::string>{map}));
+  EXPECT_EQ(entries[1].stack, (std::vector<std::string>{map, lambda}));
+  EXPECT_EQ(entries[2].stack,
+            (std::vector<std::string>{map, lambda, "Add: INT"}));
+  EXPECT_EQ(entries[3].stack, (std::vector<std::string>{
+                                  map, lambda, "Add: INT", "Multiply: INT"}));
+  EXPECT_EQ(entries[0].counters.calls, 2);
+  for (size_t i = 1; i < entries.size(); ++i) {
+    EXPECT_EQ(entries[i].counters.calls, 6);
+    EXPECT_LE(entries[i].counters.inclusive_cycles,
+              entries[i - 1].counters.inclusive_cycles);
+  }
+  for (const executer::ProfileEntry& entry : entries) {
+    EXPECT_LE(entry.counters.exclusive_cycles, entry.counters.inclusive_cycles);
+  }
+  // The counter is read once more by a leaf than when it entered
+  EXPECT_EQ(entries[3].counters.allocated_bytes, 6 * 8);
+
+  const std::string folded =
+      profiler->GetFoldedStacks(executer::ProfileMetric::kAllocatedBytes);
+  EXPECT_NE(folded.find(std::format("{};{};Add: INT;Multiply: INT 48\n", map,
+                                    lambda)),
+            std::string::npos);
+  EXPECT_EQ(std::count(folded.begin(), folded.end(), '\n'), 4);
+
+  profiler->Reset();
+  EXPECT_EQ(profiler->GetEntries()[0].counters.calls, 0);
+  EXPECT_TRUE(profiler->GetFoldedStacks().empty());
+
+  executer::Expression plain{kSource};
+  EXPECT_EQ(plain.GetProfiler(), nullptr);
+  // Multiply is profiled as it is in the source, not fused with its constant
+  EXPECT_EQ(ex.Explain().find("MultiplyIntConstImpl"), std::string::npos);
+  EXPECT_NE(plain.Explain().find("MultiplyIntConstImpl"), std::string::npos);
+  EXPECT_THROW((executer::Expression{
+                   kSource,
+                   executer::ExpressionOptions{
+                       .backend = executer::Backend::kClosure,
+                       .profile = true,
+                   }}),
+               std::invalid_argument);
+}
+
+TEST(Evaluation, Explain) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "doc",
+       .type = functions::SchemaType{{
+           {"a", functions::IntegerType{}},
+           {"any", functions::AnyType{}},
+       }}},
+  };
+  executer::Expression ex{
+      std::string_view{
+          R"(Map(lambda x: x * 3 + VarMapAt(doc, "a"), [1, 2, 3, 4]))"},
+      executer::ExpressionOptions{.inputs = inputs}};
+  const std::string text = ex.Explain();
+  for (const std::string_view expected : {
+           "MapImpl<Int, Int> :: List[INT] (Map)",
+           "body: AddIntImpl :: INT (Add)",
+           "MultiplyIntConstImpl :: INT (Multiply) cost=3 [fused with constant "
+           "argument 1]",
+           "VarMapAtConstImpl<Int> :: INT (VarMapAt) cost=2 [constant argument "
+           "1 bound at compile time]",
+           "GetValue<List> :: List[ANY] (constant) cost=5 [warning: generic "
+           "Any path; warning: copies a literal of 4 items per call]",
+       }) {
+    EXPECT_NE(text.find(expected), std::string::npos) << expected << text;
+  }
+
+  const value::Value json =
+      json::Parse(ex.Explain(executer::ExplainFormat::kJson));
+  const auto& root = boost::get<value::ObjectValue>(json);
+  EXPECT_TRUE(root.at("kernel") == value::Value{std::string{"MapImpl<Int, Int>"}});
+  EXPECT_TRUE(root.at("type") == value::Value{std::string{"List[INT]"}});
+  EXPECT_EQ(boost::get<value::ArrayValue>(root.at("children")).size(), 2);
+
+  const std::string dot = ex.Explain(executer::ExplainFormat::kDot);
+  EXPECT_TRUE(dot.starts_with("digraph plan {"));
+  EXPECT_NE(dot.find("n0 -> n1 [label=\"arg 0\"]"), std::string::npos);
+}
+
+TEST(Evaluation, Metrics) {
+  executer::MetricsRegistry metrics{&CountAllocations};
+  const parser::terms::InputSchema inputs = {
+      {.name = "x", .type = functions::IntegerType{}},
+  };
+  constexpr std::string_view kSource = "Map(lambda y: y * 3 + x, [1, 2, 3])";
+  executer::Expression ex{kSource,
+                          executer::ExpressionOptions{
+                              .inputs = inputs,
+                              .metrics = &metrics,
+                              .metrics_name = "rule",
+                              .metrics_calls = true,
+                          }};
+  const value::Value x = value::IntegerValue{1};
+  const value::Value* bound[] = {&x};
+  const value::Value expected = value::ArrayValue{
+      value::IntegerValue{4}, value::IntegerValue{7}, value::IntegerValue{10}};
+  EXPECT_TRUE(ex.Evaluate({.inputs = bound}) == expected);
+  EXPECT_TRUE(ex.Evaluate({.inputs = bound}) == expected);
+  // The input is not bound
+  EXPECT_THROW(ex.Evaluate({}), std::invalid_argument);
+
+  // Expressions with the same name share the counters, each thread counts
+  // into its own shard
+  auto count_other = [&metrics] {
+    executer::Expression other{
+        std::string_view{"1 + 2"},
+        executer::ExpressionOptions{.metrics = &metrics,
+                                    .metrics_name = "other"}};
+    for (size_t i = 0; i < 100; ++i) {
+      other.Evaluate({});
+    }
+  };
+  std::thread thread{count_other};
+  thread.join();
+  count_other();
+
+  const executer::MetricsSnapshot snapshot = metrics.Collect();
+  ASSERT_EQ(snapshot.expressions.size(), 2);
+  const executer::ExpressionMetrics& rule = snapshot.expressions[0];
+  EXPECT_EQ(rule.name, "rule");
+  EXPECT_EQ(rule.evaluations, 3);
+  EXPECT_EQ(rule.exceptions, 1);
+  // The counter is read once more at the end of each evaluation
+  EXPECT_EQ(rule.allocated_bytes, 3 * 8);
+  EXPECT_EQ(rule.evaluation_latency.GetCount(), 3);
+  EXPECT_LE(rule.evaluation_latency.GetQuantile(0.99),
+            rule.evaluation_latency.GetMax());
+  EXPECT_EQ(rule.compilation_latency.GetCount(), 1);
+  const executer::ExpressionMetrics& other = snapshot.expressions[1];
+  EXPECT_EQ(other.evaluations, 200);
+  EXPECT_EQ(other.exceptions, 0);
+  EXPECT_EQ(other.compilation_latency.GetCount(), 2);
+
+  // Functions are registered as their applications are compiled, innermost
+  // first. The failed evaluation calls none
+  EXPECT_EQ(snapshot.calls,
+            (std::vector<std::pair<std::string, uint64_t>>{
+                {"Multiply", 6}, {"Add", 6}, {"Map", 2}}));
+  // The counted applications are not fused with their constants
+  EXPECT_EQ(ex.Explain().find("MultiplyIntConstImpl"), std::string::npos);
+
+  executer::LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  EXPECT_EQ(histogram.GetCount(), 1000);
+  EXPECT_EQ(histogram.GetMax(), 1000000);
+  // Within the 1/16 precision of the buckets
+  EXPECT_NEAR(histogram.GetQuantile(0.5), 500000, 500000 / 16);
+  EXPECT_NEAR(histogram.GetQuantile(0.99), 990000, 990000 / 16);
+  EXPECT_EQ(histogram.GetQuantile(1), 1000000);
+  for (size_t bucket = 1; bucket < executer::LatencyHistogram::kBuckets;
+       ++bucket) {
+    const uint64_t lower = executer::LatencyHistogram::GetLowerBound(bucket);
+    EXPECT_EQ(executer::LatencyHistogram::GetBucket(lower), bucket);
+    EXPECT_EQ(executer::LatencyHistogram::GetBucket(lower - 1), bucket - 1);
+  }
+}
+
+TEST(Evaluation, CompileStats) {
+  constexpr std::string_view kSource = "Map(lambda x: x * 3 + 1, [1, 2, 3])";
+  parser::CompileStats stats;
+  executer::Expression ex{kSource, executer::ExpressionOptions{
+                                       .use_precompiled = false,
+                                       .compile_stats = &stats,
+                                   }};
+  EXPECT_EQ(stats.name, kSource);
+  std::vector<std::string> stages;
+  for (const parser::CompileStage& stage : stats.stages) {
+    stages.push_back(stage.name);
+  }
+  EXPECT_EQ(stages, (std::vector<std::string>{"tokenize", "syntax", "inference",
+                                              "terms", "lowering"}));
+  EXPECT_EQ(stats.GetDuration("syntax"), stats.stages[1].duration);
+  EXPECT_EQ(stats.tokens, 19);
+  // Map, Add and Multiply are applied to functions and arguments
+  EXPECT_EQ(stats.syntax_nodes, 14);
+  EXPECT_GT(stats.type_variables, 0);
+  EXPECT_GT(stats.unification_steps, 0);
+  // Map, the lambda value, the lambda, 4 nodes of the fused body, the list
+  EXPECT_EQ(stats.runtime_nodes, 8);
+
+  // A complete event for the compilation and one per stage
+  const value::Value trace =
+      json::Parse(parser::ToChromeTrace(std::span{&stats, 1}));
+  const auto& events = boost::get<value::ArrayValue>(
+      boost::get<value::ObjectValue>(trace).at("traceEvents"));
+  ASSERT_EQ(events.size(), 6);
+  const auto& compilation = boost::get<value::ObjectValue>(events[0]);
+  EXPECT_TRUE(compilation.at("name") == value::Value{std::string{kSource}});
+  EXPECT_TRUE(compilation.at("ph") == value::Value{std::string{"X"}});
+  EXPECT_TRUE(boost::get<value::ObjectValue>(compilation.at("args"))
+                  .at("tokens") == value::Value{value::IntegerValue{19}});
+  EXPECT_TRUE(boost::get<value::ObjectValue>(events[5]).at("name") ==
+              value::Value{std::string{"lowering"}});
+}
+
+TEST(Evaluation, Budget) {
+  const parser::terms::InputSchema inputs = {
+      {.name = "items", .type = functions::ListType{functions::IntegerType{}}},
+  };
+  value::ArrayValue items;
+  for (int64_t i = 0; i < 1000; ++i) {
+    items.push_back(value::IntegerValue{i});
+  }
+  const value::Value input = std::move(items);
+  const value::Value* bound[] = {&input};
+  constexpr std::string_view kSource = "Map(lambda x: x * 2 + 1, items)";
+
+  auto expect_exceeded = [&](executer::Expression* ex,
+                             const executer::EvaluationBudget& budget,
+                             executer::BudgetLimit limit) {
+    try {
+      ex->Evaluate({.inputs = bound, .budget = &budget});
+      ADD_FAILURE() << "The budget is not exceeded";
+    } catch (const executer::BudgetExceeded& e) {
+      EXPECT_EQ(e.GetLimit(), limit);
+    }
+  };
+
+  for (const executer::Backend backend :
+       {executer::Backend::kTree, executer::Backend::kClosure}) {
+    executer::Expression ex{kSource, executer::ExpressionOptions{
+                                         .backend = backend,
+                                         .inputs = inputs,
+                                         .use_precompiled = false,
+                                     }};
+    // A step per item
+    expect_exceeded(&ex, {.max_steps = 999}, executer::BudgetLimit::kSteps);
+    const executer::EvaluationBudget enough{.max_steps = 1000};
+    const value::Value result =
+        ex.Evaluate({.inputs = bound, .budget = &enough});
+    EXPECT_EQ(boost::get<value::ArrayValue>(result).size(), 1000);
+
+    expect_exceeded(&ex,
+                    {.deadline = std::chrono::steady_clock::now() -
+                                 std::chrono::seconds{1}},
+                    executer::BudgetLimit::kDeadline);
+    // Each read of the counter allocates 8 more bytes
+    expect_exceeded(&ex,
+                    {.max_allocated_bytes = 4,
+                     .allocation_counter = &CountAllocations},
+                    executer::BudgetLimit::kAllocatedBytes);
+
+    // An evaluation without a budget is not limited by the aborted ones
+    EXPECT_TRUE(ex.Evaluate({.inputs = bound}) == result);
+  }
+}
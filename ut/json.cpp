@@ -0,0 +1,265 @@
+#include <json/reader.hpp>
+#include <json/structural-index.hpp>
+#include <json/writer.hpp>
+
+#include <library/cpp/testing/gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include <unistd.h>
+
+using namespace magl;
+
+TEST(Json, Scalars) {
+  EXPECT_TRUE(json::Parse("42") == value::Value{value::IntegerValue{42}});
+  EXPECT_TRUE(json::Parse(" -7 ") == value::Value{value::IntegerValue{-7}});
+  EXPECT_TRUE(json::Parse("2.5e1") == value::Value{value::FloatValue{25.0}});
+  EXPECT_TRUE(json::Parse("true") == value::Value{value::BoolValue{true}});
+  EXPECT_TRUE(json::Parse("false") == value::Value{value::BoolValue{false}});
+  EXPECT_TRUE(json::Parse("null") == value::Value{value::NullValue{}});
+  // Out of the range of int64_t
+  EXPECT_TRUE(json::Parse("9223372036854775808") ==
+              value::Value{value::FloatValue{9223372036854775808.0}});
+
+  for (const std::string_view malformed :
+       {"", "01", "1.", ".5", "+1", "1e", "tru", "nul", "1 2", "-"}) {
+    EXPECT_THROW(json::Parse(malformed), json::ParsingError) << malformed;
+  }
+}
+
+TEST(Json, Strings) {
+  EXPECT_TRUE(json::Parse(R"("plain")") ==
+              value::Value{value::StringValue{"plain"}});
+  EXPECT_TRUE(json::Parse(R"("a\"b\\c\/d\n\t")") ==
+              value::Value{value::StringValue{"a\"b\\c/d\n\t"}});
+  EXPECT_TRUE(json::Parse(R"("é€😀")") ==
+              value::Value{value::StringValue{"é€\U0001F600"}});
+
+  for (const std::string_view malformed :
+       {R"("open)", R"("\x")", R"("\u12")", R"("\ud83d")", "\"\x01\""}) {
+    EXPECT_THROW(json::Parse(malformed), json::ParsingError) << malformed;
+  }
+}
+
+TEST(Json, Containers) {
+  const value::Value result = json::Parse(R"({
+    "name": "magl",
+    "tags": ["a", "b"],
+    "nested": {"x": 1, "y": [1.5, null, {}], "z": []}
+  })");
+
+  const value::Value expected = value::ObjectValue{
+      {"name", value::StringValue{"magl"}},
+      {"tags", value::ArrayValue{value::StringValue{"a"},
+                                 value::StringValue{"b"}}},
+      {"nested",
+       value::ObjectValue{
+           {"x", value::IntegerValue{1}},
+           {"y", value::ArrayValue{value::FloatValue{1.5}, value::NullValue{},
+                                   value::ObjectValue{}}},
+           {"z", value::ArrayValue{}},
+       }},
+  };
+  EXPECT_TRUE(result == expected);
+
+  for (const std::string_view malformed :
+       {"{", "[1,]", "{\"a\" 1}", "{1: 2}", "[1 2]", "{\"a\": 1,}", "[]]"}) {
+    EXPECT_THROW(json::Parse(malformed), json::ParsingError) << malformed;
+  }
+  EXPECT_THROW(json::Parse(std::string(2000, '[') + std::string(2000, ']')),
+               json::ParsingError);
+}
+
+TEST(Json, Typed) {
+  const functions::Type type = functions::SchemaType{{
+      {"id", functions::IntegerType{}},
+      {"score", functions::DoubleType{}},
+      {"tags", functions::ListType{functions::StringType{}}},
+      {"extra", functions::AnyType{}},
+  }};
+
+  const value::Value result = json::Parse(
+      R"({"id": 1, "score": 2, "tags": ["x"], "extra": [1], "skip": {"a": 1}})",
+      type);
+  const value::Value expected = value::ObjectValue{
+      {"id", value::IntegerValue{1}},
+      // Floats are unboxed as FloatValue even if written as integers
+      {"score", value::FloatValue{2.0}},
+      {"tags", value::ArrayValue{value::StringValue{"x"}}},
+      {"extra", value::ArrayValue{value::IntegerValue{1}}},
+  };
+  EXPECT_TRUE(result == expected);
+
+  // Missing field
+  EXPECT_THROW(json::Parse(R"({"id": 1, "score": 2, "tags": []})", type),
+               json::ParsingError);
+  // Mismatching types
+  EXPECT_THROW(json::Parse(R"(1.5)", functions::IntegerType{}),
+               json::ParsingError);
+  EXPECT_THROW(json::Parse(R"("1")", functions::DoubleType{}),
+               json::ParsingError);
+  EXPECT_THROW(json::Parse(R"({"a": "x"})",
+                           functions::DictType{functions::IntegerType{}}),
+               json::ParsingError);
+  EXPECT_THROW(json::Parse("1", functions::TypeVariable{1}),
+               std::invalid_argument);
+}
+
+TEST(Json, Projection) {
+  constexpr std::string_view kDocument = R"({
+    "id": 7,
+    "user": {"name": "magl", "tags": ["a", {"b": [1]}], "age": 3},
+    "payload": {"deep": [[{"x": "}]"}]], "escaped": "\"{"},
+    "flag": true
+  })";
+
+  json::Projection projection;
+  projection.Add(std::vector<std::string>{"user", "age"});
+  projection.Add(std::vector<std::string>{"user", "tags"});
+  projection.Add(std::vector<std::string>{"id"});
+  const value::Value expected = value::ObjectValue{
+      {"id", value::IntegerValue{7}},
+      {"user",
+       value::ObjectValue{
+           {"age", value::IntegerValue{3}},
+           {"tags", value::ArrayValue{value::StringValue{"a"},
+                                      value::ObjectValue{{
+                                          "b",
+                                          value::ArrayValue{
+                                              value::IntegerValue{1}},
+                                      }}}},
+       }},
+  };
+  EXPECT_TRUE(json::Parse(kDocument, projection) == expected);
+  EXPECT_TRUE(json::Parse(kDocument, json::Projection::All()) ==
+              json::Parse(kDocument));
+  // A path covers the paths it is a prefix of
+  projection.Add(std::vector<std::string>{"user"});
+  EXPECT_TRUE(projection.Find("user")->IsAll());
+
+  // Only the declared fields that are read must be present
+  const functions::Type type = functions::SchemaType{{
+      {"id", functions::IntegerType{}},
+      {"flag", functions::BoolType{}},
+      {"missing", functions::StringType{}},
+  }};
+  json::Projection id;
+  id.Add(std::vector<std::string>{"id"});
+  const value::Value id_only =
+      value::ObjectValue{{"id", value::IntegerValue{7}}};
+  EXPECT_TRUE(json::Parse(kDocument, type, id) == id_only);
+  json::Projection missing;
+  missing.Add(std::vector<std::string>{"missing"});
+  EXPECT_THROW(json::Parse(kDocument, type, missing), json::ParsingError);
+
+  // Skipped values are checked for balanced brackets
+  EXPECT_THROW(json::Parse(R"({"skip": [1}, "id": 1})", id),
+               json::ParsingError);
+  EXPECT_THROW(json::Parse(R"({"skip": ]})", id), json::ParsingError);
+  EXPECT_THROW(json::Parse(R"({"skip": , "id": 1})", id), json::ParsingError);
+}
+
+TEST(Json, StructuralIndex) {
+  // Blocks are 64 bytes: strings, series of backslashes and numbers cross
+  // their boundaries
+  std::mt19937 random{42};
+  const std::vector<std::string> string_pieces = {"a", " ", "\\\\", "\\\"",
+                                                  "{", ":", "\\n"};
+  const std::vector<std::string> pieces = {
+      "{", "}", "[", "]", ":", ",", " ", "\n", "12", "-3.5", "true",
+  };
+  for (size_t iteration = 0; iteration < 1000; ++iteration) {
+    std::string json;
+    const size_t size = random() % 100;
+    for (size_t i = 0; i < size; ++i) {
+      if (random() % 3 > 0) {
+        json += pieces[random() % pieces.size()];
+        continue;
+      }
+      json.push_back('"');
+      const size_t string_size = random() % 40;
+      for (size_t j = 0; j < string_size; ++j) {
+        json += string_pieces[random() % string_pieces.size()];
+      }
+      json.push_back('"');
+    }
+
+    EXPECT_EQ(json::FindStructurals(json),
+              json::impl::FindStructuralsScalar(json))
+        << json;
+
+    // Not closed
+    json.push_back('"');
+    EXPECT_THROW(json::FindStructurals(json), json::ParsingError) << json;
+  }
+}
+
+TEST(Json, Writer) {
+  const value::Value v = value::ObjectValue{
+      {"int", value::IntegerValue{-42}},
+      {"float", value::FloatValue{2.0}},
+      {"small", value::FloatValue{1e-300}},
+      {"flag", value::BoolValue{false}},
+      {"null", value::NullValue{}},
+      {"text", value::StringValue{"line\n\"quoted\" \\ \x01 \xD0\xBC"}},
+      {"list", value::ArrayValue{value::IntegerValue{1}, value::ArrayValue{},
+                                 value::ObjectValue{}}},
+  };
+  const std::string written = json::Serialize(v);
+  EXPECT_TRUE(json::Parse(written) == v) << written;
+  // Floats are read back as floats
+  EXPECT_EQ(json::Serialize(value::FloatValue{2.0}), "2.0");
+  EXPECT_EQ(json::Serialize(value::FloatValue{0.1}), "0.1");
+  EXPECT_EQ(json::Serialize(value::StringValue{"a\tb\x1f"}),
+            R"("a\tb\u001f")");
+  EXPECT_THROW(json::Serialize(value::FloatValue{NAN}), std::invalid_argument);
+  EXPECT_THROW(json::Serialize(value::LambdaValue{nullptr}),
+               std::invalid_argument);
+
+  // Streaming
+  std::string buffer;
+  json::Writer writer{&buffer};
+  writer.BeginObject();
+  writer.Key("items");
+  writer.BeginArray();
+  writer.Write(value::IntegerValue{1});
+  writer.WriteString("x");
+  writer.EndArray();
+  writer.Key("n");
+  writer.Write(value::NullValue{});
+  writer.EndObject();
+  EXPECT_EQ(buffer, R"({"items":[1,"x"],"n":null})");
+
+  // To a file descriptor
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  {
+    json::Writer fd_writer{fds[1]};
+    fd_writer.Write(value::ArrayValue{value::BoolValue{true}});
+  }
+  close(fds[1]);
+  char read_buffer[16] = {};
+  EXPECT_EQ(read(fds[0], read_buffer, sizeof(read_buffer)), 6);
+  close(fds[0]);
+  EXPECT_EQ(std::string_view{read_buffer}, "[true]");
+}
+
+TEST(Json, Escaping) {
+  // Strings long enough for SIMD with special characters at all positions
+  std::mt19937 random{42};
+  const std::string alphabet = "ab\"\\\n\x01\x7f\x80\xff ";
+  for (size_t i = 0; i < 1000; ++i) {
+    std::string s;
+    const size_t size = random() % 80;
+    for (size_t j = 0; j < size; ++j) {
+      s.push_back(alphabet[random() % alphabet.size()]);
+    }
+    std::string simd;
+    json::impl::AppendEscaped(s, &simd);
+    std::string scalar;
+    json::impl::AppendEscapedScalar(s, &scalar);
+    EXPECT_EQ(simd, scalar);
+  }
+}
@@ -172,3 +172,58 @@ TEST(SyntaxParser, LambdaApplication) {
 
   EXPECT_EQ(body.name, lambda.argument.name);
 }
+
+TEST(SyntaxParser, Let) {
+  std::istringstream ss("let y = x + 1 in y * y");
+  tokenizer::Tokenizer tokenizer{ss};
+
+  const SyntaxParser parser;
+  const SyntaxTree result = parser.Parse(&tokenizer);
+
+  // Validate result
+
+  EXPECT_TRUE(boost::get<LetTerm>(&result));
+  const LetTerm& let = boost::get<LetTerm>(result);
+  EXPECT_EQ(let.variable.name, "y");
+
+  EXPECT_TRUE(boost::get<ApplicationTerm>(&let.definition));
+  EXPECT_EQ(boost::get<FunctionTerm>(
+                boost::get<ApplicationTerm>(let.definition).function)
+                .name,
+            "Add");
+
+  EXPECT_TRUE(boost::get<ApplicationTerm>(&let.body));
+  const ApplicationTerm& body = boost::get<ApplicationTerm>(let.body);
+  EXPECT_EQ(boost::get<FunctionTerm>(body.function).name, "Multiply");
+  EXPECT_EQ(boost::get<VariableTerm>(body.arguments.at(0)).name, "y");
+  EXPECT_EQ(boost::get<VariableTerm>(body.arguments.at(1)).name, "y");
+}
+
+TEST(SyntaxParser, Placeholder) {
+  std::istringstream ss("$a: Int * $a + $b");
+  tokenizer::Tokenizer tokenizer{ss};
+
+  const SyntaxParser parser;
+  const SyntaxTree result = parser.Parse(&tokenizer);
+
+  // Validate result
+
+  EXPECT_TRUE(boost::get<ApplicationTerm>(&result));
+  const ApplicationTerm& add = boost::get<ApplicationTerm>(result);
+  EXPECT_EQ(boost::get<FunctionTerm>(add.function).name, "Add");
+
+  const ApplicationTerm& multiply =
+      boost::get<ApplicationTerm>(add.arguments.at(0));
+  const PlaceholderTerm& declared =
+      boost::get<PlaceholderTerm>(multiply.arguments.at(0));
+  EXPECT_EQ(declared.name, "$a");
+  EXPECT_TRUE(declared.type == magl::functions::Type{
+                                   magl::functions::IntegerType{}});
+  EXPECT_FALSE(boost::get<PlaceholderTerm>(multiply.arguments.at(1)).type);
+
+  EXPECT_EQ(boost::get<PlaceholderTerm>(add.arguments.at(1)).name, "$b");
+
+  std::istringstream unknown_type("$a: Integer");
+  tokenizer::Tokenizer unknown_type_tokenizer{unknown_type};
+  EXPECT_THROW(parser.Parse(&unknown_type_tokenizer), ParsingError);
+}
@@ -87,3 +87,49 @@ TEST(Tokenizer, Object) {
 
   EXPECT_TRUE(t.IsEnd());
 }
+
+TEST(Tokenizer, Let) {
+  std::istringstream ss("let x = 2 in letter + input + l + f");
+
+  Tokenizer t(ss);
+
+  const std::vector<tokens::Token> expected_result = {
+      tokens::KeywordToken::kLet, tokens::NameToken{"x"},
+      tokens::AssignToken{},      tokens::IntToken{2},
+      tokens::KeywordToken::kIn,  tokens::NameToken{"letter"},
+      tokens::PlusToken{},        tokens::NameToken{"input"},
+      tokens::PlusToken{},        tokens::NameToken{"l"},
+      tokens::PlusToken{},        tokens::NameToken{"f"},
+      tokens::EofToken{},
+  };
+
+  for (size_t i = 0; i < expected_result.size(); ++i) {
+    EXPECT_TRUE(t.NextToken() == expected_result[i])
+        << std::format("Unexpected token #{}", i);
+  }
+
+  EXPECT_TRUE(t.IsEnd());
+}
+
+TEST(Tokenizer, Placeholder) {
+  std::istringstream ss("$threshold: Int + $x");
+
+  Tokenizer t(ss);
+
+  const std::vector<tokens::Token> expected_result = {
+      tokens::NameToken{"$threshold"}, tokens::ColonToken{},
+      tokens::NameToken{"Int"},        tokens::PlusToken{},
+      tokens::NameToken{"$x"},         tokens::EofToken{},
+  };
+
+  for (size_t i = 0; i < expected_result.size(); ++i) {
+    EXPECT_TRUE(t.NextToken() == expected_result[i])
+        << std::format("Unexpected token #{}", i);
+  }
+
+  EXPECT_TRUE(t.IsEnd());
+
+  std::istringstream invalid("$1");
+  Tokenizer invalid_t(invalid);
+  EXPECT_THROW(invalid_t.NextToken(), ParsingError);
+}
@@ -0,0 +1,164 @@
+#include <transform/pipeline.hpp>
+
+#include <library/cpp/testing/gtest/gtest.h>
+
+#include <cstdio>
+#include <format>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace magl;
+
+namespace {
+
+// Records are Dict[Any] by default
+constexpr std::string_view kExpression =
+    R"EOF(VarMapAt(record, "n") + VarMapAt(record, "n"))EOF";
+
+/// Writes `text` to a new file at `path` and returns its descriptor opened for
+/// reading
+int OpenFileWith(const std::string& path, std::string_view text) {
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  EXPECT_GE(fd, 0);
+  EXPECT_EQ(write(fd, text.data(), text.size()),
+            static_cast<ssize_t>(text.size()));
+  lseek(fd, 0, SEEK_SET);
+  return fd;
+}
+
+std::string ReadAll(int fd) {
+  std::string result;
+  char buffer[4096];
+  lseek(fd, 0, SEEK_SET);
+  ssize_t read_bytes = 0;
+  while ((read_bytes = read(fd, buffer, sizeof(buffer))) > 0) {
+    result.append(buffer, static_cast<size_t>(read_bytes));
+  }
+  return result;
+}
+
+struct PipelineRun {
+  transform::PipelineResult result;
+  std::string output;
+};
+
+/// Runs the pipeline on `input` read from a regular file (mapped) or from a
+/// pipe
+PipelineRun RunOn(const transform::PipelineOptions& options,
+                  std::string_view input, bool from_pipe) {
+  const std::string output_path = ::testing::TempDir() + "transform-output";
+  const int output_fd = OpenFileWith(output_path, "");
+
+  PipelineRun run;
+  if (from_pipe) {
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    // NB: The input may not fit into the buffer of the pipe
+    std::thread writer([&] {
+      std::string_view rest = input;
+      while (!rest.empty()) {
+        const ssize_t written = write(fds[1], rest.data(), rest.size());
+        if (written <= 0) {
+          break;
+        }
+        rest.remove_prefix(static_cast<size_t>(written));
+      }
+      close(fds[1]);
+    });
+    run.result = transform::RunPipeline(options, fds[0], output_fd);
+    writer.join();
+    close(fds[0]);
+  } else {
+    const std::string input_path = ::testing::TempDir() + "transform-input";
+    const int input_fd = OpenFileWith(input_path, input);
+    run.result = transform::RunPipeline(options, input_fd, output_fd);
+    close(input_fd);
+    std::remove(input_path.c_str());
+  }
+
+  run.output = ReadAll(output_fd);
+  close(output_fd);
+  std::remove(output_path.c_str());
+  return run;
+}
+
+}  // namespace
+
+TEST(Transform, Order) {
+  std::string input;
+  std::string expected;
+  for (size_t i = 0; i < 2000; ++i) {
+    input += std::format("{{\"n\": {}}}\n", i);
+    expected += std::format("{}\n", 2 * i);
+  }
+
+  // Many small batches are evaluated out of order and written in order
+  const transform::PipelineOptions options{
+      .expression = std::string{kExpression},
+      .threads = 4,
+      .batch_bytes = 64,
+  };
+  for (const bool from_pipe : {false, true}) {
+    const PipelineRun run = RunOn(options, input, from_pipe);
+    EXPECT_EQ(run.output, expected) << from_pipe;
+    EXPECT_EQ(run.result.records, 2000);
+    EXPECT_EQ(run.result.failed_records, 0);
+  }
+}
+
+TEST(Transform, LastLineWithoutNewline) {
+  const transform::PipelineOptions options{
+      .expression = std::string{kExpression},
+      .threads = 2,
+      .batch_bytes = 8,
+  };
+  for (const bool from_pipe : {false, true}) {
+    const PipelineRun run =
+        RunOn(options, "{\"n\": 1}\n\n{\"n\": 2}", from_pipe);
+    // Blank lines are skipped
+    EXPECT_EQ(run.output, "2\n4\n") << from_pipe;
+    EXPECT_EQ(run.result.records, 2);
+  }
+}
+
+TEST(Transform, PipeAndMappedInput) {
+  std::string input;
+  for (size_t i = 0; i < 500; ++i) {
+    input += std::format("{{\"n\": {}, \"padding\": \"{}\"}}\r\n", i,
+                         std::string(i % 37, 'x'));
+  }
+
+  for (const size_t batch_bytes : {1, 100, 256 * 1024}) {
+    const transform::PipelineOptions options{
+        .expression = std::string{kExpression},
+        .threads = 3,
+        .batch_bytes = batch_bytes,
+    };
+    const PipelineRun mapped = RunOn(options, input, false);
+    const PipelineRun piped = RunOn(options, input, true);
+    EXPECT_EQ(mapped.output, piped.output) << batch_bytes;
+    EXPECT_EQ(mapped.result.records, 500);
+    EXPECT_EQ(piped.result.records, 500);
+  }
+}
+
+TEST(Transform, FailedRecords) {
+  const transform::PipelineOptions options{
+      .expression = std::string{kExpression},
+      .threads = 2,
+      .batch_bytes = 16,
+  };
+  for (const bool from_pipe : {false, true}) {
+    // A missing field and malformed JSON
+    const PipelineRun run =
+        RunOn(options, "{\"n\": 1}\n{\"m\": 2}\n{\"n\": \n{\"n\": 4}\n",
+              from_pipe);
+    EXPECT_EQ(run.output, "2\nnull\nnull\n8\n") << from_pipe;
+    EXPECT_EQ(run.result.records, 4);
+    EXPECT_EQ(run.result.failed_records, 2);
+  }
+}